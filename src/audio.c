@@ -0,0 +1,49 @@
+#include "audio.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include <stddef.h>
+
+// O callback de AudioStream da Raylib nao recebe ponteiro de usuario,
+// entao o sintetizador ativo fica registrado aqui.
+static Synth* streamSynth = NULL;
+
+static void audio_stream_callback(void* buffer, unsigned int frames) {
+    if (!streamSynth) return;
+    synth_render(streamSynth, (int16_t*)buffer, (int)frames);
+}
+
+bool audio_init(GameAudio* audio) {
+    audio->ready = false;
+    audio->synth = NULL;
+    if (!IsAudioDeviceReady()) return false;
+
+    audio->stream = LoadAudioStream(SYNTH_SAMPLE_RATE, 16, 1);
+    if (!IsAudioStreamValid(audio->stream)) return false;
+    audio->synth = (Synth*)mem_alloc(MEM_TAG_AUDIO, sizeof(Synth));
+    if (!audio->synth) {
+        UnloadAudioStream(audio->stream);
+        return false;
+    }
+    synth_init(audio->synth, SYNTH_SAMPLE_RATE);
+    streamSynth = audio->synth;
+    SetAudioStreamCallback(audio->stream, audio_stream_callback);
+    PlayAudioStream(audio->stream);
+    audio->ready = true;
+    return true;
+}
+
+void audio_shutdown(GameAudio* audio) {
+    if (!audio->ready) return;
+    StopAudioStream(audio->stream);
+    UnloadAudioStream(audio->stream);
+    streamSynth = NULL;
+    mem_free(audio->synth);
+    audio->synth = NULL;
+    audio->ready = false;
+}
+
+void audio_play(GameAudio* audio, SynthSound sound) {
+    if (audio->ready && !synth_trigger(audio->synth, sound)) {
+        metrics_add(METRIC_SYNTH_EVENTS_DROPPED, 1);
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdbool.h>
+#include "raylib.h"
+#include "synth.h"
+
+// O sintetizador (tabela de onda, vozes e fila) so e alocado quando ha
+// dispositivo de audio: clones, salas do servidor e ambientes em lote nao
+// pagam por ele.
+typedef struct {
+    Synth* synth;
+    AudioStream stream;
+    bool ready;
+} GameAudio;
+
+bool audio_init(GameAudio* audio);
+void audio_shutdown(GameAudio* audio);
+void audio_play(GameAudio* audio, SynthSound sound);
@@ -0,0 +1,400 @@
+#include "autopilot.h"
+#include "memtrack.h"
+#include "trace.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const Direction kActions[4] = {DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT};
+
+static uint32_t tree_random(AutopilotTree* tree) {
+    uint32_t x = tree->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    tree->rng = x;
+    return x;
+}
+
+static Position step_from(Position pos, Direction dir) {
+    switch (dir) {
+        case DIR_UP: pos.row -= 1; break;
+        case DIR_DOWN: pos.row += 1; break;
+        case DIR_LEFT: pos.col -= 1; break;
+        case DIR_RIGHT: pos.col += 1; break;
+        default: break;
+    }
+    return pos;
+}
+
+// players[0] sempre esta dentro do mapa, entao o vizinho cai no maximo na
+// borda de paredes.
+static bool legal_action(const GameState* game, int action) {
+    Position next = step_from(game->players[0].pos, kActions[action]);
+    return map_tile(&game->map, next.row, next.col) != '#';
+}
+
+static int action_index(Direction dir) {
+    for (int i = 0; i < 4; i++) {
+        if (kActions[i] == dir) return i;
+    }
+    return -1;
+}
+
+// kActions agrupa direcoes opostas em pares (0, 1) e (2, 3).
+static int reverse_action(Direction dir) {
+    int index = action_index(dir);
+    return index < 0 ? -1 : index ^ 1;
+}
+
+static void tree_reset(AutopilotTree* tree) {
+    AutopilotNode* root = &tree->nodes[0];
+    root->parent = -1;
+    for (int i = 0; i < 4; i++) root->children[i] = -1;
+    root->visits = 0;
+    root->total = 0.0f;
+    root->expanded = false;
+    tree->nodeCount = 1;
+}
+
+static int tree_add(AutopilotTree* tree, int parent) {
+    if (tree->nodeCount >= AUTOPILOT_NODE_CAPACITY) return -1;
+    int index = tree->nodeCount++;
+    AutopilotNode* node = &tree->nodes[index];
+    node->parent = parent;
+    for (int i = 0; i < 4; i++) node->children[i] = -1;
+    node->visits = 0;
+    node->total = 0.0f;
+    node->expanded = false;
+    return index;
+}
+
+// Copia a subarvore de newRoot para o arena reserva, renumerando em
+// largura, e troca os arenas.
+static void tree_reroot(AutopilotTree* tree, int newRoot) {
+    if (newRoot <= 0) {
+        tree_reset(tree);
+        return;
+    }
+    int* queue = tree->queue;
+    int head = 0;
+    int tail = 0;
+    int count = 0;
+    queue[tail++] = newRoot;
+    tree->spare[count] = tree->nodes[newRoot];
+    tree->spare[count].parent = -1;
+    count++;
+    while (head < tail) {
+        int copyIndex = head++;
+        AutopilotNode* copy = &tree->spare[copyIndex];
+        for (int i = 0; i < 4; i++) {
+            int child = copy->children[i];
+            if (child < 0) continue;
+            tree->spare[count] = tree->nodes[child];
+            tree->spare[count].parent = copyIndex;
+            copy->children[i] = count;
+            queue[tail++] = child;
+            count++;
+        }
+    }
+    AutopilotNode* swap = tree->nodes;
+    tree->nodes = tree->spare;
+    tree->spare = swap;
+    tree->nodeCount = count;
+}
+
+static void advance_move(GameState* game, Direction dir) {
+    game->players[0].pendingDir = dir;
+    float dt = PACMAN_STEP_INTERVAL - game->players[0].moveTimer;
+    if (dt < SIM_TICK_DT) dt = SIM_TICK_DT;
+    game_step_fast(game, dt);
+}
+
+static bool is_terminal(const GameState* game, const GameState* root) {
+    return game->phase != GAME_PHASE_PLAYING || game->players[0].lives < root->players[0].lives ||
+           game->pelletsRemaining == 0;
+}
+
+static int nearest_pellet_distance(AutopilotTree* tree, const GameState* game) {
+    const Map* map = &game->map;
+    int cells = map->rows * map->cols;
+    if (cells <= 0 || cells > tree->queueCapacity) return -1;
+    int* queue = tree->queue;
+    int16_t* dist = (int16_t*)(tree->queue + cells);
+    for (int i = 0; i < cells; i++) dist[i] = -1;
+    Position start = game->players[0].pos;
+    if (!map_in_bounds(map, start.row, start.col)) return -1;
+    // A fila guarda indices da grade com borda (vizinhos sem checar
+    // limites); dist usa o indice compacto row * cols + col.
+    const int gridStep[4] = {-map->stride, map->stride, -1, 1};
+    const int distStep[4] = {-map->cols, map->cols, -1, 1};
+    int head = 0;
+    int tail = 0;
+    dist[start.row * map->cols + start.col] = 0;
+    queue[tail++] = map_index(map, start.row, start.col);
+    while (head < tail) {
+        int node = queue[head++];
+        char cell = map->grid[node];
+        int compact = map_index_row(map, node) * map->cols + map_index_col(map, node);
+        if (cell == '.' || cell == 'o') return dist[compact];
+        for (int i = 0; i < 4; i++) {
+            int next = node + gridStep[i];
+            int index = compact + distStep[i];
+            if (map->grid[next] == '#' || dist[index] >= 0) continue;
+            dist[index] = (int16_t)(dist[compact] + 1);
+            queue[tail++] = next;
+        }
+    }
+    return -1;
+}
+
+// Sem pellets por perto os rollouts nao pontuam; a distancia ate o pellet
+// mais proximo, medida no fim do caminho da arvore, desempata as acoes.
+static float pellet_bonus(AutopilotTree* tree, const GameState* game) {
+    int dist = nearest_pellet_distance(tree, game);
+    if (dist < 0 || dist >= AUTOPILOT_PELLET_HORIZON) return 0.0f;
+    return 0.01f * (float)(AUTOPILOT_PELLET_HORIZON - dist);
+}
+
+static float evaluate(const GameState* game, const GameState* root, float bonus) {
+    float value = (float)(game->players[0].score - root->players[0].score) / 50.0f;
+    if (game->players[0].lives < root->players[0].lives || game->phase == GAME_PHASE_GAMEOVER ||
+        game->postPhase == GAME_PHASE_GAMEOVER) {
+        return value - 4.0f;
+    }
+    if (game->pelletsRemaining == 0) return value + 5.0f;
+    return value + bonus;
+}
+
+static void rollout(AutopilotTree* tree, GameState* game, const GameState* root) {
+    for (int move = 0; move < AUTOPILOT_ROLLOUT_MOVES && !is_terminal(game, root); move++) {
+        int options[4];
+        int count = 0;
+        int back = reverse_action(game->players[0].dir);
+        for (int i = 0; i < 4; i++) {
+            if (i != back && legal_action(game, i)) options[count++] = i;
+        }
+        if (count == 0 && back >= 0) options[count++] = back;
+        if (count == 0) break;
+        advance_move(game, kActions[options[tree_random(tree) % (uint32_t)count]]);
+    }
+}
+
+static int select_child(const AutopilotTree* tree, const AutopilotNode* node) {
+    float logVisits = logf((float)node->visits + 1.0f);
+    int best = -1;
+    float bestScore = -INFINITY;
+    for (int i = 0; i < 4; i++) {
+        int child = node->children[i];
+        if (child < 0) continue;
+        const AutopilotNode* c = &tree->nodes[child];
+        if (c->visits == 0) return i;
+        float score = c->total / (float)c->visits +
+                      AUTOPILOT_EXPLORATION * sqrtf(logVisits / (float)c->visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+static void expand(AutopilotTree* tree, int index, const GameState* game) {
+    AutopilotNode* node = &tree->nodes[index];
+    if (node->expanded) return;
+    for (int i = 0; i < 4; i++) {
+        if (!legal_action(game, i)) continue;
+        int child = tree_add(tree, index);
+        if (child < 0) return;
+        tree->nodes[index].children[i] = child;
+    }
+    tree->nodes[index].expanded = true;
+}
+
+static void iterate(AutopilotTree* tree, const GameState* root) {
+    GameState* game = &tree->scratch;
+    if (!game_clone(game, root)) return;
+    game_seed(game, tree_random(tree));
+
+    int index = 0;
+    while (!is_terminal(game, root)) {
+        bool fresh = !tree->nodes[index].expanded;
+        expand(tree, index, game);
+        if (!tree->nodes[index].expanded) break;
+        int action = select_child(tree, &tree->nodes[index]);
+        if (action < 0) break;
+        index = tree->nodes[index].children[action];
+        advance_move(game, kActions[action]);
+        if (fresh) break;
+    }
+    float bonus = is_terminal(game, root) ? 0.0f : pellet_bonus(tree, game);
+    rollout(tree, game, root);
+    float value = evaluate(game, root, bonus);
+    for (int i = index; i >= 0; i = tree->nodes[i].parent) {
+        tree->nodes[i].visits++;
+        tree->nodes[i].total += value;
+    }
+    tree->iterations++;
+}
+
+static void search_task(void* ctx, int index) {
+    Autopilot* ap = (Autopilot*)ctx;
+    AutopilotTree* tree = &ap->trees[index];
+    tree->iterations = 0;
+    trace_begin("autopilot_rollouts");
+    do {
+        iterate(tree, ap->root);
+    } while (input_timestamp() < ap->deadline);
+    trace_end("autopilot_rollouts");
+}
+
+bool autopilot_init(Autopilot* ap, int threads, float budgetMs) {
+    memset(ap, 0, sizeof(*ap));
+    atomic_init(&ap->enabled, false);
+    ap->budgetSeconds = (budgetMs > 0.0f ? budgetMs : AUTOPILOT_DEFAULT_BUDGET_MS) / 1000.0;
+    if (threads <= 0) threads = thread_pool_cpu_count();
+    if (threads > AUTOPILOT_MAX_WORKERS) threads = AUTOPILOT_MAX_WORKERS;
+
+    ap->trees = (AutopilotTree*)mem_calloc(MEM_TAG_AUTOPILOT, (size_t)threads, sizeof(AutopilotTree));
+    if (!ap->trees) return false;
+    for (int i = 0; i < threads; i++) {
+        AutopilotTree* tree = &ap->trees[i];
+        tree->nodes = (AutopilotNode*)mem_alloc(MEM_TAG_AUTOPILOT, sizeof(AutopilotNode) * AUTOPILOT_NODE_CAPACITY);
+        tree->spare = (AutopilotNode*)mem_alloc(MEM_TAG_AUTOPILOT, sizeof(AutopilotNode) * AUTOPILOT_NODE_CAPACITY);
+        // A fila serve tanto ao rerooting quanto ao BFS de pellets, que
+        // guarda as distancias int16 logo depois dos indices.
+        tree->queueCapacity = AUTOPILOT_NODE_CAPACITY;
+        tree->queue = (int*)mem_alloc(MEM_TAG_AUTOPILOT, sizeof(int) * tree->queueCapacity * 2);
+        game_clone_init(&tree->scratch);
+        tree->rng = 0x9E3779B9u * (uint32_t)(i + 1);
+        ap->treeCount++;
+        if (!tree->nodes || !tree->spare || !tree->queue) {
+            autopilot_shutdown(ap);
+            return false;
+        }
+        tree_reset(tree);
+    }
+    ap->poolReady = true;
+    if (!thread_pool_init(&ap->pool, threads - 1)) {
+        autopilot_shutdown(ap);
+        return false;
+    }
+    return true;
+}
+
+void autopilot_shutdown(Autopilot* ap) {
+    if (ap->poolReady) thread_pool_destroy(&ap->pool);
+    ap->poolReady = false;
+    for (int i = 0; i < ap->treeCount; i++) {
+        AutopilotTree* tree = &ap->trees[i];
+        mem_free(tree->nodes);
+        mem_free(tree->spare);
+        mem_free(tree->queue);
+        game_shutdown(&tree->scratch);
+    }
+    mem_free(ap->trees);
+    ap->trees = NULL;
+    path_table_free(&ap->table);
+    ap->treeCount = 0;
+}
+
+void autopilot_set_enabled(Autopilot* ap, bool enabled) {
+    atomic_store(&ap->enabled, enabled);
+}
+
+bool autopilot_enabled(Autopilot* ap) {
+    return atomic_load(&ap->enabled);
+}
+
+static bool can_reuse(const Autopilot* ap, const GameState* game) {
+    if (!ap->decided || ap->lastMove == DIR_NONE) return false;
+    if (game->players[0].lives != ap->decidedLives || game->mapRevision != ap->decidedRevision) return false;
+    Position expected = step_from(ap->decidedPos, ap->lastMove);
+    return game->players[0].prevPos.row == ap->decidedPos.row &&
+           game->players[0].prevPos.col == ap->decidedPos.col &&
+           ((game->players[0].pos.row == expected.row && game->players[0].pos.col == expected.col) ||
+            map_get(&game->map, game->players[0].pos.row, game->players[0].pos.col) == 'T');
+}
+
+// Os fantasmas dos rollouts consultam distancias o tempo todo e os alvos
+// mudam a cada passo; uma tabela completa por mapa, compartilhada pelos
+// clones, troca os BFS por leituras com as mesmas distancias do jogo.
+static void prepare_table(Autopilot* ap, const GameState* game) {
+    if (ap->table.dist && ap->tableRevision == game->mapRevision) return;
+    GameState* scratch = &ap->trees[0].scratch;
+    if (!game_clone(scratch, game) || !path_table_build(&ap->table, &scratch->paths, &scratch->map)) {
+        path_table_free(&ap->table);
+    }
+    ap->tableRevision = game->mapRevision;
+}
+
+Direction autopilot_search(Autopilot* ap, const GameState* game) {
+    trace_begin("autopilot_search");
+    prepare_table(ap, game);
+    int moveIndex = action_index(ap->lastMove);
+    bool reuse = can_reuse(ap, game);
+    for (int i = 0; i < ap->treeCount; i++) {
+        AutopilotTree* tree = &ap->trees[i];
+        tree->scratch.paths.table = ap->table.dist ? &ap->table : NULL;
+        if (reuse && moveIndex >= 0) {
+            tree_reroot(tree, tree->nodes[0].children[moveIndex]);
+        } else {
+            tree_reset(tree);
+        }
+    }
+
+    ap->root = game;
+    ap->deadline = input_timestamp() + ap->budgetSeconds;
+    thread_pool_for(&ap->pool, ap->treeCount, search_task, ap);
+
+    unsigned long long visits[4] = {0};
+    double totals[4] = {0};
+    for (int t = 0; t < ap->treeCount; t++) {
+        const AutopilotTree* tree = &ap->trees[t];
+        ap->iterations += tree->iterations;
+        for (int i = 0; i < 4; i++) {
+            int child = tree->nodes[0].children[i];
+            if (child < 0) continue;
+            visits[i] += tree->nodes[child].visits;
+            totals[i] += tree->nodes[child].total;
+        }
+    }
+    int best = -1;
+    for (int i = 0; i < 4; i++) {
+        if (visits[i] == 0) continue;
+        if (best < 0 || visits[i] > visits[best] ||
+            (visits[i] == visits[best] && totals[i] > totals[best])) {
+            best = i;
+        }
+    }
+    ap->decisions++;
+    ap->root = NULL;
+
+    Direction move = best >= 0 ? kActions[best] : DIR_NONE;
+    ap->decided = true;
+    ap->decidedPos = game->players[0].pos;
+    ap->decidedLives = game->players[0].lives;
+    ap->decidedRevision = game->mapRevision;
+    ap->lastMove = move;
+    trace_end("autopilot_search");
+    return move;
+}
+
+void autopilot_drive(Autopilot* ap, GameState* game) {
+    game->autopilot = autopilot_enabled(ap);
+    if (!game->autopilot) {
+        ap->decided = false;
+        return;
+    }
+    if (game->phase != GAME_PHASE_PLAYING || game->paused || game->menu.status == MENU_OPEN) return;
+    bool sameState = ap->decided && game->players[0].lives == ap->decidedLives &&
+                     game->mapRevision == ap->decidedRevision &&
+                     game->players[0].pos.row == ap->decidedPos.row &&
+                     game->players[0].pos.col == ap->decidedPos.col;
+    if (sameState) return;
+    Direction move = autopilot_search(ap, game);
+    if (move != DIR_NONE) {
+        game->players[0].pendingDir = move;
+        game->players[0].pendingTime = 0.0;
+    }
+}
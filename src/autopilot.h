@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+#include "threadpool.h"
+
+#define AUTOPILOT_MAX_WORKERS 16
+#define AUTOPILOT_NODE_CAPACITY 16384
+#define AUTOPILOT_ROLLOUT_MOVES 20
+#define AUTOPILOT_EXPLORATION 1.2f
+#define AUTOPILOT_PELLET_HORIZON 60
+#define AUTOPILOT_DEFAULT_BUDGET_MS 10.0f
+
+// No da arvore em malha aberta: o estado nao fica guardado, ele e refeito
+// a partir do clone da raiz aplicando as acoes do caminho.
+typedef struct {
+    int32_t parent;
+    int32_t children[4];
+    uint32_t visits;
+    float total;
+    bool expanded;
+} AutopilotNode;
+
+// Cada worker tem a propria arvore e o proprio clone de rascunho, entao a
+// busca nao usa locks; na decisao as visitas da raiz sao somadas.
+typedef struct {
+    AutopilotNode* nodes;
+    AutopilotNode* spare;
+    int nodeCount;
+    GameState scratch;
+    int* queue;
+    int queueCapacity;
+    uint32_t rng;
+    unsigned int iterations;
+} AutopilotTree;
+
+typedef struct {
+    ThreadPool pool;
+    bool poolReady;
+    AutopilotTree* trees;
+    int treeCount;
+    const GameState* root;
+    PathTable table;
+    uint32_t tableRevision;
+    double deadline;
+    double budgetSeconds;
+    atomic_bool enabled;
+
+    bool decided;
+    Position decidedPos;
+    int decidedLives;
+    uint32_t decidedRevision;
+    Direction lastMove;
+
+    unsigned long long decisions;
+    unsigned long long iterations;
+} Autopilot;
+
+// threads <= 0 usa todos os nucleos.
+bool autopilot_init(Autopilot* ap, int threads, float budgetMs);
+void autopilot_shutdown(Autopilot* ap);
+void autopilot_set_enabled(Autopilot* ap, bool enabled);
+bool autopilot_enabled(Autopilot* ap);
+// Chamado pela simulacao antes de cada tick: quando o Pac-Man precisa de
+// uma nova decisao, busca dentro do orcamento e grava pacman.pendingDir.
+void autopilot_drive(Autopilot* ap, GameState* game);
+Direction autopilot_search(Autopilot* ap, const GameState* game);
@@ -0,0 +1,192 @@
+#include "bitplane.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int words_for(int bits) {
+    return (bits + 63) / 64;
+}
+
+static uint64_t* plane_row(const BitplaneEncoder* enc, int plane, int row) {
+    return enc->planes + ((size_t)plane * enc->mapRows + row) * enc->mapWords;
+}
+
+static void write_bit(BitplaneEncoder* enc, int plane, int row, int col, bool value) {
+    uint64_t* word = plane_row(enc, plane, row) + col / 64;
+    uint64_t bit = 1ull << (col % 64);
+    if (value) {
+        *word |= bit;
+    } else {
+        *word &= ~bit;
+    }
+}
+
+static void write_tile(BitplaneEncoder* enc, const Map* map, int row, int col) {
+    char cell = map_get(map, row, col);
+    write_bit(enc, BITPLANE_WALL, row, col, cell == '#');
+    write_bit(enc, BITPLANE_PELLET, row, col, cell == '.');
+    write_bit(enc, BITPLANE_POWER, row, col, cell == 'o');
+    write_bit(enc, BITPLANE_PORTAL, row, col, cell == 'T');
+}
+
+static bool rebuild_map(BitplaneEncoder* enc, const GameState* game) {
+    const Map* map = &game->map;
+    if (!enc->planes || map->rows != enc->mapRows || map->cols != enc->mapCols) {
+        int words = words_for(map->cols);
+        uint64_t* planes = (uint64_t*)mem_calloc(MEM_TAG_ENV, (size_t)BITPLANE_COUNT * map->rows * words,
+                                                 sizeof(uint64_t));
+        if (!planes) return false;
+        mem_free(enc->planes);
+        enc->planes = planes;
+        enc->mapRows = map->rows;
+        enc->mapCols = map->cols;
+        enc->mapWords = words;
+    } else {
+        memset(enc->planes, 0, sizeof(uint64_t) * BITPLANE_COUNT * enc->mapRows * enc->mapWords);
+    }
+    for (int row = 0; row < map->rows; row++) {
+        for (int col = 0; col < map->cols; col++) {
+            write_tile(enc, map, row, col);
+        }
+    }
+    enc->markCount = 0;
+    return true;
+}
+
+static void apply_tile_changes(BitplaneEncoder* enc, const GameState* game) {
+    for (uint32_t i = enc->tileChangeCount; i != game->tileChangeCount; i++) {
+        Position pos = game->tileChanges[i % GAME_TILE_LOG_SIZE];
+        if (map_in_bounds(&game->map, pos.row, pos.col)) {
+            write_tile(enc, &game->map, pos.row, pos.col);
+        }
+    }
+}
+
+static bool mark_entity(BitplaneEncoder* enc, const Map* map, int plane, Position pos) {
+    if (!map_in_bounds(map, pos.row, pos.col)) return true;
+    if (enc->markCount == enc->markCapacity) {
+        int capacity = enc->markCapacity ? enc->markCapacity * 2 : 8;
+        Position* marks = (Position*)mem_realloc(MEM_TAG_ENV, enc->marks, sizeof(Position) * capacity);
+        if (!marks) return false;
+        enc->marks = marks;
+        enc->markCapacity = capacity;
+    }
+    enc->marks[enc->markCount++] = pos;
+    write_bit(enc, plane, pos.row, pos.col, true);
+    return true;
+}
+
+static void update_entities(BitplaneEncoder* enc, const GameState* game) {
+    for (int i = 0; i < enc->markCount; i++) {
+        Position pos = enc->marks[i];
+        write_bit(enc, BITPLANE_PACMAN, pos.row, pos.col, false);
+        write_bit(enc, BITPLANE_GHOST, pos.row, pos.col, false);
+        write_bit(enc, BITPLANE_GHOST_VULNERABLE, pos.row, pos.col, false);
+    }
+    enc->markCount = 0;
+
+    for (int i = 0; i < game->playerCount; i++) {
+        if (game->players[i].active) mark_entity(enc, &game->map, BITPLANE_PACMAN, game->players[i].pos);
+    }
+    for (int i = 0; i < game->ghostCount && game->ghosts; i++) {
+        const Ghost* ghost = &game->ghosts[i];
+        if (!ghost->alive) continue;
+        int plane = game_ghost_vulnerable(game, ghost) ? BITPLANE_GHOST_VULNERABLE : BITPLANE_GHOST;
+        mark_entity(enc, &game->map, plane, ghost->pos);
+    }
+}
+
+static int floor_div64(int value) {
+    return value >= 0 ? value / 64 : -((63 - value) / 64);
+}
+
+static uint64_t load_word(const uint64_t* row, int words, int index) {
+    return (index >= 0 && index < words) ? row[index] : 0;
+}
+
+// 64 bits da linha a partir da coluna start (pode ser negativa).
+static uint64_t extract_bits(const uint64_t* row, int words, int start) {
+    int word = floor_div64(start);
+    int shift = start - word * 64;
+    uint64_t bits = load_word(row, words, word) >> shift;
+    if (shift != 0) bits |= load_word(row, words, word + 1) << (64 - shift);
+    return bits;
+}
+
+// Bits da janela [start, start + 64) que caem fora de [0, cols).
+static uint64_t outside_mask(int cols, int start) {
+    uint64_t mask = 0;
+    if (start < 0) mask |= (start <= -64) ? ~0ull : ((1ull << -start) - 1);
+    int inside = cols - start;
+    if (inside <= 0) return ~0ull;
+    if (inside < 64) mask |= ~0ull << inside;
+    return mask;
+}
+
+static void write_window(const BitplaneEncoder* enc, int originRow, int originCol, uint64_t* out) {
+    int tailBits = enc->width % 64;
+    uint64_t tailMask = tailBits ? (1ull << tailBits) - 1 : ~0ull;
+    for (int plane = 0; plane < BITPLANE_COUNT; plane++) {
+        for (int row = 0; row < enc->height; row++) {
+            uint64_t* dst = out + ((size_t)plane * enc->height + row) * enc->rowWords;
+            int mapRow = originRow + row;
+            bool insideRow = mapRow >= 0 && mapRow < enc->mapRows;
+            for (int w = 0; w < enc->rowWords; w++) {
+                int start = originCol + w * 64;
+                uint64_t bits = 0;
+                if (insideRow) bits = extract_bits(plane_row(enc, plane, mapRow), enc->mapWords, start);
+                if (plane == BITPLANE_WALL) {
+                    bits |= insideRow ? outside_mask(enc->mapCols, start) : ~0ull;
+                }
+                if (w == enc->rowWords - 1) bits &= tailMask;
+                dst[w] = bits;
+            }
+        }
+    }
+}
+
+bool bitplane_init(BitplaneEncoder* enc, int width, int height) {
+    memset(enc, 0, sizeof(*enc));
+    enc->egocentric = width > 0 && height > 0;
+    enc->width = enc->egocentric ? width : MAP_COLS;
+    enc->height = enc->egocentric ? height : MAP_ROWS;
+    enc->rowWords = words_for(enc->width);
+    return true;
+}
+
+void bitplane_free(BitplaneEncoder* enc) {
+    mem_free(enc->planes);
+    mem_free(enc->marks);
+    memset(enc, 0, sizeof(*enc));
+}
+
+size_t bitplane_words(const BitplaneEncoder* enc) {
+    return (size_t)BITPLANE_COUNT * enc->height * enc->rowWords;
+}
+
+void bitplane_encode(BitplaneEncoder* enc, const GameState* game, uint64_t* out) {
+    bool stale = !enc->primed || enc->mapRevision != game->mapRevision ||
+                 game->tileChangeCount - enc->tileChangeCount > GAME_TILE_LOG_SIZE ||
+                 game->map.rows != enc->mapRows || game->map.cols != enc->mapCols;
+    if (stale) {
+        if (!game->map.grid || !rebuild_map(enc, game)) {
+            memset(out, 0, sizeof(uint64_t) * bitplane_words(enc));
+            enc->primed = false;
+            return;
+        }
+    } else {
+        apply_tile_changes(enc, game);
+    }
+    enc->primed = true;
+    enc->mapRevision = game->mapRevision;
+    enc->tileChangeCount = game->tileChangeCount;
+    update_entities(enc, game);
+
+    int originRow = 0;
+    int originCol = 0;
+    if (enc->egocentric) {
+        originRow = game->players[0].pos.row - enc->height / 2;
+        originCol = game->players[0].pos.col - enc->width / 2;
+    }
+    write_window(enc, originRow, originCol, out);
+}
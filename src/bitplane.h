@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+typedef enum {
+    BITPLANE_WALL = 0,
+    BITPLANE_PELLET,
+    BITPLANE_POWER,
+    BITPLANE_PACMAN,
+    BITPLANE_GHOST,
+    BITPLANE_GHOST_VULNERABLE,
+    BITPLANE_PORTAL,
+    BITPLANE_COUNT
+} BitplaneKind;
+
+// Codifica o GameState em planos de bits: saida[plano][linha][palavra], com
+// rowWords palavras de 64 bits por linha (coluna c = bit c % 64 da palavra
+// c / 64). Sem recorte, a janela e a grade MAP_ROWS x MAP_COLS a partir de
+// (0, 0); com recorte, width x height centrada no Pac-Man, e o que cai fora
+// do mapa conta como parede. Os planos do mapa inteiro sao mantidos aqui e
+// so os tiles alterados desde a chamada anterior sao reescritos.
+typedef struct {
+    int width;
+    int height;
+    int rowWords;
+    bool egocentric;
+
+    int mapRows;
+    int mapCols;
+    int mapWords;
+    uint64_t* planes;
+    bool primed;
+    uint32_t mapRevision;
+    uint32_t tileChangeCount;
+
+    Position* marks;
+    int markCount;
+    int markCapacity;
+} BitplaneEncoder;
+
+// width/height <= 0 usa a grade inteira, sem recorte.
+bool bitplane_init(BitplaneEncoder* enc, int width, int height);
+void bitplane_free(BitplaneEncoder* enc);
+size_t bitplane_words(const BitplaneEncoder* enc);
+void bitplane_encode(BitplaneEncoder* enc, const GameState* game, uint64_t* out);
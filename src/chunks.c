@@ -0,0 +1,192 @@
+#include "chunks.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <string.h>
+
+void chunk_grid_init(ChunkGrid* grid) {
+    memset(grid, 0, sizeof(*grid));
+}
+
+void chunk_grid_free(ChunkGrid* grid) {
+    mem_free(grid->head);
+    mem_free(grid->next);
+    mem_free(grid->prev);
+    mem_free(grid->ghostChunk);
+    mem_free(grid->work);
+    mem_free(grid->ring);
+    mem_free(grid->nearest);
+    mem_free(grid->touched);
+    chunk_grid_init(grid);
+}
+
+int chunk_of(const ChunkGrid* grid, Position pos) {
+    int row = pos.row / CHUNK_SIZE;
+    int col = pos.col / CHUNK_SIZE;
+    if (pos.row < 0 || pos.col < 0 || row >= grid->rows || col >= grid->cols) return -1;
+    return row * grid->cols + col;
+}
+
+static void unlink_ghost(ChunkGrid* grid, int ghost) {
+    int chunk = grid->ghostChunk[ghost];
+    if (chunk < 0) return;
+    int next = grid->next[ghost];
+    int prev = grid->prev[ghost];
+    if (prev >= 0) grid->next[prev] = next;
+    else grid->head[chunk] = next;
+    if (next >= 0) grid->prev[next] = prev;
+    grid->ghostChunk[ghost] = -1;
+}
+
+// Lista em ordem de indice, como no EntityStore: a ordem em que o gather
+// entrega os fantasmas (e o sorteio de cada um) nao depende do historico,
+// entao um clone simula igual ao original.
+static void link_ghost(ChunkGrid* grid, int ghost, int chunk) {
+    grid->ghostChunk[ghost] = chunk;
+    grid->prev[ghost] = -1;
+    grid->next[ghost] = -1;
+    if (chunk < 0) return;
+    int next = grid->head[chunk];
+    while (next >= 0 && next < ghost) {
+        grid->prev[ghost] = next;
+        next = grid->next[next];
+    }
+    grid->next[ghost] = next;
+    if (next >= 0) grid->prev[next] = ghost;
+    if (grid->prev[ghost] >= 0) grid->next[grid->prev[ghost]] = ghost;
+    else grid->head[chunk] = ghost;
+}
+
+static void free_chunk_arrays(ChunkGrid* grid) {
+    mem_free(grid->head);
+    mem_free(grid->ring);
+    mem_free(grid->nearest);
+    mem_free(grid->touched);
+    grid->head = NULL;
+    grid->ring = NULL;
+    grid->nearest = NULL;
+    grid->touched = NULL;
+    grid->rows = 0;
+    grid->cols = 0;
+}
+
+static bool alloc_chunk_arrays(ChunkGrid* grid, int rows, int cols) {
+    size_t count = (size_t)rows * (size_t)cols;
+    grid->head = (int*)mem_alloc(MEM_TAG_ENTITIES, sizeof(int) * count);
+    grid->ring = (unsigned char*)mem_alloc(MEM_TAG_ENTITIES, count);
+    grid->nearest = (signed char*)mem_alloc(MEM_TAG_ENTITIES, count);
+    grid->touched = (int*)mem_alloc(MEM_TAG_ENTITIES, sizeof(int) * count);
+    if (!grid->head || !grid->ring || !grid->nearest || !grid->touched) {
+        free_chunk_arrays(grid);
+        return false;
+    }
+    grid->rows = rows;
+    grid->cols = cols;
+    return true;
+}
+
+bool chunk_grid_reset(ChunkGrid* grid, const Map* map, const Ghost* ghosts, int ghostCount) {
+    int rows = (map->rows + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    int cols = (map->cols + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    if (rows != grid->rows || cols != grid->cols || !grid->head) {
+        free_chunk_arrays(grid);
+        if (rows > 0 && cols > 0) alloc_chunk_arrays(grid, rows, cols);
+    }
+    if (ghostCount > grid->ghostCapacity) {
+        mem_free(grid->next);
+        mem_free(grid->prev);
+        mem_free(grid->ghostChunk);
+        mem_free(grid->work);
+        grid->next = (int*)mem_alloc(MEM_TAG_ENTITIES, sizeof(int) * ghostCount);
+        grid->prev = (int*)mem_alloc(MEM_TAG_ENTITIES, sizeof(int) * ghostCount);
+        grid->ghostChunk = (int*)mem_alloc(MEM_TAG_ENTITIES, sizeof(int) * ghostCount);
+        grid->work = (int*)mem_alloc(MEM_TAG_ENTITIES, sizeof(int) * ghostCount);
+        grid->ghostCapacity = ghostCount;
+        if (!grid->next || !grid->prev || !grid->ghostChunk || !grid->work) {
+            chunk_grid_free(grid);
+            return false;
+        }
+    }
+    grid->tick = 0;
+    int span = 2 * CHUNK_ACTIVE_RADIUS + 1;
+    grid->enabled = grid->head && (grid->rows > span || grid->cols > span);
+    if (!grid->head) return false;
+    for (int i = 0; i < grid->rows * grid->cols; i++) {
+        grid->head[i] = -1;
+        grid->ring[i] = CHUNK_NO_RING;
+    }
+    grid->touchedCount = 0;
+    for (int i = ghostCount - 1; i >= 0; i--) {
+        link_ghost(grid, i, chunk_of(grid, ghosts[i].pos));
+    }
+    return true;
+}
+
+void chunk_grid_move(ChunkGrid* grid, int ghost, Position pos) {
+    if (!grid->head || ghost >= grid->ghostCapacity) return;
+    int chunk = chunk_of(grid, pos);
+    if (chunk == grid->ghostChunk[ghost]) return;
+    unlink_ghost(grid, ghost);
+    link_ghost(grid, ghost, chunk);
+}
+
+int chunk_grid_nearest_player(const ChunkGrid* grid, Position pos) {
+    if (!grid->ring) return -1;
+    int chunk = chunk_of(grid, pos);
+    if (chunk < 0 || grid->ring[chunk] == CHUNK_NO_RING) return -1;
+    return grid->nearest[chunk];
+}
+
+int chunk_grid_path_depth(const ChunkGrid* grid) {
+    return grid->enabled ? CHUNK_PATH_DEPTH : 0;
+}
+
+static void mark_rings(ChunkGrid* grid, Position center, int player) {
+    int centerRow = center.row / CHUNK_SIZE;
+    int centerCol = center.col / CHUNK_SIZE;
+    int rowStart = centerRow - CHUNK_LOD_RADIUS < 0 ? 0 : centerRow - CHUNK_LOD_RADIUS;
+    int colStart = centerCol - CHUNK_LOD_RADIUS < 0 ? 0 : centerCol - CHUNK_LOD_RADIUS;
+    int rowEnd = centerRow + CHUNK_LOD_RADIUS >= grid->rows ? grid->rows - 1 : centerRow + CHUNK_LOD_RADIUS;
+    int colEnd = centerCol + CHUNK_LOD_RADIUS >= grid->cols ? grid->cols - 1 : centerCol + CHUNK_LOD_RADIUS;
+    for (int row = rowStart; row <= rowEnd; row++) {
+        for (int col = colStart; col <= colEnd; col++) {
+            int distRow = abs(row - centerRow);
+            int distCol = abs(col - centerCol);
+            int dist = distRow > distCol ? distRow : distCol;
+            int chunk = row * grid->cols + col;
+            if (grid->ring[chunk] == CHUNK_NO_RING) {
+                grid->touched[grid->touchedCount++] = chunk;
+            } else if (grid->ring[chunk] <= dist) {
+                continue;
+            }
+            grid->ring[chunk] = (unsigned char)dist;
+            grid->nearest[chunk] = (signed char)player;
+        }
+    }
+}
+
+static int gather_chunks(ChunkGrid* grid, const Ghost* ghosts, int count, bool active) {
+    for (int k = 0; k < grid->touchedCount; k++) {
+        int chunk = grid->touched[k];
+        if ((grid->ring[chunk] <= CHUNK_ACTIVE_RADIUS) != active) continue;
+        if (!active && (unsigned int)(chunk + grid->tick) % CHUNK_LOD_DIVISOR != 0) continue;
+        for (int i = grid->head[chunk]; i >= 0; i = grid->next[i]) {
+            if (ghosts[i].alive) grid->work[count++] = i;
+        }
+    }
+    return count;
+}
+
+int chunk_grid_gather(ChunkGrid* grid, const Ghost* ghosts, const Pacman* players, int playerCount,
+                      int* activeCount) {
+    *activeCount = 0;
+    if (!grid->head) return 0;
+    grid->tick++;
+    for (int k = 0; k < grid->touchedCount; k++) grid->ring[grid->touched[k]] = CHUNK_NO_RING;
+    grid->touchedCount = 0;
+    for (int p = 0; p < playerCount && p < CHUNK_MAX_PLAYERS; p++) {
+        if (players[p].active) mark_rings(grid, players[p].pos, p);
+    }
+    int count = gather_chunks(grid, ghosts, 0, true);
+    *activeCount = count;
+    return gather_chunks(grid, ghosts, count, false);
+}
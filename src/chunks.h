@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "entities.h"
+#include "map.h"
+
+#define CHUNK_SIZE 16
+#define CHUNK_ACTIVE_RADIUS 2
+#define CHUNK_LOD_RADIUS 6
+#define CHUNK_LOD_DIVISOR 4
+#define CHUNK_PATH_DEPTH (4 * (2 * CHUNK_ACTIVE_RADIUS + 1) * CHUNK_SIZE)
+#define CHUNK_MAX_PLAYERS ENTITY_MAX_PLAYERS
+#define CHUNK_NO_RING 0xFF
+
+// Particao do mapa em blocos de CHUNK_SIZE x CHUNK_SIZE tiles, cada um com
+// a lista (duplamente encadeada por indice) dos fantasmas que estao nele.
+// Ate CHUNK_ACTIVE_RADIUS
+// blocos de algum jogador os fantasmas usam a IA completa; ate
+// CHUNK_LOD_RADIUS andam pelos corredores num modelo barato,
+// cada bloco atualizado em 1 de cada CHUNK_LOD_DIVISOR ticks; alem disso
+// dormem. So fica ativo (enabled) quando o mapa nao cabe inteiro no raio
+// ativo; em mapas pequenos o jogo continua simulando tudo como antes.
+typedef struct {
+    int rows;
+    int cols;
+    int* head;
+    int* next;
+    int* prev;
+    int* ghostChunk;
+    int* work;
+    int ghostCapacity;
+    // Preenchidos por chunk_grid_gather: distancia (em blocos) ao jogador
+    // mais proximo e qual e ele, so para os blocos em touched.
+    unsigned char* ring;
+    signed char* nearest;
+    int* touched;
+    int touchedCount;
+    unsigned int tick;
+    bool enabled;
+    unsigned long long fullSteps;
+    unsigned long long lodSteps;
+} ChunkGrid;
+
+void chunk_grid_init(ChunkGrid* grid);
+bool chunk_grid_reset(ChunkGrid* grid, const Map* map, const Ghost* ghosts, int ghostCount);
+void chunk_grid_free(ChunkGrid* grid);
+int chunk_of(const ChunkGrid* grid, Position pos);
+void chunk_grid_move(ChunkGrid* grid, int ghost, Position pos);
+// Jogador mais proximo do bloco de pos no ultimo gather, ou -1.
+int chunk_grid_nearest_player(const ChunkGrid* grid, Position pos);
+int chunk_grid_path_depth(const ChunkGrid* grid);
+
+// Monta em grid->work os fantasmas vivos a simular neste tick: os
+// *activeCount primeiros com IA completa, o resto no modelo reduzido. Os
+// aneis de todos os jogadores ativos sao unidos num unico passe sobre os
+// blocos, sem percorrer jogadores x fantasmas. Retorna o total.
+int chunk_grid_gather(ChunkGrid* grid, const Ghost* ghosts, const Pacman* players, int playerCount,
+                      int* activeCount);
@@ -0,0 +1,164 @@
+#include "entities.h"
+#include "memtrack.h"
+#include <string.h>
+
+void entity_store_init(EntityStore* store) {
+    memset(store, 0, sizeof(*store));
+}
+
+void entity_store_free(EntityStore* store) {
+    mem_free(store->tileHead);
+    mem_free(store->slots);
+    mem_free(store->nearest);
+    mem_free(store->queue);
+    entity_store_init(store);
+}
+
+static int tile_of(const EntityStore* store, Position pos) {
+    if (pos.row < 0 || pos.col < 0 || pos.row >= store->rows || pos.col >= store->cols) return -1;
+    return pos.row * store->cols + pos.col;
+}
+
+static void unlink_slot(EntityStore* store, int slot) {
+    EntitySlot* entry = &store->slots[slot];
+    if (entry->tile < 0) return;
+    if (entry->prev >= 0) store->slots[entry->prev].next = entry->next;
+    else store->tileHead[entry->tile] = entry->next;
+    if (entry->next >= 0) store->slots[entry->next].prev = entry->prev;
+    entry->tile = -1;
+}
+
+// A lista fica em ordem de slot para que a ordem das colisoes nao dependa
+// do historico de movimentos (um clone refeito do zero resolve igual).
+static void link_slot(EntityStore* store, int slot, int tile) {
+    EntitySlot* entry = &store->slots[slot];
+    entry->tile = tile;
+    entry->prev = -1;
+    entry->next = -1;
+    if (tile < 0) return;
+    int next = store->tileHead[tile];
+    while (next >= 0 && next < slot) {
+        entry->prev = next;
+        next = store->slots[next].next;
+    }
+    entry->next = next;
+    if (next >= 0) store->slots[next].prev = slot;
+    if (entry->prev >= 0) store->slots[entry->prev].next = slot;
+    else store->tileHead[tile] = slot;
+}
+
+static void move_slot(EntityStore* store, int slot, int tile) {
+    if (store->slots[slot].tile == tile) return;
+    unlink_slot(store, slot);
+    link_slot(store, slot, tile);
+}
+
+bool entity_store_reset(EntityStore* store, const Map* map, const Ghost* ghosts, int ghostCount,
+                        const Pacman* players, int playerCount) {
+    if (map->rows != store->rows || map->cols != store->cols || !store->tileHead) {
+        mem_free(store->tileHead);
+        mem_free(store->nearest);
+        mem_free(store->queue);
+        store->nearest = NULL;
+        store->queue = NULL;
+        store->rows = map->rows;
+        store->cols = map->cols;
+        size_t cellCount = (size_t)map->rows * (size_t)map->cols;
+        store->tileHead = cellCount > 0 ? (int*)mem_alloc(MEM_TAG_ENTITIES, sizeof(int) * cellCount) : NULL;
+        if (!store->tileHead) {
+            store->rows = 0;
+            store->cols = 0;
+        }
+    }
+    int slotCount = ENTITY_GHOST_SLOT(ghostCount);
+    if (slotCount > store->slotCapacity) {
+        mem_free(store->slots);
+        store->slots = (EntitySlot*)mem_alloc(MEM_TAG_ENTITIES, sizeof(EntitySlot) * slotCount);
+        store->slotCapacity = store->slots ? slotCount : 0;
+    }
+    store->nearestDirty = true;
+    if (!store->tileHead || !store->slots) return false;
+    for (int i = 0; i < store->rows * store->cols; i++) store->tileHead[i] = -1;
+    for (int i = 0; i < store->slotCapacity; i++) store->slots[i] = (EntitySlot){-1, -1, -1};
+    for (int i = 0; i < playerCount && i < ENTITY_MAX_PLAYERS; i++) {
+        if (players[i].active) link_slot(store, i, tile_of(store, players[i].pos));
+    }
+    for (int i = 0; i < ghostCount; i++) {
+        link_slot(store, ENTITY_GHOST_SLOT(i), tile_of(store, ghosts[i].pos));
+    }
+    return true;
+}
+
+void entity_store_move_player(EntityStore* store, int player, Position pos, bool active) {
+    if (!store->tileHead || player < 0 || player >= ENTITY_MAX_PLAYERS) return;
+    int tile = active ? tile_of(store, pos) : -1;
+    if (store->slots[player].tile == tile) return;
+    move_slot(store, player, tile);
+    store->nearestDirty = true;
+}
+
+void entity_store_move_ghost(EntityStore* store, int ghost, Position pos) {
+    int slot = ENTITY_GHOST_SLOT(ghost);
+    if (!store->tileHead || ghost < 0 || slot >= store->slotCapacity) return;
+    move_slot(store, slot, tile_of(store, pos));
+}
+
+int entity_store_first(const EntityStore* store, Position pos) {
+    if (!store->tileHead) return -1;
+    int tile = tile_of(store, pos);
+    return tile >= 0 ? store->tileHead[tile] : -1;
+}
+
+// BFS com todas as origens ao mesmo tempo, como fill_distances em
+// pathfind.c: a fila guarda indices da grade com borda e nearest usa o
+// indice compacto. Jogadores de indice menor entram antes, entao ganham os
+// empates.
+static void fill_nearest(EntityStore* store, const Map* map, const Pacman* players, int playerCount) {
+    int cellCount = store->rows * store->cols;
+    for (int i = 0; i < cellCount; i++) store->nearest[i] = -1;
+    const int gridStep[4] = {-map->stride, map->stride, -1, 1};
+    const int tileStep[4] = {-store->cols, store->cols, -1, 1};
+    int head = 0;
+    int tail = 0;
+    for (int p = 0; p < playerCount && p < ENTITY_MAX_PLAYERS; p++) {
+        int tile = store->slots[p].tile;
+        if (!players[p].active || tile < 0 || store->nearest[tile] >= 0) continue;
+        store->nearest[tile] = (signed char)p;
+        store->queue[tail++] = map_index(map, players[p].pos.row, players[p].pos.col);
+    }
+    while (head < tail) {
+        int node = store->queue[head++];
+        int current = map_index_row(map, node) * store->cols + map_index_col(map, node);
+        for (int d = 0; d < 4; d++) {
+            int next = current + tileStep[d];
+            if (map->grid[node + gridStep[d]] == '#' || store->nearest[next] >= 0) continue;
+            store->nearest[next] = store->nearest[current];
+            store->queue[tail++] = node + gridStep[d];
+        }
+    }
+}
+
+int entity_store_nearest_player(EntityStore* store, const Map* map, const Pacman* players,
+                                int playerCount, Position pos) {
+    if (!store->tileHead || map->rows != store->rows || map->cols != store->cols) return -1;
+    int tile = tile_of(store, pos);
+    if (tile < 0) return -1;
+    if (!store->nearest) {
+        size_t cellCount = (size_t)store->rows * (size_t)store->cols;
+        store->nearest = (signed char*)mem_alloc(MEM_TAG_ENTITIES, cellCount);
+        store->queue = (int*)mem_alloc(MEM_TAG_ENTITIES, sizeof(int) * cellCount);
+        if (!store->nearest || !store->queue) {
+            mem_free(store->nearest);
+            mem_free(store->queue);
+            store->nearest = NULL;
+            store->queue = NULL;
+            return -1;
+        }
+        store->nearestDirty = true;
+    }
+    if (store->nearestDirty) {
+        fill_nearest(store, map, players, playerCount);
+        store->nearestDirty = false;
+    }
+    return store->nearest[tile];
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdbool.h>
+#include "entity.h"
+#include "map.h"
+
+#define ENTITY_MAX_PLAYERS 16
+#define ENTITY_GHOST_SLOT(index) (ENTITY_MAX_PLAYERS + (index))
+
+// Posicao de um ator no indice compacto do mapa (row * cols + col, -1 fora
+// da grade) e seus vizinhos na lista do tile.
+typedef struct {
+    int tile;
+    int next;
+    int prev;
+} EntitySlot;
+
+// Indice de todos os atores do labirinto num unico vetor de slots: o
+// jogador i no slot i e o fantasma i em ENTITY_GHOST_SLOT(i). Cada tile
+// guarda a lista dos slots que estao nele, em ordem crescente (jogadores
+// antes, depois fantasmas por indice), entao uma colisao percorre so quem
+// divide o tile. Para a IA, nearest diz o jogador ativo mais proximo (pelo
+// labirinto) de cada tile, montado num so BFS a partir de todos os
+// jogadores e refeito apenas quando algum deles troca de tile.
+typedef struct {
+    int rows;
+    int cols;
+    int* tileHead;
+    EntitySlot* slots;
+    int slotCapacity;
+    signed char* nearest;
+    int* queue;
+    bool nearestDirty;
+} EntityStore;
+
+void entity_store_init(EntityStore* store);
+bool entity_store_reset(EntityStore* store, const Map* map, const Ghost* ghosts, int ghostCount,
+                        const Pacman* players, int playerCount);
+void entity_store_free(EntityStore* store);
+// active false tira o jogador do indice.
+void entity_store_move_player(EntityStore* store, int player, Position pos, bool active);
+void entity_store_move_ghost(EntityStore* store, int ghost, Position pos);
+// Primeiro slot no tile de pos, ou -1; os seguintes vem de slots[i].next.
+int entity_store_first(const EntityStore* store, Position pos);
+// Jogador ativo mais proximo de pos, ou -1 se nenhum alcanca o tile.
+int entity_store_nearest_player(EntityStore* store, const Map* map, const Pacman* players,
+                                int playerCount, Position pos);
@@ -17,18 +17,28 @@ typedef enum {
 
 typedef struct {
     Position pos;
+    Position prevPos;     // tile antes do ultimo passo, para interpolar o desenho
     Direction dir;
     Direction pendingDir;
-    bool powered;
-    float powerTimeLeft;
+    double pendingTime;
     float moveTimer;
+    int score;
+    int lives;
+    bool active;          // false depois de perder a ultima vida (com outros ainda em jogo)
 } Pacman;
 
+typedef enum {
+    GHOST_STRATEGY_CHASE = 0,
+    GHOST_STRATEGY_AMBUSH,
+    GHOST_STRATEGY_SCATTER,
+    GHOST_STRATEGY_FLEE
+} GhostStrategy;
+
 typedef struct {
     Position pos;
+    Position prevPos;
     Direction dir;
-    bool vulnerable;
-    float vulnerableTimeLeft;
+    GhostStrategy strategy;
     bool alive;
     float moveTimer;
 } Ghost;
@@ -0,0 +1,195 @@
+#include "env.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ENV_FIRST_MAP_PATH "assets/maps/mapa1.txt"
+
+static uint8_t cell_code(char cell) {
+    switch (cell) {
+        case '#': return ENV_CELL_WALL;
+        case '.': return ENV_CELL_PELLET;
+        case 'o': return ENV_CELL_POWER;
+        case 'T': return ENV_CELL_PORTAL;
+        default: return ENV_CELL_EMPTY;
+    }
+}
+
+void env_write_observation(const GameState* game, uint8_t* out) {
+    const Map* map = &game->map;
+    memset(out, ENV_CELL_WALL, ENV_OBS_SIZE);
+    int rows = map->rows < ENV_OBS_ROWS ? map->rows : ENV_OBS_ROWS;
+    int cols = map->cols < ENV_OBS_COLS ? map->cols : ENV_OBS_COLS;
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            out[row * ENV_OBS_COLS + col] = cell_code(map_get(map, row, col));
+        }
+    }
+    for (int i = 0; i < game->ghostCount && game->ghosts; i++) {
+        const Ghost* ghost = &game->ghosts[i];
+        if (!ghost->alive || ghost->pos.row >= rows || ghost->pos.col >= cols) continue;
+        out[ghost->pos.row * ENV_OBS_COLS + ghost->pos.col] =
+            game_ghost_vulnerable(game, ghost) ? ENV_CELL_GHOST_VULNERABLE : ENV_CELL_GHOST;
+    }
+    Position pac = game->players[0].pos;
+    if (pac.row < rows && pac.col < cols) {
+        out[pac.row * ENV_OBS_COLS + pac.col] = ENV_CELL_PACMAN;
+    }
+}
+
+static void write_obs(VecEnv* env, int index) {
+    if (!env->obsOut) return;
+    uint8_t* out = env->obsOut + (size_t)index * env_obs_size(env);
+    if (env->encoders) {
+        bitplane_encode(&env->encoders[index], &env->games[index], (uint64_t*)out);
+    } else {
+        env_write_observation(&env->games[index], out);
+    }
+}
+
+// Reiniciar e copiar a base (sem ler mapa do disco); o gerador continua
+// de onde estava, senao todo episodio repetiria o primeiro.
+static bool reset_one(VecEnv* env, int index) {
+    GameState* game = &env->games[index];
+    uint32_t rngState = game->rngState;
+    if (!game_clone(game, &env->base)) return false;
+    game->rngState = rngState;
+    input_clear(&game->input);
+    env->needsReset[index] = false;
+    return true;
+}
+
+static void reset_task(void* ctx, int index) {
+    VecEnv* env = (VecEnv*)ctx;
+    reset_one(env, index);
+    write_obs(env, index);
+}
+
+static void step_task(void* ctx, int index) {
+    VecEnv* env = (VecEnv*)ctx;
+    GameState* game = &env->games[index];
+    if (env->needsReset[index] && !reset_one(env, index)) {
+        if (env->rewardOut) env->rewardOut[index] = 0.0f;
+        if (env->doneOut) env->doneOut[index] = 1;
+        return;
+    }
+
+    int action = env->actions ? env->actions[index] : DIR_NONE;
+    if (action > DIR_NONE && action <= DIR_RIGHT) {
+        game->players[0].pendingDir = (Direction)action;
+        game->players[0].pendingTime = 0.0;
+    }
+    int scoreBefore = game->players[0].score;
+    game_update(game, ENV_STEP_SECONDS);
+
+    bool done = !game->running || game->phase != GAME_PHASE_PLAYING;
+    env->needsReset[index] = done;
+    if (env->rewardOut) env->rewardOut[index] = (float)(game->players[0].score - scoreBefore);
+    if (env->doneOut) env->doneOut[index] = done ? 1 : 0;
+    write_obs(env, index);
+}
+
+bool env_init(VecEnv* env, int count, int threads, uint32_t seed) {
+    memset(env, 0, sizeof(*env));
+    if (count <= 0) return false;
+    env->games = (GameState*)mem_calloc(MEM_TAG_ENV, (size_t)count, sizeof(GameState));
+    env->needsReset = (bool*)mem_calloc(MEM_TAG_ENV, (size_t)count, sizeof(bool));
+    if (!env->games || !env->needsReset) {
+        mem_free(env->games);
+        mem_free(env->needsReset);
+        return false;
+    }
+    if (!game_init(&env->base, ENV_FIRST_MAP_PATH, 0)) {
+        env_shutdown(env);
+        return false;
+    }
+    game_start_new(&env->base);
+    for (int i = 0; i < count; i++) game_clone_init(&env->games[i]);
+    env->count = count;
+    bool ok = env->base.phase == GAME_PHASE_PLAYING;
+    for (int i = 0; i < count && ok; i++) {
+        ok = game_clone(&env->games[i], &env->base);
+        game_seed(&env->games[i], seed + (uint32_t)i * 0x9E3779B9u);
+    }
+    if (!ok) {
+        env_shutdown(env);
+        return false;
+    }
+
+    if (threads <= 0) threads = thread_pool_cpu_count();
+    if (threads > count) threads = count;
+    env->poolReady = true;
+    if (!thread_pool_init(&env->pool, threads - 1)) {
+        env_shutdown(env);
+        return false;
+    }
+    return true;
+}
+
+void env_shutdown(VecEnv* env) {
+    if (env->poolReady) thread_pool_destroy(&env->pool);
+    for (int i = 0; i < env->count; i++) {
+        game_shutdown(&env->games[i]);
+        if (env->encoders) bitplane_free(&env->encoders[i]);
+    }
+    game_shutdown(&env->base);
+    mem_free(env->encoders);
+    mem_free(env->games);
+    mem_free(env->needsReset);
+    memset(env, 0, sizeof(*env));
+}
+
+void env_reset_batch(VecEnv* env, uint8_t* obs_out) {
+    env->obsOut = obs_out;
+    thread_pool_for(&env->pool, env->count, reset_task, env);
+}
+
+void env_step_batch(VecEnv* env, const int32_t* actions, uint8_t* obs_out,
+                    float* reward_out, uint8_t* done_out) {
+    env->actions = actions;
+    env->obsOut = obs_out;
+    env->rewardOut = reward_out;
+    env->doneOut = done_out;
+    thread_pool_for(&env->pool, env->count, step_task, env);
+}
+
+void env_state_hashes(const VecEnv* env, uint64_t* out) {
+    for (int i = 0; i < env->count; i++) {
+        out[i] = env->games[i].hash;
+    }
+}
+
+VecEnv* env_create(int count, int threads, uint32_t seed) {
+    VecEnv* env = (VecEnv*)mem_alloc(MEM_TAG_ENV, sizeof(VecEnv));
+    if (!env) return NULL;
+    if (!env_init(env, count, threads, seed)) {
+        mem_free(env);
+        return NULL;
+    }
+    return env;
+}
+
+void env_destroy(VecEnv* env) {
+    if (!env) return;
+    env_shutdown(env);
+    mem_free(env);
+}
+
+bool env_use_bitplanes(VecEnv* env, int width, int height) {
+    if (!env->encoders) {
+        env->encoders = (BitplaneEncoder*)mem_calloc(MEM_TAG_ENV, (size_t)env->count, sizeof(BitplaneEncoder));
+        if (!env->encoders) return false;
+    }
+    for (int i = 0; i < env->count; i++) {
+        bitplane_free(&env->encoders[i]);
+        bitplane_init(&env->encoders[i], width, height);
+    }
+    return true;
+}
+
+size_t env_obs_size(const VecEnv* env) {
+    if (env->encoders && env->count > 0) {
+        return bitplane_words(&env->encoders[0]) * sizeof(uint64_t);
+    }
+    return ENV_OBS_SIZE;
+}
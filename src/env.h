@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bitplane.h"
+#include "game.h"
+#include "threadpool.h"
+
+#define ENV_OBS_ROWS MAP_ROWS
+#define ENV_OBS_COLS MAP_COLS
+#define ENV_OBS_SIZE (ENV_OBS_ROWS * ENV_OBS_COLS)
+#define ENV_STEP_SECONDS PACMAN_STEP_INTERVAL
+
+typedef enum {
+    ENV_CELL_EMPTY = 0,
+    ENV_CELL_WALL,
+    ENV_CELL_PELLET,
+    ENV_CELL_POWER,
+    ENV_CELL_PORTAL,
+    ENV_CELL_PACMAN,
+    ENV_CELL_GHOST,
+    ENV_CELL_GHOST_VULNERABLE
+} EnvCell;
+
+// N jogos independentes avancados em lote. Cada passo equivale a um
+// movimento do Pac-Man (ENV_STEP_SECONDS de simulacao). As acoes usam os
+// valores de Direction (0 = manter a intencao atual). Observacoes,
+// recompensas e flags de fim sao escritas direto nos buffers do chamador:
+// obs tem count * env_obs_size(env) bytes. Um jogo que terminou e
+// reiniciado no passo seguinte. Todos partem de copias (game_clone) de
+// base, um jogo novo montado uma vez so no env_init.
+typedef struct {
+    GameState base;
+    GameState* games;
+    bool* needsReset;
+    int count;
+    BitplaneEncoder* encoders;
+    ThreadPool pool;
+    bool poolReady;
+    const int32_t* actions;
+    uint8_t* obsOut;
+    float* rewardOut;
+    uint8_t* doneOut;
+} VecEnv;
+
+bool env_init(VecEnv* env, int count, int threads, uint32_t seed);
+void env_shutdown(VecEnv* env);
+void env_reset_batch(VecEnv* env, uint8_t* obs_out);
+void env_step_batch(VecEnv* env, const int32_t* actions, uint8_t* obs_out,
+                    float* reward_out, uint8_t* done_out);
+void env_write_observation(const GameState* game, uint8_t* out);
+
+// Troca a observacao de um byte por tile pelos planos de bits de
+// bitplane.h (obs deve estar alinhado em 8 bytes). width/height <= 0 usa
+// a grade inteira; senao, recorte centrado no Pac-Man.
+bool env_use_bitplanes(VecEnv* env, int width, int height);
+size_t env_obs_size(const VecEnv* env);
+// Hash Zobrist de cada jogo (count valores), para deduplicar estados.
+void env_state_hashes(const VecEnv* env, uint64_t* out);
+
+// Atalhos para FFI (ctypes/cffi), que nao conhecem sizeof(VecEnv).
+VecEnv* env_create(int count, int threads, uint32_t seed);
+void env_destroy(VecEnv* env);
@@ -0,0 +1,30 @@
+#include "events.h"
+
+void event_ring_init(EventRing* ring) {
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->dropped, 0);
+    for (int i = 0; i < GAME_EVENT_COUNT; i++) atomic_init(&ring->consumed[i], 0);
+}
+
+bool event_ring_push(EventRing* ring, GameEvent event) {
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail >= EVENT_RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    ring->events[head % EVENT_RING_SIZE] = event;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool event_ring_pop(EventRing* ring, GameEvent* out) {
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail == head) return false;
+    *out = ring->events[tail % EVENT_RING_SIZE];
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    atomic_fetch_add_explicit(&ring->consumed[out->type], 1, memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "entity.h"
+
+#define EVENT_RING_SIZE 256
+
+typedef enum {
+    GAME_EVENT_PELLET_EATEN = 0,
+    GAME_EVENT_POWER_ACTIVATED,
+    GAME_EVENT_GHOST_EATEN,
+    GAME_EVENT_LIFE_LOST,
+    GAME_EVENT_LEVEL_CLEARED,
+    GAME_EVENT_GAME_OVER,
+    GAME_EVENT_VICTORY,
+    GAME_EVENT_HUD_MESSAGE,
+    GAME_EVENT_HUD_CLEAR,
+    GAME_EVENT_COUNT
+} GameEventType;
+
+// value: pontos ganhos, vidas restantes, nivel concluido, posicao no
+// ranking (fim de jogo, -1 fora dele) ou id da mensagem do HUD.
+typedef struct {
+    GameEventType type;
+    Position pos;
+    int value;
+} GameEvent;
+
+// Fila single-producer/single-consumer preenchida pela simulacao.
+// consumed conta, por tipo, os eventos ja retirados pelo consumidor.
+typedef struct {
+    GameEvent events[EVENT_RING_SIZE];
+    atomic_uint head;
+    atomic_uint tail;
+    atomic_uint dropped;
+    atomic_uint consumed[GAME_EVENT_COUNT];
+} EventRing;
+
+void event_ring_init(EventRing* ring);
+bool event_ring_push(EventRing* ring, GameEvent event);
+bool event_ring_pop(EventRing* ring, GameEvent* out);
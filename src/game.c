@@ -1,45 +1,179 @@
 #include "game.h"
+#include "memtrack.h"
+#include "metrics.h"
 #include "render.h"
+#include "trace.h"
 #include "save.h"
+#include "zobrist.h"
 #include "raylib.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <limits.h>
-#include <math.h>
+#include <stdatomic.h>
+#include <time.h>
 
 #define SAVE_FILE_PATH "savegame.sav"
 #define RANKING_FILE_PATH "ranking.dat"
-#define DEFAULT_SAMPLE_RATE 22050
+#define MAP_PACK_PATH "assets/maps/mapas.pak"
+#define LEVEL_MAP_FORMAT "assets/maps/mapa%d.txt"
+
+static atomic_uint nextMapRevision = 1;
 
 static void return_to_title(GameState* game);
 static void open_ranking_screen(GameState* game);
-static bool init_audio_assets(GameState* game);
-static void unload_audio_assets(GameState* game);
-static void play_sound_safe(GameState* game, Sound sound);
+static void reset_level_state(GameState* game);
+
+typedef enum {
+    GAME_TIMER_POWER_END = 0,
+    GAME_TIMER_HUD_CLEAR
+} GameTimerKind;
+
+// A simulacao so emite o id; o texto vai para hudMessage quando o evento
+// e consumido (apply_event).
+typedef enum {
+    HUD_MSG_NEW_RECORD = 0,
+    HUD_MSG_ALL_LEVELS_CLEARED,
+    HUD_MSG_GAME_OVER,
+    HUD_MSG_NEW_GAME,
+    HUD_MSG_GAME_LOADED,
+    HUD_MSG_LOAD_FAILED,
+    HUD_MSG_NO_SAVE,
+    HUD_MSG_GAME_SAVED,
+    HUD_MSG_SAVE_FAILED,
+    HUD_MSG_RANKING_SAVED,
+    HUD_MSG_RANKING_FAILED,
+    HUD_MSG_ENTRY_SKIPPED,
+    HUD_MSG_MAP_RELOADED,
+    HUD_MSG_COUNT
+} HudMessageId;
 
-static void set_hud_message(GameState* game, const char* text, float duration) {
-    if (!text) return;
-    snprintf(game->hudMessage, sizeof(game->hudMessage), "%s", text);
-    game->hudMessageTimer = duration;
+static const char* const kHudMessages[HUD_MSG_COUNT] = {
+    [HUD_MSG_NEW_RECORD] = "Novo recorde! Digite seu nome e ENTER.",
+    [HUD_MSG_ALL_LEVELS_CLEARED] = "Todos os niveis concluidos!",
+    [HUD_MSG_GAME_OVER] = "Game Over!",
+    [HUD_MSG_NEW_GAME] = "Novo jogo iniciado!",
+    [HUD_MSG_GAME_LOADED] = "Jogo carregado.",
+    [HUD_MSG_LOAD_FAILED] = "Falha ao carregar jogo.",
+    [HUD_MSG_NO_SAVE] = "Nenhum save encontrado.",
+    [HUD_MSG_GAME_SAVED] = "Jogo salvo.",
+    [HUD_MSG_SAVE_FAILED] = "Erro ao salvar jogo.",
+    [HUD_MSG_RANKING_SAVED] = "Ranking atualizado!",
+    [HUD_MSG_RANKING_FAILED] = "Falha ao salvar ranking.",
+    [HUD_MSG_ENTRY_SKIPPED] = "Registro ignorado.",
+    [HUD_MSG_MAP_RELOADED] = "Mapa recarregado."
+};
+
+static uint32_t seconds_to_ticks(float seconds) {
+    if (seconds <= 0.0f) return 0;
+    return (uint32_t)(seconds / SIM_TICK_DT + 0.5f);
 }
 
-static void update_hud_message(GameState* game, float dt) {
-    if (game->hudMessageTimer > 0.0f) {
-        game->hudMessageTimer -= dt;
-        if (game->hudMessageTimer < 0.0f) {
-            game->hudMessageTimer = 0.0f;
-            game->hudMessage[0] = '\0';
+// Toda mutacao coberta pelo hash passa por estes helpers, que aplicam o
+// delta Zobrist correspondente.
+static void set_powered(GameState* game, bool powered) {
+    if (game->powered == powered) return;
+    game->hash ^= zobrist_powered(true);
+    game->powered = powered;
+}
+
+static void set_score(GameState* game, int score) {
+    game->hash ^= zobrist_score(game->score) ^ zobrist_score(score);
+    game->score = score;
+}
+
+static void set_lives(GameState* game, int lives) {
+    game->hash ^= zobrist_lives(game->lives) ^ zobrist_lives(lives);
+    game->lives = lives;
+}
+
+static void set_level(GameState* game, int level) {
+    game->hash ^= zobrist_level(game->level) ^ zobrist_level(level);
+    game->level = level;
+}
+
+// O score da partida e a soma dos scores dos jogadores.
+static void add_player_score(GameState* game, Pacman* player, int delta) {
+    if (player->score + delta < 0) delta = -player->score;
+    player->score += delta;
+    set_score(game, game->score + delta);
+}
+
+static void move_player(GameState* game, int index, Position pos) {
+    Pacman* player = &game->players[index];
+    if (player->active) game->hash ^= zobrist_pacman(index, player->pos) ^ zobrist_pacman(index, pos);
+    player->pos = pos;
+    entity_store_move_player(&game->entities, index, pos, player->active);
+}
+
+static void remove_player(GameState* game, int index) {
+    Pacman* player = &game->players[index];
+    if (!player->active) return;
+    game->hash ^= zobrist_pacman(index, player->pos);
+    player->active = false;
+    game->activePlayers--;
+    entity_store_move_player(&game->entities, index, player->pos, false);
+}
+
+static void move_ghost(GameState* game, int index, Position pos) {
+    Ghost* ghost = &game->ghosts[index];
+    game->hash ^= zobrist_ghost(index, ghost->pos, ghost->alive) ^ zobrist_ghost(index, pos, ghost->alive);
+    ghost->pos = pos;
+    entity_store_move_ghost(&game->entities, index, pos);
+    if (game->chunks.enabled) chunk_grid_move(&game->chunks, index, pos);
+}
+
+static void set_ghost_alive(GameState* game, int index, bool alive) {
+    Ghost* ghost = &game->ghosts[index];
+    game->hash ^= zobrist_ghost(index, ghost->pos, ghost->alive) ^ zobrist_ghost(index, ghost->pos, alive);
+    ghost->alive = alive;
+}
+
+static void emit_event(GameState* game, GameEventType type, Position pos, int value) {
+    GameEvent event = {.type = type, .pos = pos, .value = value};
+    if (!event_ring_push(&game->events, event)) metrics_add(METRIC_GAME_EVENTS_DROPPED, 1);
+}
+
+static void handle_timer(GameState* game, const TimerExpired* timer) {
+    switch (timer->kind) {
+        case GAME_TIMER_POWER_END:
+            set_powered(game, false);
+            game->powerTimerId = TIMER_NONE;
+            break;
+        case GAME_TIMER_HUD_CLEAR:
+            emit_event(game, GAME_EVENT_HUD_CLEAR, game->players[0].pos, 0);
+            game->hudTimerId = TIMER_NONE;
+            break;
+        default:
+            break;
+    }
+}
+
+static void advance_timers(GameState* game, TimerWheel* wheel, float* accumulator, float dt) {
+    TimerExpired expired[TIMER_WHEEL_CAPACITY];
+    *accumulator += dt;
+    while (*accumulator >= SIM_TICK_DT) {
+        *accumulator -= SIM_TICK_DT;
+        int count = timer_wheel_advance(wheel, expired, TIMER_WHEEL_CAPACITY);
+        for (int i = 0; i < count; i++) {
+            handle_timer(game, &expired[i]);
         }
     }
 }
 
-static int manhattan(Position a, Position b) {
-    int dr = a.row - b.row;
-    if (dr < 0) dr = -dr;
-    int dc = a.col - b.col;
-    if (dc < 0) dc = -dc;
-    return dr + dc;
+static void schedule_hud_clear(GameState* game, float duration) {
+    timer_wheel_cancel(&game->uiTimers, game->hudTimerId);
+    game->hudTimerId = timer_wheel_schedule(&game->uiTimers, seconds_to_ticks(duration),
+                                            GAME_TIMER_HUD_CLEAR, 0);
+}
+
+static void show_hud_message(GameState* game, HudMessageId message, float duration) {
+    emit_event(game, GAME_EVENT_HUD_MESSAGE, game->players[0].pos, (int)message);
+    schedule_hud_clear(game, duration);
+}
+
+static void update_hud_message(GameState* game, float dt) {
+    advance_timers(game, &game->uiTimers, &game->uiTimerAccumulator, dt);
 }
 
 static Direction opposite(Direction dir) {
@@ -63,12 +197,11 @@ static Position next_position(Position pos, Direction dir) {
     return pos;
 }
 
+// pos e sempre um tile do mapa, entao o vizinho cai no maximo na borda de
+// paredes da grade.
 static bool can_move_to(const Map* map, Position pos, Direction dir) {
     if (dir == DIR_NONE) return false;
-    Position next = next_position(pos, dir);
-    if (!map_in_bounds(map, next.row, next.col)) return false;
-    char cell = map_get(map, next.row, next.col);
-    return cell != '#';
+    return map->grid[map_index(map, pos.row, pos.col) + map_step(map, dir)] != '#';
 }
 
 static bool same_position(Position a, Position b) {
@@ -93,12 +226,15 @@ static void teleport_if_portal(Position* pos, const Map* map) {
     }
 }
 
+static void stop_player(Pacman* player) {
+    player->dir = DIR_NONE;
+    player->pendingDir = DIR_NONE;
+    player->pendingTime = 0.0;
+}
+
 static void trigger_end_state(GameState* game, bool victory) {
     game->paused = true;
-    game->pacman.dir = DIR_NONE;
-    game->pacman.pendingDir = DIR_NONE;
-    const char* msg = victory ? "Todos os niveis concluidos!" : "Game Over!";
-    play_sound_safe(game, victory ? game->winSound : game->loseLifeSound);
+    for (int i = 0; i < game->playerCount; i++) stop_player(&game->players[i]);
     int rankPos = ranking_position_for_score(&game->ranking, game->score);
     game->postPhase = victory ? GAME_PHASE_VICTORY : GAME_PHASE_GAMEOVER;
     if (rankPos >= 0) {
@@ -107,127 +243,231 @@ static void trigger_end_state(GameState* game, bool victory) {
         game->pendingRankingIndex = rankPos;
         game->nameEntryLen = 0;
         game->nameEntry[0] = '\0';
-        set_hud_message(game, "Novo recorde! Digite seu nome e ENTER.", HUD_MESSAGE_TIME);
     } else {
         game->phase = game->postPhase;
-        set_hud_message(game, msg, HUD_MESSAGE_TIME);
     }
+    // O texto (recorde ou fim) sai do proprio evento, em apply_event.
+    emit_event(game, victory ? GAME_EVENT_VICTORY : GAME_EVENT_GAME_OVER, game->players[0].pos, rankPos);
+    schedule_hud_clear(game, HUD_MESSAGE_TIME);
 }
 
 static void activate_power_mode(GameState* game) {
-    game->pacman.powered = true;
-    game->pacman.powerTimeLeft = POWER_MODE_DURATION;
-    if (!game->ghosts) return;
-    for (int i = 0; i < game->ghostCount; i++) {
-        game->ghosts[i].vulnerable = true;
-        game->ghosts[i].vulnerableTimeLeft = POWER_MODE_DURATION;
-    }
+    game_set_power(game, true, POWER_MODE_DURATION);
 }
 
 static void update_power_mode(GameState* game, float dt) {
-    if (game->pacman.powered) {
-        game->pacman.powerTimeLeft -= dt;
-        if (game->pacman.powerTimeLeft <= 0.0f) {
-            game->pacman.powered = false;
-            game->pacman.powerTimeLeft = 0.0f;
-        }
-    }
-    if (!game->ghosts) return;
-    for (int i = 0; i < game->ghostCount; i++) {
-        Ghost* ghost = &game->ghosts[i];
-        if (!ghost->vulnerable) continue;
-        ghost->vulnerableTimeLeft -= dt;
-        if (ghost->vulnerableTimeLeft <= 0.0f) {
-            ghost->vulnerable = false;
-            ghost->vulnerableTimeLeft = 0.0f;
-        }
-    }
+    advance_timers(game, &game->timers, &game->timerAccumulator, dt);
+}
+
+static void record_tile_change(GameState* game, Position pos) {
+    game->tileChanges[game->tileChangeCount % GAME_TILE_LOG_SIZE] = pos;
+    game->tileChangeCount++;
 }
 
-static void handle_tile(GameState* game) {
+static void clear_tile(GameState* game, Position pos) {
+    char* cell = &game->map.grid[map_index(&game->map, pos.row, pos.col)];
+    game->hash ^= zobrist_tile(pos.row, pos.col, *cell) ^ zobrist_tile(pos.row, pos.col, ' ');
+    *cell = ' ';
+    record_tile_change(game, pos);
+}
+
+static void handle_tile(GameState* game, int index) {
     Map* map = &game->map;
-    Pacman* pac = &game->pacman;
-    char cell = map_get(map, pac->pos.row, pac->pos.col);
+    Pacman* pac = &game->players[index];
+    char cell = map_tile(map, pac->pos.row, pac->pos.col);
     switch (cell) {
         case '.':
-            map_set(map, pac->pos.row, pac->pos.col, ' ');
-            game->score += 10;
+            clear_tile(game, pac->pos);
+            add_player_score(game, pac, 10);
             if (game->pelletsRemaining > 0) game->pelletsRemaining--;
             if (map->pelletsRemaining > 0) map->pelletsRemaining--;
-            play_sound_safe(game, game->pelletSound);
+            emit_event(game, GAME_EVENT_PELLET_EATEN, pac->pos, 10);
             break;
         case 'o':
-            map_set(map, pac->pos.row, pac->pos.col, ' ');
-            game->score += 50;
+            clear_tile(game, pac->pos);
+            add_player_score(game, pac, 50);
             if (game->pelletsRemaining > 0) game->pelletsRemaining--;
             if (map->pelletsRemaining > 0) map->pelletsRemaining--;
             activate_power_mode(game);
-            play_sound_safe(game, game->powerSound);
+            emit_event(game, GAME_EVENT_POWER_ACTIVATED, pac->pos, 50);
             break;
         default:
             break;
     }
 }
 
-static void handle_pacman_hit(GameState* game) {
-    if (game->score >= 200) {
-        game->score -= 200;
-    } else {
-        game->score = 0;
+static void send_ghost_home(GameState* game, int index) {
+    if (!game->map.ghostStarts || index >= game->map.ghostCount) return;
+    Ghost* ghost = &game->ghosts[index];
+    move_ghost(game, index, game->map.ghostStarts[index]);
+    ghost->prevPos = ghost->pos;
+    ghost->dir = DIR_NONE;
+    ghost->moveTimer = 0.0f;
+}
+
+static void handle_pacman_hit(GameState* game, int index, int ghostIndex) {
+    Pacman* player = &game->players[index];
+    add_player_score(game, player, -200);
+    if (player->lives > 0) {
+        player->lives--;
+        set_lives(game, game->lives - 1);
+    }
+    if (player->lives <= 0) {
+        if (game->activePlayers <= 1) {
+            trigger_end_state(game, false);
+            return;
+        }
+        emit_event(game, GAME_EVENT_LIFE_LOST, player->pos, 0);
+        remove_player(game, index);
+        send_ghost_home(game, ghostIndex);
+        return;
     }
-    if (game->lives > 0) game->lives--;
-    if (game->lives <= 0) {
-        trigger_end_state(game, false);
+    emit_event(game, GAME_EVENT_LIFE_LOST, player->pos, player->lives);
+    move_player(game, index, game->map.pacmanStart);
+    player->prevPos = player->pos;
+    stop_player(player);
+    player->moveTimer = 0.0f;
+    // Com varios jogadores so o fantasma que acertou volta para a casa: um
+    // jogador pego nao reinicia a rodada dos outros.
+    if (game->playerCount > 1) {
+        send_ghost_home(game, ghostIndex);
         return;
     }
-    play_sound_safe(game, game->loseLifeSound);
-    game->pacman.pos = game->map.pacmanStart;
-    game->pacman.dir = DIR_NONE;
-    game->pacman.pendingDir = DIR_NONE;
-    game->pacman.powered = false;
-    game->pacman.powerTimeLeft = 0.0f;
-    game->pacman.moveTimer = 0.0f;
-    if (!game->ghosts || !game->map.ghostStarts) return;
+    game_set_power(game, false, 0.0f);
+    if (!game->ghosts) return;
     for (int i = 0; i < game->ghostCount; i++) {
-        Ghost* ghost = &game->ghosts[i];
-        if (!ghost->alive) continue;
-        ghost->pos = game->map.ghostStarts[i];
-        ghost->dir = DIR_NONE;
-        ghost->vulnerable = false;
-        ghost->vulnerableTimeLeft = 0.0f;
-        ghost->moveTimer = 0.0f;
+        if (game->ghosts[i].alive) send_ghost_home(game, i);
     }
 }
 
-static void handle_collisions(GameState* game) {
+// Retorna true se o jogador foi pego.
+static bool resolve_contact(GameState* game, int player, int ghostIndex) {
+    Ghost* ghost = &game->ghosts[ghostIndex];
+    Pacman* pac = &game->players[player];
+    game->tickCollisionChecks++;
+    if (!ghost->alive || !pac->active) return false;
+    if (!same_position(ghost->pos, pac->pos)) return false;
+    if (game_ghost_vulnerable(game, ghost)) {
+        set_ghost_alive(game, ghostIndex, false);
+        add_player_score(game, pac, 100);
+        emit_event(game, GAME_EVENT_GHOST_EATEN, ghost->pos, 100);
+        return false;
+    }
+    handle_pacman_hit(game, player, ghostIndex);
+    return true;
+}
+
+// Colisoes so olham quem divide o tile, pela lista do EntityStore: os
+// jogadores vem antes dos fantasmas e cada grupo em ordem de indice.
+static void collide_player(GameState* game, int player) {
     if (!game->ghosts) return;
-    for (int i = 0; i < game->ghostCount; i++) {
-        Ghost* ghost = &game->ghosts[i];
-        if (!ghost->alive) continue;
-        if (!same_position(ghost->pos, game->pacman.pos)) continue;
-        if (game->pacman.powered && ghost->vulnerable) {
-            ghost->alive = false;
-            ghost->vulnerable = false;
-            ghost->vulnerableTimeLeft = 0.0f;
-            game->score += 100;
-            play_sound_safe(game, game->ghostSound);
-        } else {
-            handle_pacman_hit(game);
-            return;
-        }
+    const EntityStore* store = &game->entities;
+    for (int slot = entity_store_first(store, game->players[player].pos); slot >= 0;) {
+        int next = store->slots[slot].next;
+        if (slot >= ENTITY_GHOST_SLOT(0) && resolve_contact(game, player, slot - ENTITY_GHOST_SLOT(0))) return;
+        slot = next;
     }
 }
 
-static Direction read_pacman_input(void) {
-    if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D)) return DIR_RIGHT;
-    if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A)) return DIR_LEFT;
-    if (IsKeyDown(KEY_UP) || IsKeyDown(KEY_W)) return DIR_UP;
-    if (IsKeyDown(KEY_DOWN) || IsKeyDown(KEY_S)) return DIR_DOWN;
+static void collide_ghost(GameState* game, int ghostIndex) {
+    const EntityStore* store = &game->entities;
+    for (int slot = entity_store_first(store, game->ghosts[ghostIndex].pos);
+         slot >= 0 && slot < ENTITY_GHOST_SLOT(0);) {
+        int next = store->slots[slot].next;
+        if (resolve_contact(game, slot, ghostIndex)) return;
+        slot = next;
+    }
+}
+
+static void handle_collisions(GameState* game) {
+    for (int p = 0; p < game->playerCount; p++) {
+        if (game->players[p].active) collide_player(game, p);
+    }
+}
+
+// Sozinho, o jogador 1 usa setas e WASD; com dois humanos o segundo fica
+// com WASD.
+static bool uses_wasd(const GameState* game, int player) {
+    return game->humanPlayers >= 2 ? player == 1 : player == 0;
+}
+
+static Direction read_pacman_input(const GameState* game, int player) {
+    const GameInput* input = &game->input;
+    bool arrows = player == 0;
+    bool wasd = uses_wasd(game, player);
+    if ((arrows && input_key_down(input, KEY_RIGHT)) || (wasd && input_key_down(input, KEY_D))) return DIR_RIGHT;
+    if ((arrows && input_key_down(input, KEY_LEFT)) || (wasd && input_key_down(input, KEY_A))) return DIR_LEFT;
+    if ((arrows && input_key_down(input, KEY_UP)) || (wasd && input_key_down(input, KEY_W))) return DIR_UP;
+    if ((arrows && input_key_down(input, KEY_DOWN)) || (wasd && input_key_down(input, KEY_S))) return DIR_DOWN;
     return DIR_NONE;
 }
 
-static bool advance_pacman_step(GameState* game) {
-    Pacman* pac = &game->pacman;
+static int player_for_key(const GameState* game, int key) {
+    switch (key) {
+        case KEY_RIGHT: case KEY_LEFT: case KEY_UP: case KEY_DOWN:
+            return game->humanPlayers >= 1 ? 0 : -1;
+        case KEY_D: case KEY_A: case KEY_W: case KEY_S:
+            if (game->humanPlayers >= 2) return 1;
+            return game->humanPlayers == 1 ? 0 : -1;
+        default:
+            return -1;
+    }
+}
+
+static Direction direction_for_key(int key) {
+    switch (key) {
+        case KEY_RIGHT: case KEY_D: return DIR_RIGHT;
+        case KEY_LEFT: case KEY_A: return DIR_LEFT;
+        case KEY_UP: case KEY_W: return DIR_UP;
+        case KEY_DOWN: case KEY_S: return DIR_DOWN;
+        default: return DIR_NONE;
+    }
+}
+
+static void apply_input_events(GameState* game, double until) {
+    GameInput* input = &game->input;
+    while (input->eventRead < input->eventCount && input->events[input->eventRead].time <= until) {
+        const InputEvent* event = &input->events[input->eventRead++];
+        Direction dir = direction_for_key(event->key);
+        int player = player_for_key(game, event->key);
+        if (dir == DIR_NONE || player < 0 || !game->players[player].active) continue;
+        game->players[player].pendingDir = dir;
+        game->players[player].pendingTime = event->time;
+    }
+}
+
+// Bots seguem o corredor e, nos cruzamentos, preferem uma saida com pellet;
+// sem pellet a vista sorteiam uma saida sem voltar.
+static void choose_bot_direction(GameState* game, Pacman* pac) {
+    const Map* map = &game->map;
+    Direction all[4] = {DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT};
+    Direction back = opposite(pac->dir);
+    Direction options[4];
+    int count = 0;
+    Direction pellet = DIR_NONE;
+    for (int i = 0; i < 4; i++) {
+        if (all[i] == back || !can_move_to(map, pac->pos, all[i])) continue;
+        options[count++] = all[i];
+        Position next = next_position(pac->pos, all[i]);
+        char cell = map_tile(map, next.row, next.col);
+        if (pellet == DIR_NONE && (cell == '.' || cell == 'o')) pellet = all[i];
+    }
+    if (count == 0) pac->pendingDir = back;
+    else if (pellet != DIR_NONE) pac->pendingDir = pellet;
+    else pac->pendingDir = options[game_random(game, 0, count - 1)];
+}
+
+static bool advance_pacman_step(GameState* game, int index, double stepTime) {
+    Pacman* pac = &game->players[index];
+    if (!pac->active) return false;
+    // A latencia vai ate o primeiro passo que podia aplicar a curva; se a
+    // parede ainda bloqueia, a espera seguinte e do jogador, nao do jogo.
+    // Uma tecla segurada e lida no proprio tick, depois do passo.
+    if (pac->pendingTime > 0.0) {
+        double applied = stepTime > pac->pendingTime ? stepTime : pac->pendingTime;
+        input_latency_record(&game->inputLatency, applied - pac->pendingTime);
+        pac->pendingTime = 0.0;
+    }
     if (pac->pendingDir != DIR_NONE && can_move_to(&game->map, pac->pos, pac->pendingDir)) {
         pac->dir = pac->pendingDir;
     }
@@ -236,27 +476,94 @@ static bool advance_pacman_step(GameState* game) {
         pac->dir = DIR_NONE;
         return false;
     }
-    pac->pos = next_position(pac->pos, pac->dir);
-    teleport_if_portal(&pac->pos, &game->map);
-    handle_tile(game);
-    handle_collisions(game);
+    pac->prevPos = pac->pos;
+    Position next = next_position(pac->pos, pac->dir);
+    teleport_if_portal(&next, &game->map);
+    move_player(game, index, next);
+    handle_tile(game, index);
+    collide_player(game, index);
     return true;
 }
 
-static void update_pacman(GameState* game, float dt) {
-    Direction input = read_pacman_input();
-    if (input != DIR_NONE) {
-        game->pacman.pendingDir = input;
+static void update_pacman(GameState* game, int index, float dt) {
+    Pacman* pac = &game->players[index];
+    bool human = index < game->humanPlayers;
+    if (human && pac->pendingDir == DIR_NONE) {
+        Direction held = read_pacman_input(game, index);
+        if (held != DIR_NONE) {
+            pac->pendingDir = held;
+            pac->pendingTime = game->input.tickTime;
+        }
+    }
+    pac->moveTimer += dt;
+    int steps = 0;
+    while (pac->moveTimer >= PACMAN_STEP_INTERVAL && steps++ < ENTITY_MAX_STEPS_PER_UPDATE) {
+        double stepTime = game->input.tickTime - (pac->moveTimer - PACMAN_STEP_INTERVAL);
+        if (human) apply_input_events(game, stepTime);
+        else choose_bot_direction(game, pac);
+        if (!advance_pacman_step(game, index, stepTime)) {
+            // Parado nao acumula passos: o proximo fica pronto no tick
+            // seguinte, em vez de virar uma rajada quando a tecla chegar.
+            pac->prevPos = pac->pos;
+            float ready = PACMAN_STEP_INTERVAL - dt;
+            if (pac->moveTimer > ready) pac->moveTimer = ready > 0.0f ? ready : 0.0f;
+            break;
+        }
+        pac->moveTimer -= PACMAN_STEP_INTERVAL;
+    }
+    if (human) apply_input_events(game, game->input.tickTime);
+}
+
+static void update_players(GameState* game, float dt) {
+    for (int i = 0; i < game->playerCount; i++) {
+        if (game->players[i].active) update_pacman(game, i, dt);
     }
-    game->pacman.moveTimer += dt;
-    while (game->pacman.moveTimer >= PACMAN_STEP_INTERVAL) {
-        if (!advance_pacman_step(game)) break;
-        game->pacman.moveTimer -= PACMAN_STEP_INTERVAL;
+}
+
+// Mapas grandes usam o anel de blocos do ultimo gather; nos pequenos o
+// campo de jogador mais proximo do EntityStore serve todos os fantasmas.
+static int nearest_player(GameState* game, Position pos) {
+    if (game->playerCount == 1) return 0;
+    int player = game->chunks.enabled
+                     ? chunk_grid_nearest_player(&game->chunks, pos)
+                     : entity_store_nearest_player(&game->entities, &game->map, game->players,
+                                                   game->playerCount, pos);
+    return player >= 0 ? player : 0;
+}
+
+_Static_assert(PATH_TRACKED_FIELDS >= 2 * GAME_MAX_PLAYERS, "dois campos de rota por jogador");
+
+// Alvo do fantasma e o campo de rotas que o serve (-1 = cache LRU, para os
+// cantos de dispersao). Fugindo, todo fantasma foge do jogador mais
+// proximo, inclusive os de dispersao.
+static Position ghost_target(GameState* game, const Ghost* ghost, int index, bool flee, int* field) {
+    int player = nearest_player(game, ghost->pos);
+    const Pacman* pac = &game->players[player];
+    *field = player * 2;
+    if (flee) return pac->pos;
+    switch (ghost->strategy) {
+        case GHOST_STRATEGY_AMBUSH: {
+            Position ahead = pac->pos;
+            for (int i = 0; i < GHOST_AMBUSH_LOOKAHEAD; i++) {
+                if (!can_move_to(&game->map, ahead, pac->dir)) break;
+                ahead = next_position(ahead, pac->dir);
+            }
+            *field = player * 2 + 1;
+            return ahead;
+        }
+        case GHOST_STRATEGY_SCATTER:
+            *field = -1;
+            return ghost_scatter_corner(&game->map, index);
+        case GHOST_STRATEGY_CHASE:
+        case GHOST_STRATEGY_FLEE:
+        default:
+            return pac->pos;
     }
 }
 
-static Direction choose_ghost_direction(const GameState* game, const Ghost* ghost) {
+static Direction choose_ghost_direction(GameState* game, const Ghost* ghost, int index) {
     const Map* map = &game->map;
+    game->tickGhostDecisions++;
     Direction options[4];
     int count = 0;
     Direction all[4] = {DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT};
@@ -284,75 +591,236 @@ static Direction choose_ghost_direction(const GameState* game, const Ghost* ghos
         for (int i = 0; i < count; i++) filtered[i] = options[i];
     }
 
-    bool chase = !game->pacman.powered;
+    bool flee = game->powered || ghost->strategy == GHOST_STRATEGY_FLEE;
+    int field;
+    Position target = ghost_target(game, ghost, index, flee, &field);
     Direction bestDir = DIR_NONE;
-    int bestScore = chase ? INT_MAX : INT_MIN;
+    int bestScore = INT_MAX;
 
     for (int i = 0; i < filteredCount; i++) {
         Direction dir = filtered[i];
         Position next = next_position(ghost->pos, dir);
-        int dist = manhattan(next, game->pacman.pos);
-        int score = chase ? dist : -dist;
-        if ((chase && score < bestScore) || (!chase && score > bestScore)) {
+        int dist = path_tracked_distance(&game->paths, map, field, next, target);
+        // Sem rota (ou alem do limite de profundidade) e a pior opcao nos
+        // dois modos: fugir para la nao e fugir.
+        int score = dist == PATH_UNREACHABLE ? INT_MAX : (flee ? -dist : dist);
+        if (score < bestScore) {
             bestScore = score;
             bestDir = dir;
         }
     }
 
     if (bestDir == DIR_NONE) {
-        int idx = GetRandomValue(0, filteredCount - 1);
+        int idx = game_random(game, 0, filteredCount - 1);
         bestDir = filtered[idx];
     }
     return bestDir;
 }
 
+// Modelo barato para fantasmas longe do Pac-Man: segue o corredor e so
+// sorteia uma saida (sem voltar) em cruzamentos e becos, sem consultar rotas.
+static Direction choose_corridor_direction(GameState* game, const Ghost* ghost) {
+    const Map* map = &game->map;
+    game->tickGhostDecisions++;
+    Direction current = ghost->dir;
+    Direction oppositeDir = opposite(current);
+    Direction options[4];
+    int count = 0;
+    Direction all[4] = {DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT};
+    for (int i = 0; i < 4; i++) {
+        if (all[i] != oppositeDir && can_move_to(map, ghost->pos, all[i])) {
+            options[count++] = all[i];
+        }
+    }
+    if (count == 0) return can_move_to(map, ghost->pos, oppositeDir) ? oppositeDir : DIR_NONE;
+    if (count == 1) return options[0];
+    return options[game_random(game, 0, count - 1)];
+}
+
+static void step_ghost(GameState* game, int index, float dt, bool fullAi) {
+    Ghost* ghost = &game->ghosts[index];
+    float interval = game_ghost_vulnerable(game, ghost) ? GHOST_STEP_INTERVAL_VULNERABLE : GHOST_STEP_INTERVAL;
+    ghost->moveTimer += dt;
+    int steps = 0;
+    while (ghost->moveTimer >= interval && steps++ < ENTITY_MAX_STEPS_PER_UPDATE) {
+        ghost->moveTimer -= interval;
+        Direction nextDir = fullAi ? choose_ghost_direction(game, ghost, index)
+                                   : choose_corridor_direction(game, ghost);
+        ghost->prevPos = ghost->pos;
+        if (nextDir == DIR_NONE) break;
+        ghost->dir = nextDir;
+        Position next = next_position(ghost->pos, ghost->dir);
+        teleport_if_portal(&next, &game->map);
+        move_ghost(game, index, next);
+        collide_ghost(game, index);
+    }
+}
+
 static void update_ghosts(GameState* game, float dt) {
     if (!game->ghosts) return;
-    for (int i = 0; i < game->ghostCount; i++) {
-        Ghost* ghost = &game->ghosts[i];
-        if (!ghost->alive) continue;
-        float interval = ghost->vulnerable ? GHOST_STEP_INTERVAL_VULNERABLE : GHOST_STEP_INTERVAL;
-        ghost->moveTimer += dt;
-        while (ghost->moveTimer >= interval) {
-            ghost->moveTimer -= interval;
-            Direction nextDir = choose_ghost_direction(game, ghost);
-            if (nextDir == DIR_NONE) break;
-            ghost->dir = nextDir;
-            ghost->pos = next_position(ghost->pos, ghost->dir);
-            teleport_if_portal(&ghost->pos, &game->map);
-            handle_collisions(game);
+    ChunkGrid* chunks = &game->chunks;
+    if (!chunks->enabled) {
+        for (int i = 0; i < game->ghostCount; i++) {
+            if (game->ghosts[i].alive) step_ghost(game, i, dt, true);
         }
+        return;
+    }
+    // Blocos no anel intermediario acumulam CHUNK_LOD_DIVISOR ticks por
+    // atualizacao; o limite de passos por update cobre a diferenca.
+    int activeCount = 0;
+    int count = chunk_grid_gather(chunks, game->ghosts, game->players, game->playerCount, &activeCount);
+    for (int k = 0; k < count; k++) {
+        int i = chunks->work[k];
+        if (!game->ghosts[i].alive) continue;
+        bool fullAi = k < activeCount;
+        step_ghost(game, i, fullAi ? dt : dt * CHUNK_LOD_DIVISOR, fullAi);
+    }
+    chunks->fullSteps += (unsigned long long)activeCount;
+    chunks->lodSteps += (unsigned long long)(count - activeCount);
+}
+
+static bool load_level_from_pack(GameState* game, int level, const char* sourcePath) {
+    if (!game->mapPackReady || level > game->mapPack.levelCount) return false;
+    if (mappack_is_stale(&game->mapPack, sourcePath)) return false;
+    double start = metrics_now();
+    Map map;
+    trace_begin("load_level_from_pack");
+    if (!mappack_load_level(&game->mapPack, level, &map)) {
+        trace_end("load_level_from_pack");
+        return false;
     }
+    map_free(&game->map);
+    game->map = map;
+    snprintf(game->currentMapPath, sizeof(game->currentMapPath), "%s#%d", MAP_PACK_PATH, level);
+    reset_level_state(game);
+    trace_end("load_level_from_pack");
+    metrics_observe(METRIC_TIMER_LEVEL_LOAD, metrics_now() - start);
+    return true;
 }
 
 static bool load_level_number(GameState* game, int level) {
     char path[64];
-    snprintf(path, sizeof(path), "assets/maps/mapa%d.txt", level);
-    if (!game_load_level(game, path)) {
-        return false;
+    snprintf(path, sizeof(path), LEVEL_MAP_FORMAT, level);
+    if (!load_level_from_pack(game, level, path)) {
+        if (!game_load_level(game, path)) {
+            return false;
+        }
     }
-    game->level = level;
+    set_level(game, level);
     return true;
 }
 
 static void check_level_transition(GameState* game) {
     if (game->pelletsRemaining > 0) return;
+    emit_event(game, GAME_EVENT_LEVEL_CLEARED, game->players[0].pos, game->level);
     int nextLevel = game->level + 1;
     if (!load_level_number(game, nextLevel)) {
         trigger_end_state(game, true);
     }
 }
 
-static void start_new_game(GameState* game) {
+static void play_event(GameState* game, const GameEvent* event) {
+    switch (event->type) {
+        case GAME_EVENT_PELLET_EATEN:
+            audio_play(&game->audio, SYNTH_SOUND_PELLET);
+            break;
+        case GAME_EVENT_POWER_ACTIVATED:
+            audio_play(&game->audio, SYNTH_SOUND_POWER);
+            break;
+        case GAME_EVENT_GHOST_EATEN:
+            audio_play(&game->audio, SYNTH_SOUND_GHOST);
+            break;
+        case GAME_EVENT_LIFE_LOST:
+        case GAME_EVENT_GAME_OVER:
+            audio_play(&game->audio, SYNTH_SOUND_LOSE_LIFE);
+            break;
+        case GAME_EVENT_VICTORY:
+            audio_play(&game->audio, SYNTH_SOUND_WIN);
+            break;
+        case GAME_EVENT_LEVEL_CLEARED:
+        default:
+            break;
+    }
+}
+
+// Lado do estado: so o texto do HUD, que vai no snapshot e no statestream.
+static void apply_event(GameState* game, const GameEvent* event) {
+    int message;
+    switch (event->type) {
+        case GAME_EVENT_HUD_MESSAGE:
+            message = event->value;
+            break;
+        case GAME_EVENT_VICTORY:
+            message = event->value >= 0 ? HUD_MSG_NEW_RECORD : HUD_MSG_ALL_LEVELS_CLEARED;
+            break;
+        case GAME_EVENT_GAME_OVER:
+            message = event->value >= 0 ? HUD_MSG_NEW_RECORD : HUD_MSG_GAME_OVER;
+            break;
+        case GAME_EVENT_HUD_CLEAR:
+            game->hudMessage[0] = '\0';
+            return;
+        default:
+            return;
+    }
+    if (message < 0 || message >= HUD_MSG_COUNT) return;
+    snprintf(game->hudMessage, sizeof(game->hudMessage), "%s", kHudMessages[message]);
+}
+
+void game_consume_events(GameState* game) {
+    GameEvent event;
+    while (event_ring_pop(&game->events, &event)) {
+        apply_event(game, &event);
+        play_event(game, &event);
+    }
+}
+
+int game_drain_events(GameState* game, GameEvent* out, int capacity) {
+    GameEvent event;
+    int count = 0;
+    while (event_ring_pop(&game->events, &event)) {
+        apply_event(game, &event);
+        if (count < capacity) out[count++] = event;
+        else metrics_add(METRIC_GAME_EVENTS_DROPPED, 1);
+    }
+    return count;
+}
+
+void game_play_events(GameState* game, const GameEvent* events, int count) {
+    for (int i = 0; i < count; i++) play_event(game, &events[i]);
+}
+
+static void reset_players(GameState* game) {
     game->score = 0;
-    game->lives = PACMAN_START_LIVES;
+    game->lives = 0;
+    for (int i = 0; i < game->playerCount; i++) {
+        Pacman* player = &game->players[i];
+        player->score = 0;
+        player->lives = PACMAN_START_LIVES;
+        player->active = true;
+        game->lives += PACMAN_START_LIVES;
+    }
+    game->activePlayers = game->playerCount;
+}
+
+static void place_players(GameState* game) {
+    for (int i = 0; i < game->playerCount; i++) {
+        Pacman* player = &game->players[i];
+        player->pos = game->map.pacmanStart;
+        player->prevPos = player->pos;
+        stop_player(player);
+        player->moveTimer = 0.0f;
+    }
+}
+
+void game_start_new(GameState* game) {
+    reset_players(game);
     if (!load_level_number(game, 1)) {
         game->running = false;
     } else {
         game->running = true;
         game->phase = GAME_PHASE_PLAYING;
         game->paused = false;
-        set_hud_message(game, "Novo jogo iniciado!", HUD_MESSAGE_TIME);
+        show_hud_message(game, HUD_MSG_NEW_GAME, HUD_MESSAGE_TIME);
     }
 }
 
@@ -364,22 +832,22 @@ static void close_menu(GameState* game) {
 static void execute_menu_action(GameState* game, MenuAction action) {
     switch (action) {
         case MENU_ACTION_NEW_GAME:
-            start_new_game(game);
+            game_start_new(game);
             close_menu(game);
             break;
         case MENU_ACTION_LOAD:
             if (load_game(game, SAVE_FILE_PATH)) {
-                set_hud_message(game, "Jogo carregado.", HUD_MESSAGE_TIME);
+                show_hud_message(game, HUD_MSG_GAME_LOADED, HUD_MESSAGE_TIME);
                 close_menu(game);
             } else {
-                set_hud_message(game, "Falha ao carregar jogo.", HUD_MESSAGE_TIME);
+                show_hud_message(game, HUD_MSG_LOAD_FAILED, HUD_MESSAGE_TIME);
             }
             break;
         case MENU_ACTION_SAVE:
             if (save_game(game, SAVE_FILE_PATH)) {
-                set_hud_message(game, "Jogo salvo.", HUD_MESSAGE_TIME);
+                show_hud_message(game, HUD_MSG_GAME_SAVED, HUD_MESSAGE_TIME);
             } else {
-                set_hud_message(game, "Erro ao salvar jogo.", HUD_MESSAGE_TIME);
+                show_hud_message(game, HUD_MSG_SAVE_FAILED, HUD_MESSAGE_TIME);
             }
             break;
         case MENU_ACTION_QUIT:
@@ -396,14 +864,14 @@ static void execute_menu_action(GameState* game, MenuAction action) {
 
 static void handle_menu_input(GameState* game) {
     MenuState* menu = &game->menu;
-    if (IsKeyPressed(KEY_DOWN)) menu_next(menu);
-    if (IsKeyPressed(KEY_UP)) menu_prev(menu);
-    if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE)) menu_commit(menu);
-    if (IsKeyPressed(KEY_N)) menu->pendingAction = MENU_ACTION_NEW_GAME;
-    if (IsKeyPressed(KEY_C)) menu->pendingAction = MENU_ACTION_LOAD;
-    if (IsKeyPressed(KEY_S)) menu->pendingAction = MENU_ACTION_SAVE;
-    if (IsKeyPressed(KEY_Q)) menu->pendingAction = MENU_ACTION_QUIT;
-    if (IsKeyPressed(KEY_V)) menu->pendingAction = MENU_ACTION_RESUME;
+    if (input_key_pressed(&game->input, KEY_DOWN)) menu_next(menu);
+    if (input_key_pressed(&game->input, KEY_UP)) menu_prev(menu);
+    if (input_key_pressed(&game->input, KEY_ENTER) || input_key_pressed(&game->input, KEY_SPACE)) menu_commit(menu);
+    if (input_key_pressed(&game->input, KEY_N)) menu->pendingAction = MENU_ACTION_NEW_GAME;
+    if (input_key_pressed(&game->input, KEY_C)) menu->pendingAction = MENU_ACTION_LOAD;
+    if (input_key_pressed(&game->input, KEY_S)) menu->pendingAction = MENU_ACTION_SAVE;
+    if (input_key_pressed(&game->input, KEY_Q)) menu->pendingAction = MENU_ACTION_QUIT;
+    if (input_key_pressed(&game->input, KEY_V)) menu->pendingAction = MENU_ACTION_RESUME;
     if (menu->pendingAction != MENU_ACTION_NONE) {
         execute_menu_action(game, menu->pendingAction);
         menu->pendingAction = MENU_ACTION_NONE;
@@ -411,17 +879,17 @@ static void handle_menu_input(GameState* game) {
 }
 
 static void handle_end_screen_input(GameState* game) {
-    if (IsKeyPressed(KEY_N) || IsKeyPressed(KEY_ENTER)) {
-        start_new_game(game);
+    if (input_key_pressed(&game->input, KEY_N) || input_key_pressed(&game->input, KEY_ENTER)) {
+        game_start_new(game);
         menu_close(&game->menu);
     }
-    if (IsKeyPressed(KEY_Q)) {
+    if (input_key_pressed(&game->input, KEY_Q)) {
         game->running = false;
     }
-    if (IsKeyPressed(KEY_R)) {
+    if (input_key_pressed(&game->input, KEY_R)) {
         open_ranking_screen(game);
     }
-    if (IsKeyPressed(KEY_T)) {
+    if (input_key_pressed(&game->input, KEY_T)) {
         return_to_title(game);
     }
 }
@@ -442,12 +910,12 @@ static void finalize_name_entry(GameState* game, bool commit) {
         const char* name = (game->nameEntryLen > 0) ? game->nameEntry : "PLAYER";
         ranking_insert(&game->ranking, name, game->pendingRankingScore);
         if (ranking_save(&game->ranking, RANKING_FILE_PATH)) {
-            set_hud_message(game, "Ranking atualizado!", HUD_MESSAGE_TIME);
+            show_hud_message(game, HUD_MSG_RANKING_SAVED, HUD_MESSAGE_TIME);
         } else {
-            set_hud_message(game, "Falha ao salvar ranking.", HUD_MESSAGE_TIME);
+            show_hud_message(game, HUD_MSG_RANKING_FAILED, HUD_MESSAGE_TIME);
         }
     } else {
-        set_hud_message(game, "Registro ignorado.", HUD_MESSAGE_TIME);
+        show_hud_message(game, HUD_MSG_ENTRY_SKIPPED, HUD_MESSAGE_TIME);
     }
     game->pendingRankingScore = 0;
     game->pendingRankingIndex = -1;
@@ -457,7 +925,7 @@ static void finalize_name_entry(GameState* game, bool commit) {
 }
 
 static void handle_name_entry(GameState* game) {
-    int key = GetCharPressed();
+    int key = input_char_pressed(&game->input);
     while (key > 0) {
         if (key >= 32 && key <= 126) {
             if (game->nameEntryLen < RANKING_NAME_LEN - 1) {
@@ -465,138 +933,284 @@ static void handle_name_entry(GameState* game) {
                 game->nameEntry[game->nameEntryLen] = '\0';
             }
         }
-        key = GetCharPressed();
+        key = input_char_pressed(&game->input);
     }
-    if ((IsKeyPressed(KEY_BACKSPACE) || IsKeyPressed(KEY_DELETE)) && game->nameEntryLen > 0) {
+    if ((input_key_pressed(&game->input, KEY_BACKSPACE) || input_key_pressed(&game->input, KEY_DELETE)) && game->nameEntryLen > 0) {
         game->nameEntryLen--;
         game->nameEntry[game->nameEntryLen] = '\0';
     }
-    if (IsKeyPressed(KEY_ENTER)) {
+    if (input_key_pressed(&game->input, KEY_ENTER)) {
         finalize_name_entry(game, true);
     }
-    if (IsKeyPressed(KEY_ESCAPE)) {
+    if (input_key_pressed(&game->input, KEY_ESCAPE)) {
         finalize_name_entry(game, false);
     }
 }
 
 static void handle_title_input(GameState* game) {
-    if (IsKeyPressed(KEY_N) || IsKeyPressed(KEY_ENTER)) {
-        start_new_game(game);
+    if (input_key_pressed(&game->input, KEY_N) || input_key_pressed(&game->input, KEY_ENTER)) {
+        game_start_new(game);
         return;
     }
-    if (IsKeyPressed(KEY_C)) {
+    if (input_key_pressed(&game->input, KEY_C)) {
         if (load_game(game, SAVE_FILE_PATH)) {
-            set_hud_message(game, "Jogo carregado.", HUD_MESSAGE_TIME);
+            show_hud_message(game, HUD_MSG_GAME_LOADED, HUD_MESSAGE_TIME);
             game->phase = GAME_PHASE_PLAYING;
         } else {
-            set_hud_message(game, "Nenhum save encontrado.", HUD_MESSAGE_TIME);
+            show_hud_message(game, HUD_MSG_NO_SAVE, HUD_MESSAGE_TIME);
         }
         return;
     }
-    if (IsKeyPressed(KEY_R)) {
+    if (input_key_pressed(&game->input, KEY_R)) {
         open_ranking_screen(game);
         return;
     }
-    if (IsKeyPressed(KEY_Q)) {
+    if (input_key_pressed(&game->input, KEY_Q)) {
         game->running = false;
     }
 }
 
 static void handle_ranking_input(GameState* game) {
-    if (IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_BACKSPACE) || IsKeyPressed(KEY_ENTER)) {
+    if (input_key_pressed(&game->input, KEY_ESCAPE) || input_key_pressed(&game->input, KEY_BACKSPACE) || input_key_pressed(&game->input, KEY_ENTER)) {
         return_to_title(game);
     }
-    if (IsKeyPressed(KEY_N)) {
-        start_new_game(game);
+    if (input_key_pressed(&game->input, KEY_N)) {
+        game_start_new(game);
     }
-    if (IsKeyPressed(KEY_Q)) {
+    if (input_key_pressed(&game->input, KEY_Q)) {
         game->running = false;
     }
 }
 
-bool game_load_level(GameState* game, const char* mapPath) {
-    map_free(&game->map);
-    if (!map_load(&game->map, mapPath)) return false;
-
-    game->pelletsRemaining = game->map.pelletsRemaining;
-    game->powerTimer = 0.0f;
-    snprintf(game->currentMapPath, sizeof(game->currentMapPath), "%s", mapPath);
-
-    game->pacman.pos = game->map.pacmanStart;
-    game->pacman.dir = DIR_NONE;
-    game->pacman.pendingDir = DIR_NONE;
-    game->pacman.powered = false;
-    game->pacman.powerTimeLeft = 0.0f;
-    game->pacman.moveTimer = 0.0f;
-
-    free(game->ghosts);
+static void spawn_ghosts(GameState* game) {
+    mem_free(game->ghosts);
     game->ghostCount = game->map.ghostCount;
     if (game->ghostCount > 0) {
-        game->ghosts = (Ghost*)malloc(sizeof(Ghost) * game->ghostCount);
+        game->ghosts = (Ghost*)mem_alloc(MEM_TAG_ENTITIES, sizeof(Ghost) * game->ghostCount);
         for (int i = 0; i < game->ghostCount; i++) {
             game->ghosts[i].pos = game->map.ghostStarts[i];
+            game->ghosts[i].prevPos = game->ghosts[i].pos;
             game->ghosts[i].dir = DIR_NONE;
-            game->ghosts[i].vulnerable = false;
-            game->ghosts[i].vulnerableTimeLeft = 0.0f;
+            game->ghosts[i].strategy = ghost_default_strategy(i);
             game->ghosts[i].alive = true;
             game->ghosts[i].moveTimer = 0.0f;
         }
     } else {
         game->ghosts = NULL;
     }
+}
+
+static void rebuild_map_indexes(GameState* game) {
+    path_service_reset(&game->paths, &game->map);
+    chunk_grid_reset(&game->chunks, &game->map, game->ghosts, game->ghostCount);
+    entity_store_reset(&game->entities, &game->map, game->ghosts, game->ghostCount,
+                       game->players, game->playerCount);
+    path_service_limit_depth(&game->paths, chunk_grid_path_depth(&game->chunks));
+}
 
+static void reset_level_state(GameState* game) {
+    game->pelletsRemaining = game->map.pelletsRemaining;
+    game->mapRevision = game_new_map_revision();
+
+    place_players(game);
+    game_set_power(game, false, 0.0f);
+    spawn_ghosts(game);
+    rebuild_map_indexes(game);
     game->phase = GAME_PHASE_PLAYING;
     game->paused = false;
-    return true;
+    game->hash = zobrist_hash(game);
+}
+
+bool game_load_level(GameState* game, const char* mapPath) {
+    double start = metrics_now();
+    trace_begin("game_load_level");
+    map_free(&game->map);
+    bool ok = map_load(&game->map, mapPath);
+    if (ok) {
+        snprintf(game->currentMapPath, sizeof(game->currentMapPath), "%s", mapPath);
+        reset_level_state(game);
+    }
+    trace_end("game_load_level");
+    if (ok) metrics_observe(METRIC_TIMER_LEVEL_LOAD, metrics_now() - start);
+    return ok;
+}
+
+void game_map_source(const GameState* game, char* out, size_t size) {
+    const char* path = game->currentMapPath;
+    size_t packLength = strlen(MAP_PACK_PATH);
+    if (strncmp(path, MAP_PACK_PATH, packLength) == 0 && path[packLength] == '#') {
+        snprintf(out, size, LEVEL_MAP_FORMAT, atoi(path + packLength + 1));
+    } else {
+        snprintf(out, size, "%s", path);
+    }
+}
+
+// Jogadores ficam onde estao se o tile continua livre; os fantasmas
+// renascem nos pontos do mapa novo, que pode ter outra quantidade deles.
+void game_swap_map(GameState* game, Map* map, const char* path) {
+    trace_begin("game_swap_map");
+    map_free(&game->map);
+    game->map = *map;
+    *map = (Map){0};
+    snprintf(game->currentMapPath, sizeof(game->currentMapPath), "%s", path);
+    game->pelletsRemaining = game->map.pelletsRemaining;
+    game->mapRevision = game_new_map_revision();
+
+    for (int i = 0; i < game->playerCount; i++) {
+        Pacman* player = &game->players[i];
+        if (!map_in_bounds(&game->map, player->pos.row, player->pos.col) ||
+            map_tile(&game->map, player->pos.row, player->pos.col) == '#') {
+            player->pos = game->map.pacmanStart;
+            stop_player(player);
+        }
+        player->prevPos = player->pos;
+    }
+    game_set_power(game, false, 0.0f);
+    spawn_ghosts(game);
+    rebuild_map_indexes(game);
+    game->hash = zobrist_hash(game);
+    show_hud_message(game, HUD_MSG_MAP_RELOADED, HUD_MESSAGE_TIME);
+    trace_end("game_swap_map");
+}
+
+uint32_t game_new_map_revision(void) {
+    return atomic_fetch_add_explicit(&nextMapRevision, 1, memory_order_relaxed);
+}
+
+void game_seed(GameState* game, uint32_t seed) {
+    game->rngState = seed ? seed : 0x9E3779B9u;
+}
+
+int game_random(GameState* game, int min, int max) {
+    uint32_t x = game->rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    game->rngState = x;
+    if (max <= min) return min;
+    return min + (int)(x % (uint32_t)(max - min + 1));
+}
+
+bool game_ghost_vulnerable(const GameState* game, const Ghost* ghost) {
+    return ghost->alive && game->powered;
+}
+
+float game_power_time_left(const GameState* game) {
+    return (float)timer_wheel_remaining(&game->timers, game->powerTimerId) * SIM_TICK_DT;
+}
+
+void game_set_players(GameState* game, int count, int humans) {
+    if (count < 1) count = 1;
+    if (count > GAME_MAX_PLAYERS) count = GAME_MAX_PLAYERS;
+    if (humans < 0) humans = 0;
+    if (humans > count) humans = count;
+    game->playerCount = count;
+    game->humanPlayers = humans;
+    reset_players(game);
+    place_players(game);
+    int ghostCount = game->ghosts ? game->ghostCount : 0;
+    chunk_grid_reset(&game->chunks, &game->map, game->ghosts, ghostCount);
+    entity_store_reset(&game->entities, &game->map, game->ghosts, ghostCount, game->players, game->playerCount);
+    path_service_limit_depth(&game->paths, chunk_grid_path_depth(&game->chunks));
+    game->hash = zobrist_hash(game);
+}
+
+void game_set_power(GameState* game, bool powered, float seconds) {
+    timer_wheel_cancel(&game->timers, game->powerTimerId);
+    game->powerTimerId = TIMER_NONE;
+    set_powered(game, powered);
+    if (powered) {
+        game->powerTimerId = timer_wheel_schedule(&game->timers, seconds_to_ticks(seconds),
+                                                  GAME_TIMER_POWER_END, 0);
+    }
 }
 
 bool game_init(GameState* game, const char* firstMapPath, int ghostCount) {
     (void)ghostCount;
     game->level = 1;
-    game->score = 0;
-    game->lives = PACMAN_START_LIVES;
+    memset(game->players, 0, sizeof(game->players));
+    game->playerCount = 1;
+    game->humanPlayers = 1;
+    reset_players(game);
     game->paused = true;
     game->running = true;
     game->menu.status = MENU_HIDDEN;
     game->menu.pendingAction = MENU_ACTION_NONE;
     game->menu.selectedIndex = 0;
+    input_clear(&game->input);
+    memset(&game->inputLatency, 0, sizeof(game->inputLatency));
     game->ghosts = NULL;
     game->ghostCount = 0;
+    path_service_init(&game->paths);
+    chunk_grid_init(&game->chunks);
+    entity_store_init(&game->entities);
     game->pelletsRemaining = 0;
-    game->powerTimer = 0.0f;
+    timer_wheel_init(&game->timers);
+    timer_wheel_init(&game->uiTimers);
+    game->timerAccumulator = 0.0f;
+    game->uiTimerAccumulator = 0.0f;
+    game->powerTimerId = TIMER_NONE;
+    game->hudTimerId = TIMER_NONE;
+    game->powered = false;
+    game->timeScale = 1.0f;
+    game->autopilot = false;
+    game_seed(game, (uint32_t)time(NULL));
     memset(game->currentMapPath, 0, sizeof(game->currentMapPath));
     game->phase = GAME_PHASE_TITLE;
     game->postPhase = GAME_PHASE_TITLE;
     game->hudMessage[0] = '\0';
-    game->hudMessageTimer = 0.0f;
     game->pendingRankingScore = 0;
     game->pendingRankingIndex = -1;
     game->nameEntryLen = 0;
     game->nameEntry[0] = '\0';
 
+    event_ring_init(&game->events);
+    game->asyncEvents = false;
     ranking_init(&game->ranking);
     ranking_load(&game->ranking, RANKING_FILE_PATH);
-    game->audioReady = false;
-    init_audio_assets(game);
+    audio_init(&game->audio);
 
     game->map = (Map){0};
+    game->mapPackReady = mappack_open(&game->mapPack, MAP_PACK_PATH);
     bool loaded = true;
     if (firstMapPath) {
-        loaded = game_load_level(game, firstMapPath);
+        // O pacote so substitui o nivel 1 padrao; outro caminho e carregado
+        // como pedido.
+        char defaultPath[64];
+        snprintf(defaultPath, sizeof(defaultPath), LEVEL_MAP_FORMAT, 1);
+        bool fromPack = strcmp(firstMapPath, defaultPath) == 0 && load_level_from_pack(game, 1, defaultPath);
+        loaded = fromPack || game_load_level(game, firstMapPath);
         game->phase = GAME_PHASE_TITLE;
         game->paused = true;
     }
+    game->hash = zobrist_hash(game);
     return loaded;
 }
 
 void game_shutdown(GameState* game) {
-    free(game->ghosts);
+    mem_free(game->ghosts);
     game->ghosts = NULL;
     map_free(&game->map);
-    unload_audio_assets(game);
+    path_service_free(&game->paths);
+    chunk_grid_free(&game->chunks);
+    entity_store_free(&game->entities);
+    if (game->mapPackReady) {
+        mappack_close(&game->mapPack);
+        game->mapPackReady = false;
+    }
+    audio_shutdown(&game->audio);
 }
 
-void game_update(GameState* game, float dt) {
+// Um atomic por contador e por tick, nao um por fantasma ou contato.
+static void flush_tick_metrics(GameState* game) {
+    metrics_add(METRIC_SIM_TICKS, 1);
+    if (game->tickGhostDecisions) metrics_add(METRIC_GHOST_DECISIONS, game->tickGhostDecisions);
+    if (game->tickCollisionChecks) metrics_add(METRIC_COLLISION_CHECKS, game->tickCollisionChecks);
+    game->tickGhostDecisions = 0;
+    game->tickCollisionChecks = 0;
+}
+
+static void update_tick(GameState* game, float dt) {
     update_hud_message(game, dt);
 
     switch (game->phase) {
@@ -618,7 +1232,7 @@ void game_update(GameState* game, float dt) {
             break;
     }
 
-    if (IsKeyPressed(KEY_TAB)) {
+    if (input_key_pressed(&game->input, KEY_TAB)) {
         if (game->menu.status == MENU_OPEN) {
             close_menu(game);
         } else {
@@ -632,89 +1246,184 @@ void game_update(GameState* game, float dt) {
         return;
     }
 
+    trace_begin("update_power_mode");
     update_power_mode(game, dt);
-    update_pacman(game, dt);
+    trace_end("update_power_mode");
+    trace_begin("update_players");
+    update_players(game, dt);
+    trace_end("update_players");
+    trace_begin("update_ghosts");
     update_ghosts(game, dt);
+    trace_end("update_ghosts");
+    trace_begin("handle_collisions");
     handle_collisions(game);
+    trace_end("handle_collisions");
+    trace_begin("check_level_transition");
     check_level_transition(game);
+    trace_end("check_level_transition");
+#ifdef GAME_HASH_CHECK
+    uint64_t expected = zobrist_hash(game);
+    if (expected != game->hash) {
+        fprintf(stderr, "hash divergente: %016llx != %016llx\n",
+                (unsigned long long)game->hash, (unsigned long long)expected);
+        game->hash = expected;
+    }
+#endif
 }
 
-void game_draw(const GameState* game) {
-    switch (game->phase) {
-        case GAME_PHASE_TITLE:
-            render_title_screen(game);
-            break;
-        case GAME_PHASE_RANKING:
-            render_ranking_screen(game);
-            break;
-        default:
-            render_game(game);
-            if (game->phase == GAME_PHASE_PLAYING) {
-                render_menu(game);
-            }
-            break;
+void game_update(GameState* game, float dt) {
+    trace_begin("game_update");
+    update_tick(game, dt);
+    if (!game->asyncEvents) {
+        trace_begin("game_consume_events");
+        game_consume_events(game);
+        trace_end("game_consume_events");
     }
+    flush_tick_metrics(game);
+    trace_end("game_update");
 }
-static Wave generate_tone_wave(float frequency, float duration, int sampleRate) {
-    int frameCount = (int)(duration * sampleRate);
-    if (frameCount <= 0) frameCount = sampleRate / 10;
-    short* data = (short*)malloc(sizeof(short) * frameCount);
-    if (!data) {
-        Wave empty = {0};
-        return empty;
-    }
-    const float amplitude = 0.4f;
-    for (int i = 0; i < frameCount; i++) {
-        float t = (float)i / (float)sampleRate;
-        float sample = sinf(2.0f * PI * frequency * t);
-        data[i] = (short)(amplitude * 32767.0f * sample);
+
+void game_clone_init(GameState* game) {
+    memset(game, 0, sizeof(*game));
+    path_service_init(&game->paths);
+    chunk_grid_init(&game->chunks);
+    entity_store_init(&game->entities);
+    timer_wheel_init(&game->timers);
+    timer_wheel_init(&game->uiTimers);
+    game->powerTimerId = TIMER_NONE;
+    game->hudTimerId = TIMER_NONE;
+    game->timeScale = 1.0f;
+    game->pendingRankingIndex = -1;
+    input_clear(&game->input);
+    event_ring_init(&game->events);
+    ranking_init(&game->ranking);
+}
+
+static bool copy_positions(Position** dst, const Position* src, int count, int oldCount) {
+    if (count != oldCount) {
+        mem_free(*dst);
+        *dst = count > 0 ? (Position*)mem_alloc(MEM_TAG_MAP, sizeof(Position) * count) : NULL;
+        if (count > 0 && !*dst) return false;
     }
-    Wave wave = {
-        .frameCount = (unsigned int)frameCount,
-        .sampleRate = (unsigned int)sampleRate,
-        .sampleSize = 16,
-        .channels = 1,
-        .data = data
-    };
-    return wave;
+    if (count > 0) memcpy(*dst, src, sizeof(Position) * count);
+    return true;
 }
 
-static Sound make_tone_sound(float frequency, float duration) {
-    Wave wave = generate_tone_wave(frequency, duration, DEFAULT_SAMPLE_RATE);
-    Sound sound = {0};
-    if (wave.data) {
-        sound = LoadSoundFromWave(wave);
-        UnloadWave(wave);
+static void relink_entities(GameState* game) {
+    for (int i = 0; i < game->ghostCount; i++) {
+        chunk_grid_move(&game->chunks, i, game->ghosts[i].pos);
+        entity_store_move_ghost(&game->entities, i, game->ghosts[i].pos);
+    }
+    for (int i = 0; i < GAME_MAX_PLAYERS; i++) {
+        const Pacman* player = &game->players[i];
+        entity_store_move_player(&game->entities, i, player->pos, i < game->playerCount && player->active);
     }
-    return sound;
 }
 
-static bool init_audio_assets(GameState* game) {
-    if (!IsAudioDeviceReady()) {
-        game->audioReady = false;
+bool game_clone(GameState* dst, const GameState* src) {
+    const Map* from = &src->map;
+    Map* to = &dst->map;
+    size_t gridSize = from->grid ? map_grid_size(from) : 0;
+    if (gridSize != (to->grid ? map_grid_size(to) : 0)) {
+        mem_free(to->grid);
+        to->grid = gridSize > 0 ? (char*)mem_alloc(MEM_TAG_MAP, gridSize) : NULL;
+        if (gridSize > 0 && !to->grid) return false;
+    }
+    if (gridSize > 0) memcpy(to->grid, from->grid, gridSize);
+    if (!copy_positions(&to->ghostStarts, from->ghostStarts, from->ghostStarts ? from->ghostCount : 0,
+                        to->ghostStarts ? to->ghostCount : 0) ||
+        !copy_positions(&to->portals, from->portals, from->portals ? from->portalCount : 0,
+                        to->portals ? to->portalCount : 0)) {
         return false;
     }
-    game->pelletSound = make_tone_sound(880.0f, 0.08f);
-    game->powerSound = make_tone_sound(523.0f, 0.25f);
-    game->ghostSound = make_tone_sound(660.0f, 0.3f);
-    game->loseLifeSound = make_tone_sound(200.0f, 0.4f);
-    game->winSound = make_tone_sound(440.0f, 0.5f);
-    game->audioReady = true;
+    to->rows = from->rows;
+    to->cols = from->cols;
+    to->stride = from->stride;
+    to->strideShift = from->strideShift;
+    to->pacmanStart = from->pacmanStart;
+    to->ghostCount = from->ghostCount;
+    to->portalCount = from->portalCount;
+    to->pelletsInitial = from->pelletsInitial;
+    to->pelletsRemaining = from->pelletsRemaining;
+
+    int ghostCount = src->ghosts ? src->ghostCount : 0;
+    int oldGhostCount = dst->ghosts ? dst->ghostCount : 0;
+    if (ghostCount != oldGhostCount) {
+        mem_free(dst->ghosts);
+        dst->ghosts = ghostCount > 0 ? (Ghost*)mem_alloc(MEM_TAG_ENTITIES, sizeof(Ghost) * ghostCount) : NULL;
+        if (ghostCount > 0 && !dst->ghosts) return false;
+    }
+    if (ghostCount > 0) memcpy(dst->ghosts, src->ghosts, sizeof(Ghost) * ghostCount);
+    dst->ghostCount = ghostCount;
+
+    // As rotas dependem so das paredes: o cache sobrevive enquanto o mapa
+    // de origem for o mesmo.
+    memcpy(dst->players, src->players, sizeof(dst->players));
+    for (int i = 0; i < src->playerCount; i++) dst->players[i].pendingTime = 0.0;
+    dst->playerCount = src->playerCount;
+    dst->humanPlayers = src->humanPlayers;
+    dst->activePlayers = src->activePlayers;
+    dst->powered = src->powered;
+
+    // Mesmo mapa e mesmos fantasmas (o caso de cada rollout do autopilot):
+    // os indices espaciais do destino so precisam mover quem mudou de lugar.
+    bool sameLayout = dst->mapRevision == src->mapRevision && ghostCount == oldGhostCount &&
+                      dst->chunks.head && dst->entities.tileHead;
+    if (sameLayout) {
+        relink_entities(dst);
+    } else {
+        if (dst->mapRevision != src->mapRevision) path_service_reset(&dst->paths, to);
+        chunk_grid_reset(&dst->chunks, to, dst->ghosts, ghostCount);
+        entity_store_reset(&dst->entities, to, dst->ghosts, ghostCount, dst->players, dst->playerCount);
+        path_service_limit_depth(&dst->paths, chunk_grid_path_depth(&dst->chunks));
+    }
+    dst->chunks.tick = src->chunks.tick;
+    dst->mapRevision = src->mapRevision;
+    dst->tileChangeCount = src->tileChangeCount;
+    memcpy(dst->tileChanges, src->tileChanges, sizeof(dst->tileChanges));
+
+    dst->pelletsRemaining = src->pelletsRemaining;
+    dst->level = src->level;
+    dst->score = src->score;
+    dst->lives = src->lives;
+    dst->hash = src->hash;
+    dst->timers = src->timers;
+    dst->timerAccumulator = src->timerAccumulator;
+    dst->powerTimerId = src->powerTimerId;
+    dst->rngState = src->rngState;
+    dst->paused = src->paused;
+    dst->running = src->running;
+    dst->phase = src->phase;
+    dst->postPhase = src->postPhase;
     return true;
 }
 
-static void unload_audio_assets(GameState* game) {
-    if (!game->audioReady) return;
-    UnloadSound(game->pelletSound);
-    UnloadSound(game->powerSound);
-    UnloadSound(game->ghostSound);
-    UnloadSound(game->loseLifeSound);
-    UnloadSound(game->winSound);
-    game->audioReady = false;
+void game_step_fast(GameState* game, float dt) {
+    if (game->phase != GAME_PHASE_PLAYING) return;
+    update_power_mode(game, dt);
+    update_players(game, dt);
+    update_ghosts(game, dt);
+    handle_collisions(game);
+    game_consume_events(game);
+    game->tickGhostDecisions = 0;
+    game->tickCollisionChecks = 0;
 }
 
-static void play_sound_safe(GameState* game, Sound sound) {
-    if (game->audioReady) {
-        PlaySound(sound);
+void game_draw(const GameState* game, const RenderCamera* camera, float alpha) {
+    trace_begin("game_draw");
+    switch (game->phase) {
+        case GAME_PHASE_TITLE:
+            render_title_screen(game);
+            break;
+        case GAME_PHASE_RANKING:
+            render_ranking_screen(game);
+            break;
+        default:
+            render_game(game, camera, alpha);
+            if (game->phase == GAME_PHASE_PLAYING) {
+                render_menu(game);
+            }
+            break;
     }
+    trace_end("game_draw");
 }
@@ -1,11 +1,20 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "raylib.h"
 #include "map.h"
+#include "mappack.h"
 #include "entity.h"
 #include "menu.h"
 #include "ranking.h"
+#include "audio.h"
+#include "events.h"
+#include "input.h"
+#include "pathfind.h"
+#include "chunks.h"
+#include "entities.h"
+#include "timerwheel.h"
 
 #define TILE_SIZE 40
 #define HUD_HEIGHT 40
@@ -18,8 +27,16 @@
 #define PACMAN_STEP_INTERVAL (1.0f / PACMAN_SPEED_BLOCKS_PER_SEC)
 #define GHOST_STEP_INTERVAL (1.0f / GHOST_SPEED_BLOCKS_PER_SEC)
 #define GHOST_STEP_INTERVAL_VULNERABLE (1.0f / GHOST_SPEED_VULNERABLE)
+#define SIM_TICK_RATE 60
+#define SIM_TICK_DT (1.0f / (float)SIM_TICK_RATE)
+#define SIM_TIME_SCALE_MIN 0.25f
+#define SIM_TIME_SCALE_MAX 64.0f
+#define ENTITY_MAX_STEPS_PER_UPDATE 4
 #define POWER_MODE_DURATION 8.0f
 #define HUD_MESSAGE_TIME 2.5f
+#define GHOST_AMBUSH_LOOKAHEAD 4
+#define GAME_TILE_LOG_SIZE 64
+#define GAME_MAX_PLAYERS ENTITY_MAX_PLAYERS
 
 typedef enum {
     GAME_PHASE_TITLE = 0,
@@ -32,22 +49,52 @@ typedef enum {
 
 typedef struct GameState {
     Map map;
-    Pacman pacman;
+    MapPack mapPack;
+    bool mapPackReady;
+    // players[0] e o jogador local (teclado ou autopilot); os humanPlayers
+    // primeiros leem o teclado e o resto anda sozinho (bot). score e lives
+    // do GameState sao os totais da partida, cada Pacman guarda os seus.
+    Pacman players[GAME_MAX_PLAYERS];
+    int playerCount;
+    int humanPlayers;
+    int activePlayers;
+    bool powered;
     Ghost* ghosts;
     int ghostCount;
+    PathService paths;
+    ChunkGrid chunks;
+    EntityStore entities;
     int pelletsRemaining;
+    // mapRevision identifica o mapa carregado (unico no processo, muda a
+    // cada troca de mapa); tileChanges guarda, em anel, os ultimos tiles
+    // alterados (tileChangeCount so cresce).
+    uint32_t mapRevision;
+    uint32_t tileChangeCount;
+    Position tileChanges[GAME_TILE_LOG_SIZE];
+    // Hash Zobrist (zobrist.h) mantido por deltas a cada mutacao; compilar
+    // com -DGAME_HASH_CHECK confere contra o recalculo completo a cada tick.
+    uint64_t hash;
     int level;
     int score;
     int lives;
-    float powerTimer;
+    TimerWheel timers;
+    TimerWheel uiTimers;
+    float timerAccumulator;
+    float uiTimerAccumulator;
+    int powerTimerId;
+    int hudTimerId;
+    float timeScale;
+    bool autopilot;
+    uint32_t rngState;
     bool paused;
     bool running;
     MenuState menu;
+    GameInput input;
+    InputLatencyHistogram inputLatency;
     char currentMapPath[128];
     GamePhase phase;
     GamePhase postPhase;
     char hudMessage[96];
-    float hudMessageTimer;
     Ranking ranking;
     bool rankingLoaded;
     bool rankingDirty;
@@ -55,16 +102,55 @@ typedef struct GameState {
     int pendingRankingIndex;
     char nameEntry[RANKING_NAME_LEN];
     int nameEntryLen;
-    bool audioReady;
-    Sound pelletSound;
-    Sound powerSound;
-    Sound ghostSound;
-    Sound loseLifeSound;
-    Sound winSound;
+    GameAudio audio;
+    // Com asyncEvents a fila e esvaziada fora de game_update (a thread da
+    // simulacao passa os eventos de cada tick para o snapshot com
+    // game_drain_events e a janela toca os sons com game_play_events); sem
+    // ele game_update a esvazia no fim de cada tick.
+    EventRing events;
+    bool asyncEvents;
+    // Contagem do tick corrente, somada em metrics.h no fim de game_update.
+    unsigned int tickGhostDecisions;
+    unsigned int tickCollisionChecks;
 } GameState;
 
 bool game_init(GameState* game, const char* firstMapPath, int ghostCount);
 void game_shutdown(GameState* game);
 bool game_load_level(GameState* game, const char* mapPath);
+// Arquivo texto de onde veio o nivel atual (para niveis do pacote, o
+// mapaN.txt correspondente). Vazio se nenhum mapa foi carregado.
+void game_map_source(const GameState* game, char* out, size_t size);
+// Troca o mapa em jogo mantendo score, vidas e nivel; assume a posse de
+// map. Chamar entre dois game_update.
+void game_swap_map(GameState* game, Map* map, const char* path);
 void game_update(GameState* game, float dt);
-void game_draw(const GameState* game);
+// Consumidor da fila de eventos: escreve o texto do HUD e toca os sons de
+// cada evento.
+void game_consume_events(GameState* game);
+// Consumo em duas etapas, para quando o audio e de outra thread: a
+// simulacao retira os eventos da fila para out (ja escrevendo o HUD; o que
+// nao couber e descartado e contado) e a dona do audio os toca depois.
+int game_drain_events(GameState* game, GameEvent* out, int capacity);
+void game_play_events(GameState* game, const GameEvent* events, int count);
+void game_start_new(GameState* game);
+void game_seed(GameState* game, uint32_t seed);
+int game_random(GameState* game, int min, int max);
+uint32_t game_new_map_revision(void);
+struct RenderCamera;
+void game_draw(const GameState* game, const struct RenderCamera* camera, float alpha);
+bool game_ghost_vulnerable(const GameState* game, const Ghost* ghost);
+float game_power_time_left(const GameState* game);
+void game_set_power(GameState* game, bool powered, float seconds);
+// Define quantos jogadores entram a partir do proximo jogo (1 a
+// GAME_MAX_PLAYERS, dos quais os humans primeiros usam o teclado: com dois,
+// o primeiro joga nas setas e o segundo em WASD).
+void game_set_players(GameState* game, int count, int humans);
+
+// Caminho rapido para busca/rollouts: game_clone_init prepara um estado
+// sem audio, ranking em disco nem pacote de mapas; game_clone copia so o
+// que a simulacao usa, reaproveitando os buffers do destino; game_step_fast
+// avanca a simulacao sem menu, HUD, audio nem troca de nivel (o chamador
+// trata pelletsRemaining == 0 como fim). Liberar com game_shutdown.
+void game_clone_init(GameState* game);
+bool game_clone(GameState* dst, const GameState* src);
+void game_step_fast(GameState* game, float dt);
@@ -0,0 +1,121 @@
+#include "hotreload.h"
+#include "memtrack.h"
+#include "trace.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+typedef struct {
+    bool exists;
+    long long mtime;
+    long long mtimeNs;
+    long long size;
+} FileStamp;
+
+static FileStamp file_stamp(const char* path) {
+    FileStamp stamp = {0};
+    struct stat info;
+    if (path[0] == '\0' || stat(path, &info) != 0) return stamp;
+    stamp.exists = true;
+    stamp.mtime = (long long)info.st_mtime;
+#ifdef __linux__
+    stamp.mtimeNs = (long long)info.st_mtim.tv_nsec;
+#endif
+    stamp.size = (long long)info.st_size;
+    return stamp;
+}
+
+static bool same_stamp(const FileStamp* a, const FileStamp* b) {
+    return a->exists == b->exists && a->mtime == b->mtime && a->mtimeNs == b->mtimeNs && a->size == b->size;
+}
+
+static void sleep_ms(int ms) {
+    struct timespec ts = {ms / 1000, (long)(ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+void map_reload_free(MapReload* reload) {
+    if (!reload) return;
+    map_free(&reload->map);
+    mem_free(reload);
+}
+
+// Um resultado que a simulacao ainda nao pegou e substituido: so a versao
+// mais nova do arquivo interessa.
+static void reload_map(MapWatcher* watcher, const char* path) {
+    MapReload* reload = (MapReload*)mem_calloc(MEM_TAG_MAP, 1, sizeof(MapReload));
+    if (!reload || !map_load(&reload->map, path)) {
+        mem_free(reload);
+        atomic_fetch_add_explicit(&watcher->failures, 1, memory_order_relaxed);
+        fprintf(stderr, "recarga: nao foi possivel ler %s\n", path);
+        return;
+    }
+    snprintf(reload->path, sizeof(reload->path), "%s", path);
+    map_reload_free(atomic_exchange_explicit(&watcher->ready, reload, memory_order_acq_rel));
+    atomic_fetch_add_explicit(&watcher->reloads, 1, memory_order_relaxed);
+}
+
+static void* watcher_main(void* arg) {
+    MapWatcher* watcher = (MapWatcher*)arg;
+    trace_thread_name("recarga");
+    char path[HOT_RELOAD_PATH_LEN] = "";
+    FileStamp stamp = {0};
+    bool pending = false;
+    while (atomic_load_explicit(&watcher->running, memory_order_acquire)) {
+        sleep_ms(HOT_RELOAD_POLL_MS);
+        char current[HOT_RELOAD_PATH_LEN];
+        pthread_mutex_lock(&watcher->lock);
+        memcpy(current, watcher->path, sizeof(current));
+        pthread_mutex_unlock(&watcher->lock);
+
+        FileStamp now = file_stamp(current);
+        if (strcmp(current, path) != 0) {
+            memcpy(path, current, sizeof(path));
+            stamp = now;
+            pending = false;
+        } else if (!same_stamp(&now, &stamp)) {
+            stamp = now;
+            pending = now.exists;
+        } else if (pending) {
+            pending = false;
+            reload_map(watcher, path);
+        }
+    }
+    return NULL;
+}
+
+bool map_watcher_start(MapWatcher* watcher) {
+    memset(watcher, 0, sizeof(*watcher));
+    atomic_init(&watcher->ready, NULL);
+    atomic_init(&watcher->running, true);
+    atomic_init(&watcher->reloads, 0);
+    atomic_init(&watcher->failures, 0);
+    if (pthread_mutex_init(&watcher->lock, NULL) != 0) return false;
+    if (pthread_create(&watcher->thread, NULL, watcher_main, watcher) != 0) {
+        pthread_mutex_destroy(&watcher->lock);
+        return false;
+    }
+    watcher->started = true;
+    return true;
+}
+
+void map_watcher_stop(MapWatcher* watcher) {
+    if (!watcher->started) return;
+    atomic_store_explicit(&watcher->running, false, memory_order_release);
+    pthread_join(watcher->thread, NULL);
+    pthread_mutex_destroy(&watcher->lock);
+    map_reload_free(atomic_exchange(&watcher->ready, NULL));
+    watcher->started = false;
+}
+
+void map_watcher_watch(MapWatcher* watcher, const char* path) {
+    pthread_mutex_lock(&watcher->lock);
+    snprintf(watcher->path, sizeof(watcher->path), "%s", path);
+    pthread_mutex_unlock(&watcher->lock);
+}
+
+MapReload* map_watcher_take(MapWatcher* watcher) {
+    if (!atomic_load_explicit(&watcher->ready, memory_order_relaxed)) return NULL;
+    return atomic_exchange_explicit(&watcher->ready, NULL, memory_order_acq_rel);
+}
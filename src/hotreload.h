@@ -0,0 +1,40 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "map.h"
+
+#define HOT_RELOAD_PATH_LEN 128
+#define HOT_RELOAD_POLL_MS 250
+
+typedef struct {
+    Map map;
+    char path[HOT_RELOAD_PATH_LEN];
+} MapReload;
+
+// Recarga de mapas em edicao. Uma thread consulta mtime e tamanho do
+// arquivo vigiado a cada HOT_RELOAD_POLL_MS (stat funciona igual no Linux
+// e no Windows) e, quando mudam e ficam estaveis por uma consulta (editores
+// costumam truncar e depois escrever), le o mapa de novo fora da
+// simulacao. O mapa pronto fica num ponteiro atomico ate a simulacao o
+// pegar entre dois ticks, entao game_update nunca ve meio mapa.
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    char path[HOT_RELOAD_PATH_LEN];
+    _Atomic(MapReload*) ready;
+    atomic_bool running;
+    atomic_ullong reloads;
+    atomic_ullong failures;
+    bool started;
+} MapWatcher;
+
+bool map_watcher_start(MapWatcher* watcher);
+void map_watcher_stop(MapWatcher* watcher);
+// Troca o arquivo vigiado; o estado atual dele vira a referencia, sem
+// recarga. Caminho vazio para de vigiar.
+void map_watcher_watch(MapWatcher* watcher, const char* path);
+// O chamador passa a ser dono do resultado (libere com map_reload_free).
+MapReload* map_watcher_take(MapWatcher* watcher);
+void map_reload_free(MapReload* reload);
@@ -0,0 +1,102 @@
+#include "input.h"
+#include "raylib.h"
+#include <string.h>
+#include <time.h>
+
+void input_clear(GameInput* input) {
+    memset(input, 0, sizeof(*input));
+}
+
+double input_timestamp(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void input_capture(GameInput* input) {
+    input_clear(input);
+    // Cada tecla leva o instante em que saiu da fila da Raylib, nao um
+    // carimbo unico para o quadro inteiro.
+    int key = GetKeyPressed();
+    while (key > 0) {
+        if (input->eventCount < INPUT_MAX_EVENTS) {
+            input->events[input->eventCount].key = key;
+            input->events[input->eventCount].time = input_timestamp();
+            input->eventCount++;
+        }
+        key = GetKeyPressed();
+    }
+    for (key = 0; key < INPUT_KEY_COUNT; key++) {
+        input->down[key] = IsKeyDown(key);
+        input->pressed[key] = IsKeyPressed(key);
+    }
+    int ch = GetCharPressed();
+    while (ch > 0) {
+        if (input->charCount < INPUT_MAX_CHARS) {
+            input->chars[input->charCount++] = ch;
+        }
+        ch = GetCharPressed();
+    }
+}
+
+void input_merge(GameInput* dst, const GameInput* src) {
+    for (int key = 0; key < INPUT_KEY_COUNT; key++) {
+        dst->down[key] = src->down[key];
+        dst->pressed[key] = dst->pressed[key] || src->pressed[key];
+    }
+    for (int i = src->charRead; i < src->charCount && dst->charCount < INPUT_MAX_CHARS; i++) {
+        dst->chars[dst->charCount++] = src->chars[i];
+    }
+    for (int i = src->eventRead; i < src->eventCount && dst->eventCount < INPUT_MAX_EVENTS; i++) {
+        dst->events[dst->eventCount++] = src->events[i];
+    }
+}
+
+bool input_key_down(const GameInput* input, int key) {
+    if (key < 0 || key >= INPUT_KEY_COUNT) return false;
+    return input->down[key];
+}
+
+bool input_key_pressed(const GameInput* input, int key) {
+    if (key < 0 || key >= INPUT_KEY_COUNT) return false;
+    return input->pressed[key];
+}
+
+int input_char_pressed(GameInput* input) {
+    if (input->charRead >= input->charCount) return 0;
+    return input->chars[input->charRead++];
+}
+
+void input_latency_record(InputLatencyHistogram* histogram, double seconds) {
+    double ms = seconds * 1000.0;
+    if (ms < 0.0) ms = 0.0;
+    int bucket = 0;
+    double limit = 1.0;
+    while (bucket < INPUT_LATENCY_BUCKETS - 1 && ms >= limit) {
+        bucket++;
+        limit *= 2.0;
+    }
+    histogram->buckets[bucket]++;
+    histogram->count++;
+    histogram->totalMs += ms;
+    if (ms > histogram->maxMs) histogram->maxMs = ms;
+}
+
+void input_latency_print(const InputLatencyHistogram* histogram, FILE* out) {
+    if (histogram->count == 0) return;
+    fprintf(out, "Latencia tecla -> passo: %u amostras, media %.2f ms, max %.2f ms\n",
+            histogram->count, histogram->totalMs / histogram->count, histogram->maxMs);
+    double low = 0.0;
+    double high = 1.0;
+    for (int i = 0; i < INPUT_LATENCY_BUCKETS; i++) {
+        if (histogram->buckets[i] > 0) {
+            if (i == INPUT_LATENCY_BUCKETS - 1) {
+                fprintf(out, "  >= %6.0f ms: %u\n", low, histogram->buckets[i]);
+            } else {
+                fprintf(out, "  %4.0f-%4.0f ms: %u\n", low, high, histogram->buckets[i]);
+            }
+        }
+        low = high;
+        high *= 2.0;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#define INPUT_KEY_COUNT 512
+#define INPUT_MAX_CHARS 32
+#define INPUT_MAX_EVENTS 32
+#define INPUT_LATENCY_BUCKETS 12
+
+typedef struct {
+    int key;
+    double time;
+} InputEvent;
+
+// Estado de teclado capturado pela thread principal (dona da janela)
+// e entregue a simulacao, que nao chama funcoes de input da Raylib.
+typedef struct {
+    bool down[INPUT_KEY_COUNT];
+    bool pressed[INPUT_KEY_COUNT];
+    int chars[INPUT_MAX_CHARS];
+    int charCount;
+    int charRead;
+    InputEvent events[INPUT_MAX_EVENTS];
+    int eventCount;
+    int eventRead;
+    double tickTime;
+} GameInput;
+
+// Histograma em potencias de 2 de milissegundos: [0,1), [1,2), [2,4), ...
+typedef struct {
+    unsigned int buckets[INPUT_LATENCY_BUCKETS];
+    unsigned int count;
+    double totalMs;
+    double maxMs;
+} InputLatencyHistogram;
+
+void input_clear(GameInput* input);
+void input_capture(GameInput* input);
+void input_merge(GameInput* dst, const GameInput* src);
+bool input_key_down(const GameInput* input, int key);
+bool input_key_pressed(const GameInput* input, int key);
+int input_char_pressed(GameInput* input);
+double input_timestamp(void);
+void input_latency_record(InputLatencyHistogram* histogram, double seconds);
+void input_latency_print(const InputLatencyHistogram* histogram, FILE* out);
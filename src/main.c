@@ -1,20 +1,175 @@
+#include "autopilot.h"
 #include "game.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "render.h"
+#include "simthread.h"
+#include "trace.h"
+#include "statestream.h"
 #include "raylib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-int main(void) {
+static float parse_float_arg(int argc, char** argv, const char* name, float fallback) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], name) == 0) {
+            return (float)atof(argv[i + 1]);
+        }
+    }
+    return fallback;
+}
+
+static bool has_flag(int argc, char** argv, const char* name) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+static const char* parse_string_arg(int argc, char** argv, const char* name) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return argv[i + 1];
+    }
+    return NULL;
+}
+
+// Espectador: reproduz um arquivo (ou FIFO) gravado com --record, um quadro
+// por tick de simulacao. No fim do arquivo fica no ultimo estado.
+static int watch_stream(const char* path) {
+    FILE* file = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "nao foi possivel abrir %s\n", path);
+        return 1;
+    }
+    GameState view;
+    game_clone_init(&view);
+    StreamDecoder decoder;
+    stream_decoder_init(&decoder);
+    RenderCamera camera;
+    render_camera_init(&camera);
+    uint8_t* buffer = NULL;
+    size_t capacity = 0;
+    size_t size = 0;
+    bool ended = false;
+    double accumulator = 0.0;
+
+    while (!WindowShouldClose()) {
+        accumulator += GetFrameTime();
+        while (!ended && accumulator >= SIM_TICK_DT) {
+            accumulator -= SIM_TICK_DT;
+            if (!stream_read_frame(file, &buffer, &capacity, &size)) {
+                ended = true;
+                break;
+            }
+            stream_decode(&decoder, &view, buffer, size);
+        }
+        if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) render_camera_zoom(&camera, 1.25f);
+        if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) render_camera_zoom(&camera, 0.8f);
+        if (IsKeyPressed(KEY_ZERO)) render_camera_init(&camera);
+
+        BeginDrawing();
+        ClearBackground(BLACK);
+        if (view.map.grid) game_draw(&view, &camera, 1.0f);
+        EndDrawing();
+    }
+
+    printf("espectador: %llu quadros, %llu recusados\n", decoder.frames, decoder.rejected);
+    free(buffer);
+    if (file != stdin) fclose(file);
+    game_shutdown(&view);
+    return 0;
+}
+
+// Chamado depois de parar a simulacao e o autopilot, que tambem gravam
+// eventos.
+static void stop_trace(bool tracing) {
+    if (!tracing) return;
+    unsigned long long written = 0;
+    unsigned long long dropped = 0;
+    if (trace_stop(&written, &dropped)) {
+        printf("trace: %llu eventos, %llu descartados\n", written, dropped);
+    } else {
+        fprintf(stderr, "falha ao gravar o trace\n");
+    }
+}
+
+int main(int argc, char** argv) {
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Pac-Man Prog II");
     InitAudioDevice();
     SetTargetFPS(60);
 
+    const char* tracePath = parse_string_arg(argc, argv, "--trace");
+    bool tracing = tracePath && trace_start(tracePath);
+    if (tracePath && !tracing) fprintf(stderr, "nao foi possivel gravar o trace em %s\n", tracePath);
+    trace_thread_name("janela");
+
+    const char* watchPath = parse_string_arg(argc, argv, "--watch");
+    if (watchPath) {
+        int status = watch_stream(watchPath);
+        stop_trace(tracing);
+        CloseAudioDevice();
+        CloseWindow();
+        return status;
+    }
+
     GameState game;
     if (!game_init(&game, "assets/maps/mapa1.txt", 4)) {
+        stop_trace(tracing);
         CloseAudioDevice();
         CloseWindow();
         return 1;
     }
 
-    while (!WindowShouldClose() && game.running) {
+    game_set_players(&game, (int)parse_float_arg(argc, argv, "--players", 1.0f),
+                     (int)parse_float_arg(argc, argv, "--humans", 1.0f));
+    // Os sons saem desta thread, nunca de dentro do tick da simulacao: os
+    // eventos chegam junto com cada snapshot.
+    game.asyncEvents = true;
+
+    Autopilot autopilot;
+    bool autopilotReady = autopilot_init(&autopilot, 0,
+        parse_float_arg(argc, argv, "--autopilot-ms", AUTOPILOT_DEFAULT_BUDGET_MS));
+    if (autopilotReady) autopilot_set_enabled(&autopilot, has_flag(argc, argv, "--autopilot"));
+
+    const char* recordPath = parse_string_arg(argc, argv, "--record");
+    FILE* record = recordPath ? fopen(recordPath, "wb") : NULL;
+    if (recordPath && !record) fprintf(stderr, "nao foi possivel gravar em %s\n", recordPath);
+
+    MapWatcher watcher = {0};
+    bool hotReload = has_flag(argc, argv, "--hot-reload");
+    if (hotReload && !map_watcher_start(&watcher)) {
+        fprintf(stderr, "nao foi possivel vigiar os mapas\n");
+        hotReload = false;
+    }
+
+    SimThread sim;
+    if (!sim_thread_start(&sim, &game, autopilotReady ? &autopilot : NULL, hotReload ? &watcher : NULL,
+                          record)) {
+        map_watcher_stop(&watcher);
+        if (record) fclose(record);
+        if (autopilotReady) autopilot_shutdown(&autopilot);
+        game_shutdown(&game);
+        stop_trace(tracing);
+        CloseAudioDevice();
+        CloseWindow();
+        return 1;
+    }
+    sim_thread_set_time_scale(&sim, parse_float_arg(argc, argv, "--speed", 1.0f));
+
+    const char* metricsAddress = parse_string_arg(argc, argv, "--metrics");
+    MetricsServer metricsServer = {0};
+    if (metricsAddress && !metrics_server_start(&metricsServer, metricsAddress)) {
+        fprintf(stderr, "nao foi possivel exportar metricas em %s\n", metricsAddress);
+    }
+
+    RenderCamera camera;
+    render_camera_init(&camera);
+
+    GameInput input;
+    bool showMemory = false;
+    while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_F)) {
             ToggleFullscreen();
             if (!IsWindowFullscreen()) {
@@ -22,16 +177,69 @@ int main(void) {
             }
         }
 
-        float dt = GetFrameTime();
-        game_update(&game, dt);
+        if (IsKeyPressed(KEY_PAGE_UP)) sim_thread_set_time_scale(&sim, sim_thread_time_scale(&sim) * 2.0f);
+        if (IsKeyPressed(KEY_PAGE_DOWN)) sim_thread_set_time_scale(&sim, sim_thread_time_scale(&sim) * 0.5f);
+        if (IsKeyPressed(KEY_HOME)) sim_thread_set_time_scale(&sim, 1.0f);
+        if (IsKeyPressed(KEY_F3)) showMemory = !showMemory;
+        if (IsKeyPressed(KEY_I) && autopilotReady) {
+            autopilot_set_enabled(&autopilot, !autopilot_enabled(&autopilot));
+        }
+
+        input_capture(&input);
+        sim_thread_post_input(&sim, &input);
+
+        float alpha = 0.0f;
+        const GameState* view = sim_thread_acquire(&sim, &alpha);
+        const GameEvent* events = NULL;
+        int eventCount = sim_thread_take_events(&sim, &events);
+        game_play_events(&game, events, eventCount);
+        if (!view->running) break;
+        if (view->phase != GAME_PHASE_ENTER_SCORE) {
+            if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) render_camera_zoom(&camera, 1.25f);
+            if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) render_camera_zoom(&camera, 0.8f);
+            if (IsKeyPressed(KEY_ZERO)) render_camera_init(&camera);
+        }
+        float wheel = GetMouseWheelMove();
+        if (wheel != 0.0f) render_camera_zoom(&camera, wheel > 0.0f ? 1.1f : 1.0f / 1.1f);
 
         BeginDrawing();
         ClearBackground(BLACK);
-        game_draw(&game);
+        game_draw(view, &camera, alpha);
+        if (showMemory) render_memory_overlay();
+        trace_begin("EndDrawing");
         EndDrawing();
+        trace_end("EndDrawing");
+        metrics_observe(METRIC_TIMER_FRAME, GetFrameTime());
     }
 
+    metrics_server_stop(&metricsServer);
+    sim_thread_stop(&sim);
+    map_watcher_stop(&watcher);
+    if (hotReload) {
+        printf("recarga de mapas: %llu recargas, %llu falhas\n", (unsigned long long)watcher.reloads,
+               (unsigned long long)watcher.failures);
+    }
+    if (record) {
+        printf("gravacao: %llu keyframes, %llu deltas, %llu bytes\n",
+               sim.stream.keyframes, sim.stream.deltas, sim.stream.bytes);
+        fclose(record);
+    }
+    input_latency_print(&game.inputLatency, stdout);
+    if (game.chunks.lodSteps > 0) {
+        printf("fantasmas: %llu updates com IA completa, %llu no modelo reduzido\n",
+               game.chunks.fullSteps, game.chunks.lodSteps);
+    }
+    if (autopilotReady) {
+        if (autopilot.decisions > 0) {
+            printf("autopilot: %llu decisoes, %llu iteracoes (%.0f por decisao)\n",
+                   autopilot.decisions, autopilot.iterations,
+                   (double)autopilot.iterations / (double)autopilot.decisions);
+        }
+        autopilot_shutdown(&autopilot);
+    }
     game_shutdown(&game);
+    mem_print(stdout);
+    stop_trace(tracing);
     CloseAudioDevice();
     CloseWindow();
     return 0;
@@ -1,36 +1,128 @@
 #include "map.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "trace.h"
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-static int idx(const Map* map, int row, int col) {
-    return row * map->cols + col;
-}
-
 bool map_in_bounds(const Map* map, int row, int col) {
     return row >= 0 && row < map->rows && col >= 0 && col < map->cols;
 }
 
 char map_get(const Map* map, int row, int col) {
     if (!map_in_bounds(map, row, col)) return ' ';
-    return map->cells[idx(map, row, col)];
+    return map_tile(map, row, col);
 }
 
 void map_set(Map* map, int row, int col, char value) {
     if (!map_in_bounds(map, row, col)) return;
-    map->cells[idx(map, row, col)] = value;
+    map->grid[map_index(map, row, col)] = value;
 }
 
-bool map_load(Map* map, const char* path) {
-    FILE* f = fopen(path, "r");
-    if (!f) return false;
-
-    map->rows = MAP_ROWS;
-    map->cols = MAP_COLS;
-    int total = map->rows * map->cols;
-    map->cells = (char*)malloc(total);
-    if (!map->cells) {
+bool map_alloc(Map* map, int rows, int cols) {
+    if (rows <= 0 || cols <= 0 || cols > INT_MAX / 4) return false;
+    int shift = 0;
+    while ((1 << shift) < cols + 2) shift++;
+    if ((size_t)rows + 2 > (size_t)INT_MAX >> shift) return false;
+    size_t size = (size_t)(rows + 2) << shift;
+    char* grid = (char*)mem_alloc(MEM_TAG_MAP, size);
+    if (!grid) return false;
+    memset(grid, '#', size);
+    map->rows = rows;
+    map->cols = cols;
+    map->stride = 1 << shift;
+    map->strideShift = shift;
+    map->grid = grid;
+    return true;
+}
+
+void map_read_tiles(const Map* map, size_t offset, char* out, size_t count) {
+    int row = (int)(offset / (size_t)map->cols);
+    int col = (int)(offset % (size_t)map->cols);
+    while (count > 0) {
+        size_t length = (size_t)(map->cols - col);
+        if (length > count) length = count;
+        memcpy(out, map_row(map, row) + col, length);
+        out += length;
+        count -= length;
+        row++;
+        col = 0;
+    }
+}
+
+void map_write_tiles(Map* map, size_t offset, const char* in, size_t count) {
+    int row = (int)(offset / (size_t)map->cols);
+    int col = (int)(offset % (size_t)map->cols);
+    while (count > 0) {
+        size_t length = (size_t)(map->cols - col);
+        if (length > count) length = count;
+        memcpy(map_row(map, row) + col, in, length);
+        in += length;
+        count -= length;
+        row++;
+        col = 0;
+    }
+}
+
+static char* read_text_file(const char* path, long* length) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size <= 0) {
         fclose(f);
+        return NULL;
+    }
+    char* text = (char*)mem_alloc(MEM_TAG_MAP, (size_t)size + 1);
+    if (!text) {
+        fclose(f);
+        return NULL;
+    }
+    bool ok = fread(text, 1, (size_t)size, f) == (size_t)size;
+    fclose(f);
+    if (!ok) {
+        mem_free(text);
+        return NULL;
+    }
+    text[size] = '\0';
+    *length = size;
+    return text;
+}
+
+static int line_length(const char* line, const char* end) {
+    const char* cursor = line;
+    while (cursor < end && *cursor != '\n') cursor++;
+    int length = (int)(cursor - line);
+    if (length > 0 && line[length - 1] == '\r') length--;
+    return length;
+}
+
+// Dimensoes vem do arquivo: linhas = numero de linhas, colunas = linha
+// mais longa (linhas curtas sao completadas com espaco).
+static bool parse_map_file(Map* map, const char* path) {
+    long size = 0;
+    char* text = read_text_file(path, &size);
+    if (!text) return false;
+    const char* end = text + size;
+
+    int rows = 0;
+    int cols = 0;
+    for (const char* line = text; line < end; rows++) {
+        int length = line_length(line, end);
+        if (length > cols) cols = length;
+        const char* next = memchr(line, '\n', (size_t)(end - line));
+        line = next ? next + 1 : end;
+    }
+    if (rows <= 0 || cols <= 0) {
+        mem_free(text);
+        return false;
+    }
+
+    if (!map_alloc(map, rows, cols)) {
+        mem_free(text);
         return false;
     }
 
@@ -41,12 +133,12 @@ bool map_load(Map* map, const char* path) {
     map->pelletsInitial = 0;
     map->pelletsRemaining = 0;
 
-    char line[128];
-    int r = 0;
-    while (r < map->rows && fgets(line, sizeof(line), f)) {
-        for (int c = 0; c < map->cols; c++) {
-            char ch = line[c];
-            map_set(map, r, c, ch);
+    const char* line = text;
+    for (int r = 0; r < rows; r++) {
+        int length = line_length(line, end);
+        for (int c = 0; c < cols; c++) {
+            char ch = c < length ? line[c] : ' ';
+            map_row(map, r)[c] = ch;
             if (ch == 'P') {
                 map->pacmanStart.row = r;
                 map->pacmanStart.col = c;
@@ -58,23 +150,23 @@ bool map_load(Map* map, const char* path) {
                 map->pelletsInitial++;
             }
         }
-        r++;
+        const char* next = memchr(line, '\n', (size_t)(end - line));
+        line = next ? next + 1 : end;
     }
-
-    fclose(f);
+    mem_free(text);
 
     if (map->ghostCount > 0) {
-        map->ghostStarts = (Position*)malloc(sizeof(Position) * map->ghostCount);
+        map->ghostStarts = (Position*)mem_alloc(MEM_TAG_MAP, sizeof(Position) * map->ghostCount);
     }
     if (map->portalCount > 0) {
-        map->portals = (Position*)malloc(sizeof(Position) * map->portalCount);
+        map->portals = (Position*)mem_alloc(MEM_TAG_MAP, sizeof(Position) * map->portalCount);
     }
 
     int g = 0;
     int p = 0;
     for (int row = 0; row < map->rows; row++) {
         for (int col = 0; col < map->cols; col++) {
-            char ch = map_get(map, row, col);
+            char ch = map_tile(map, row, col);
             if (ch == 'F' && map->ghostStarts) {
                 map->ghostStarts[g].row = row;
                 map->ghostStarts[g].col = col;
@@ -91,11 +183,20 @@ bool map_load(Map* map, const char* path) {
     return true;
 }
 
+bool map_load(Map* map, const char* path) {
+    double start = metrics_now();
+    trace_begin("map_load");
+    bool ok = parse_map_file(map, path);
+    trace_end("map_load");
+    if (ok) metrics_observe(METRIC_TIMER_MAP_PARSE, metrics_now() - start);
+    return ok;
+}
+
 void map_free(Map* map) {
-    free(map->cells);
-    free(map->ghostStarts);
-    free(map->portals);
-    map->cells = NULL;
+    mem_free(map->grid);
+    mem_free(map->ghostStarts);
+    mem_free(map->portals);
+    map->grid = NULL;
     map->ghostStarts = NULL;
     map->portals = NULL;
     map->ghostCount = 0;
@@ -104,4 +205,6 @@ void map_free(Map* map) {
     map->pelletsRemaining = 0;
     map->rows = 0;
     map->cols = 0;
+    map->stride = 0;
+    map->strideShift = 0;
 }
@@ -1,15 +1,22 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "entity.h"
 
 #define MAP_ROWS 20
 #define MAP_COLS 40
 
+// Os tiles ficam em grid com uma borda de paredes ('#') em volta e linhas
+// de stride bytes (potencia de dois >= cols + 2, o que sobra tambem e
+// parede). Assim qualquer tile a um passo de um tile valido pode ser lido
+// sem checar limites, e os vizinhos de um indice estao a +-1 e +-stride.
 typedef struct {
     int rows;
     int cols;
-    char* cells;          // rows * cols
+    int stride;
+    int strideShift;
+    char* grid;           // (rows + 2) * stride
     Position pacmanStart;
     int ghostCount;
     Position* ghostStarts;
@@ -20,7 +27,49 @@ typedef struct {
 } Map;
 
 bool map_load(Map* map, const char* path);
+// Aloca a grade (so a borda preenchida; os tiles comecam como parede).
+bool map_alloc(Map* map, int rows, int cols);
 void map_free(Map* map);
 char map_get(const Map* map, int row, int col);
 void map_set(Map* map, int row, int col, char value);
 bool map_in_bounds(const Map* map, int row, int col);
+// Copia tiles na ordem linha a linha sem padding (rows * cols), a partir do
+// tile numero offset. E o formato de saves, pacotes e da rede.
+void map_read_tiles(const Map* map, size_t offset, char* out, size_t count);
+void map_write_tiles(Map* map, size_t offset, const char* in, size_t count);
+
+// Acessos sem checagem para os lacos quentes: row em [-1, rows] e col em
+// [-1, cols].
+static inline int map_index(const Map* map, int row, int col) {
+    return ((row + 1) << map->strideShift) + col + 1;
+}
+
+static inline int map_index_row(const Map* map, int index) {
+    return (index >> map->strideShift) - 1;
+}
+
+static inline int map_index_col(const Map* map, int index) {
+    return (index & (map->stride - 1)) - 1;
+}
+
+static inline char map_tile(const Map* map, int row, int col) {
+    return map->grid[map_index(map, row, col)];
+}
+
+static inline char* map_row(const Map* map, int row) {
+    return map->grid + map_index(map, row, 0);
+}
+
+static inline int map_step(const Map* map, Direction dir) {
+    switch (dir) {
+        case DIR_UP: return -map->stride;
+        case DIR_DOWN: return map->stride;
+        case DIR_LEFT: return -1;
+        case DIR_RIGHT: return 1;
+        default: return 0;
+    }
+}
+
+static inline size_t map_grid_size(const Map* map) {
+    return (size_t)(map->rows + 2) << map->strideShift;
+}
@@ -0,0 +1,266 @@
+#include "mappack.h"
+#include "memtrack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+_Static_assert(sizeof(Position) == 8, "Position deve ter dois int32");
+_Static_assert(sizeof(MapBinHeader) == 40, "MapBinHeader com padding inesperado");
+_Static_assert(sizeof(MapPackHeader) == 16, "MapPackHeader com padding inesperado");
+
+static size_t align8(size_t value) {
+    return (value + 7u) & ~(size_t)7u;
+}
+
+size_t mapbin_size(const Map* map) {
+    size_t size = sizeof(MapBinHeader);
+    size += sizeof(Position) * (size_t)map->ghostCount;
+    size += sizeof(Position) * (size_t)map->portalCount;
+    size += (size_t)map->rows * (size_t)map->cols;
+    return align8(size);
+}
+
+size_t mapbin_encode(const Map* map, unsigned char* out, size_t capacity) {
+    size_t size = mapbin_size(map);
+    if (!out || capacity < size) return 0;
+    memset(out, 0, size);
+
+    MapBinHeader header = {
+        .magic = MAPBIN_MAGIC,
+        .version = MAPBIN_VERSION,
+        .rows = map->rows,
+        .cols = map->cols,
+        .pacmanStart = map->pacmanStart,
+        .ghostCount = map->ghostCount,
+        .portalCount = map->portalCount,
+        .pelletsInitial = map->pelletsInitial,
+        .reserved = 0
+    };
+    unsigned char* cursor = out;
+    memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+    if (map->ghostCount > 0) {
+        memcpy(cursor, map->ghostStarts, sizeof(Position) * map->ghostCount);
+        cursor += sizeof(Position) * map->ghostCount;
+    }
+    if (map->portalCount > 0) {
+        memcpy(cursor, map->portals, sizeof(Position) * map->portalCount);
+        cursor += sizeof(Position) * map->portalCount;
+    }
+    map_read_tiles(map, 0, (char*)cursor, (size_t)map->rows * (size_t)map->cols);
+    return size;
+}
+
+static bool positions_in_map(const Map* map, const Position* positions, int count) {
+    for (int i = 0; i < count; i++) {
+        if (!map_in_bounds(map, positions[i].row, positions[i].col)) return false;
+    }
+    return true;
+}
+
+// O acesso a grade nao confere limites (a borda de paredes cobre so um
+// passo), entao posicoes do pacote fora do mapa invalidam o nivel inteiro.
+// pelletsInitial vem pronto do mapc e nao e recontado na grade.
+bool mapbin_decode(Map* map, const unsigned char* data, size_t size) {
+    if (!data || size < sizeof(MapBinHeader)) return false;
+    MapBinHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != MAPBIN_MAGIC || header.version != MAPBIN_VERSION) return false;
+    if (header.rows <= 0 || header.cols <= 0 || header.ghostCount < 0 || header.portalCount < 0 ||
+        header.pelletsInitial < 0) {
+        return false;
+    }
+
+    size_t ghostBytes = sizeof(Position) * (size_t)header.ghostCount;
+    size_t portalBytes = sizeof(Position) * (size_t)header.portalCount;
+    size_t cellBytes = (size_t)header.rows * (size_t)header.cols;
+    if (sizeof(header) + ghostBytes + portalBytes + cellBytes > size) return false;
+    if ((size_t)header.pelletsInitial > cellBytes) return false;
+
+    Map loaded = {0};
+    bool allocated = map_alloc(&loaded, header.rows, header.cols);
+    loaded.pacmanStart = header.pacmanStart;
+    loaded.ghostCount = header.ghostCount;
+    loaded.portalCount = header.portalCount;
+    loaded.pelletsInitial = header.pelletsInitial;
+    loaded.pelletsRemaining = header.pelletsInitial;
+    if (header.ghostCount > 0) loaded.ghostStarts = (Position*)mem_alloc(MEM_TAG_MAP, ghostBytes);
+    if (header.portalCount > 0) loaded.portals = (Position*)mem_alloc(MEM_TAG_MAP, portalBytes);
+    if (!allocated || (ghostBytes && !loaded.ghostStarts) || (portalBytes && !loaded.portals)) {
+        map_free(&loaded);
+        return false;
+    }
+
+    const unsigned char* cursor = data + sizeof(header);
+    if (ghostBytes) memcpy(loaded.ghostStarts, cursor, ghostBytes);
+    cursor += ghostBytes;
+    if (portalBytes) memcpy(loaded.portals, cursor, portalBytes);
+    cursor += portalBytes;
+    map_write_tiles(&loaded, 0, (const char*)cursor, cellBytes);
+
+    if (!map_in_bounds(&loaded, loaded.pacmanStart.row, loaded.pacmanStart.col) ||
+        !positions_in_map(&loaded, loaded.ghostStarts, loaded.ghostCount) ||
+        !positions_in_map(&loaded, loaded.portals, loaded.portalCount)) {
+        map_free(&loaded);
+        return false;
+    }
+
+    *map = loaded;
+    return true;
+}
+
+static bool mappack_validate(MapPack* pack) {
+    if (pack->size < sizeof(MapPackHeader)) return false;
+    MapPackHeader header;
+    memcpy(&header, pack->data, sizeof(header));
+    if (header.magic != MAPPACK_MAGIC || header.version != MAPPACK_VERSION) return false;
+    if (header.levelCount == 0 || header.levelCount > MAPPACK_MAX_LEVELS) return false;
+    size_t indexEnd = sizeof(header) + sizeof(MapPackEntry) * header.levelCount;
+    if (indexEnd > pack->size) return false;
+
+    const MapPackEntry* entries = (const MapPackEntry*)(pack->data + sizeof(header));
+    for (uint32_t i = 0; i < header.levelCount; i++) {
+        if (entries[i].offset < indexEnd) return false;
+        if ((size_t)entries[i].offset + entries[i].size > pack->size) return false;
+    }
+    pack->levelCount = (int)header.levelCount;
+    return true;
+}
+
+#ifndef _WIN32
+static bool mappack_map_file(MapPack* pack, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    pack->data = (const unsigned char*)data;
+    pack->size = (size_t)st.st_size;
+    pack->mapped = true;
+    return true;
+}
+#endif
+
+static bool mappack_read_file(MapPack* pack, const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (length <= 0) {
+        fclose(f);
+        return false;
+    }
+    unsigned char* data = (unsigned char*)malloc((size_t)length);
+    if (!data) {
+        fclose(f);
+        return false;
+    }
+    bool ok = fread(data, 1, (size_t)length, f) == (size_t)length;
+    fclose(f);
+    if (!ok) {
+        free(data);
+        return false;
+    }
+    pack->data = data;
+    pack->size = (size_t)length;
+    pack->mapped = false;
+    return true;
+}
+
+bool mappack_open(MapPack* pack, const char* path) {
+    *pack = (MapPack){0};
+    bool opened = false;
+#ifndef _WIN32
+    opened = mappack_map_file(pack, path);
+#endif
+    if (!opened) opened = mappack_read_file(pack, path);
+    if (!opened) return false;
+    if (!mappack_validate(pack)) {
+        mappack_close(pack);
+        return false;
+    }
+    struct stat info;
+    if (stat(path, &info) == 0) pack->mtime = (long long)info.st_mtime;
+    return true;
+}
+
+bool mappack_is_stale(const MapPack* pack, const char* sourcePath) {
+    struct stat info;
+    if (stat(sourcePath, &info) != 0) return false;
+    return (long long)info.st_mtime > pack->mtime;
+}
+
+void mappack_close(MapPack* pack) {
+    if (pack->data) {
+#ifndef _WIN32
+        if (pack->mapped) {
+            munmap((void*)pack->data, pack->size);
+        } else {
+            free((void*)pack->data);
+        }
+#else
+        free((void*)pack->data);
+#endif
+    }
+    *pack = (MapPack){0};
+}
+
+bool mappack_load_level(const MapPack* pack, int level, Map* map) {
+    if (!pack->data || level < 1 || level > pack->levelCount) return false;
+    const MapPackEntry* entries = (const MapPackEntry*)(pack->data + sizeof(MapPackHeader));
+    const MapPackEntry* entry = &entries[level - 1];
+    return mapbin_decode(map, pack->data + entry->offset, entry->size);
+}
+
+bool mappack_write(const char* path, const Map* maps, int count) {
+    if (count <= 0 || count > MAPPACK_MAX_LEVELS) return false;
+
+    size_t indexEnd = align8(sizeof(MapPackHeader) + sizeof(MapPackEntry) * (size_t)count);
+    size_t total = indexEnd;
+    for (int i = 0; i < count; i++) {
+        total += mapbin_size(&maps[i]);
+    }
+
+    unsigned char* buffer = (unsigned char*)calloc(1, total);
+    if (!buffer) return false;
+
+    MapPackHeader header = {
+        .magic = MAPPACK_MAGIC,
+        .version = MAPPACK_VERSION,
+        .levelCount = (uint32_t)count,
+        .reserved = 0
+    };
+    memcpy(buffer, &header, sizeof(header));
+
+    MapPackEntry* entries = (MapPackEntry*)(buffer + sizeof(header));
+    size_t offset = indexEnd;
+    for (int i = 0; i < count; i++) {
+        size_t size = mapbin_encode(&maps[i], buffer + offset, total - offset);
+        entries[i].offset = (uint32_t)offset;
+        entries[i].size = (uint32_t)size;
+        offset += size;
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        free(buffer);
+        return false;
+    }
+    bool ok = fwrite(buffer, 1, total, f) == total;
+    ok = (fclose(f) == 0) && ok;
+    free(buffer);
+    return ok;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "map.h"
+
+#define MAPBIN_MAGIC 0x50414D50u   // "PMAP"
+#define MAPPACK_MAGIC 0x4B504D50u  // "PMPK"
+#define MAPBIN_VERSION 1u
+#define MAPPACK_VERSION 1u
+#define MAPPACK_MAX_LEVELS 256
+
+// Mapa compilado: cabecalho + ghostStarts + portals + cells (rows * cols).
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t rows;
+    int32_t cols;
+    Position pacmanStart;
+    int32_t ghostCount;
+    int32_t portalCount;
+    int32_t pelletsInitial;
+    int32_t reserved;
+} MapBinHeader;
+
+typedef struct {
+    uint32_t offset;
+    uint32_t size;
+} MapPackEntry;
+
+// Pacote: cabecalho + indice de levelCount entradas + blobs MapBin alinhados em 8 bytes.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t levelCount;
+    uint32_t reserved;
+} MapPackHeader;
+
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    int levelCount;
+    bool mapped;
+    long long mtime;
+} MapPack;
+
+size_t mapbin_size(const Map* map);
+size_t mapbin_encode(const Map* map, unsigned char* out, size_t capacity);
+bool mapbin_decode(Map* map, const unsigned char* data, size_t size);
+
+bool mappack_open(MapPack* pack, const char* path);
+void mappack_close(MapPack* pack);
+bool mappack_load_level(const MapPack* pack, int level, Map* map);
+// Verdadeiro se sourcePath foi salvo depois do pacote: o .txt editado vale
+// mais que um pacote que ninguem regenerou.
+bool mappack_is_stale(const MapPack* pack, const char* sourcePath);
+bool mappack_write(const char* path, const Map* maps, int count);
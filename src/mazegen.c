@@ -0,0 +1,354 @@
+#include "mazegen.h"
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// O labirinto e cavado numa grade de nos nas coordenadas impares; as
+// celulas pares entre dois nos sao as passagens. As regioes sao faixas de
+// MAZE_REGION_ROWS linhas de nos, cavadas em paralelo com geradores
+// independentes e depois costuradas pelas linhas de passagem entre elas.
+typedef struct {
+    const MazeParams* params;
+    char* cells;
+    unsigned char* protectedNodes;
+    int nodeRows;
+    int nodeCols;
+    int regionCount;
+} MazeJob;
+
+static const int kNodeRowStep[4] = {-1, 1, 0, 0};
+static const int kNodeColStep[4] = {0, 0, -1, 1};
+
+static uint32_t maze_random(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static uint32_t region_seed(uint32_t seed, int region, uint32_t salt) {
+    uint32_t x = seed ^ (0x9E3779B9u * (uint32_t)(region + 1)) ^ salt;
+    x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+    x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x ? x : 0x6D2B79F5u;
+}
+
+static bool chance(uint32_t* rng, float probability) {
+    return (float)(maze_random(rng) & 0xFFFFFF) < probability * (float)0x1000000;
+}
+
+static char* cell_at(const MazeJob* job, int row, int col) {
+    return &job->cells[(size_t)row * job->params->cols + col];
+}
+
+static char* node_cell(const MazeJob* job, int nodeRow, int nodeCol) {
+    return cell_at(job, nodeRow * 2 + 1, nodeCol * 2 + 1);
+}
+
+static char* passage_cell(const MazeJob* job, int nodeRow, int nodeCol, int dir) {
+    return cell_at(job, nodeRow * 2 + 1 + kNodeRowStep[dir], nodeCol * 2 + 1 + kNodeColStep[dir]);
+}
+
+static void region_bounds(const MazeJob* job, int region, int* first, int* last) {
+    *first = region * MAZE_REGION_ROWS;
+    *last = *first + MAZE_REGION_ROWS;
+    if (*last > job->nodeRows) *last = job->nodeRows;
+}
+
+static bool node_inside(const MazeJob* job, int first, int last, int nodeRow, int nodeCol) {
+    return nodeRow >= first && nodeRow < last && nodeCol >= 0 && nodeCol < job->nodeCols;
+}
+
+static int open_degree(const MazeJob* job, int nodeRow, int nodeCol) {
+    int degree = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        int row = nodeRow * 2 + 1 + kNodeRowStep[dir];
+        int col = nodeCol * 2 + 1 + kNodeColStep[dir];
+        if (row <= 0 || col <= 0 || row >= job->params->rows - 1 || col >= job->params->cols - 1) continue;
+        if (*cell_at(job, row, col) != '#') degree++;
+    }
+    return degree;
+}
+
+// Backtracker iterativo: labirinto perfeito cobrindo todos os nos da faixa.
+static void carve_region(MazeJob* job, int region, uint32_t* rng) {
+    int first;
+    int last;
+    region_bounds(job, region, &first, &last);
+    int count = (last - first) * job->nodeCols;
+    int* stack = (int*)malloc(sizeof(int) * (size_t)count);
+    if (!stack) return;
+
+    int size = 0;
+    int start = (int)(maze_random(rng) % (uint32_t)count);
+    stack[size++] = start;
+    *node_cell(job, first + start / job->nodeCols, start % job->nodeCols) = ' ';
+    while (size > 0) {
+        int node = stack[size - 1];
+        int nodeRow = first + node / job->nodeCols;
+        int nodeCol = node % job->nodeCols;
+        int options[4];
+        int optionCount = 0;
+        for (int dir = 0; dir < 4; dir++) {
+            int nr = nodeRow + kNodeRowStep[dir];
+            int nc = nodeCol + kNodeColStep[dir];
+            if (node_inside(job, first, last, nr, nc) && *node_cell(job, nr, nc) == '#') {
+                options[optionCount++] = dir;
+            }
+        }
+        if (optionCount == 0) {
+            size--;
+            continue;
+        }
+        int dir = options[maze_random(rng) % (uint32_t)optionCount];
+        int nr = nodeRow + kNodeRowStep[dir];
+        int nc = nodeCol + kNodeColStep[dir];
+        *passage_cell(job, nodeRow, nodeCol, dir) = ' ';
+        *node_cell(job, nr, nc) = ' ';
+        stack[size++] = (nr - first) * job->nodeCols + nc;
+    }
+    free(stack);
+}
+
+static int dead_end_exit(const MazeJob* job, int nodeRow, int nodeCol) {
+    for (int dir = 0; dir < 4; dir++) {
+        int nr = nodeRow + kNodeRowStep[dir];
+        int nc = nodeCol + kNodeColStep[dir];
+        if (nr < 0 || nc < 0 || nr >= job->nodeRows || nc >= job->nodeCols) continue;
+        if (*passage_cell(job, nodeRow, nodeCol, dir) != '#') return dir;
+    }
+    return -1;
+}
+
+// Poda de becos: remover um no de grau 1 nunca desconecta o resto. Nos
+// ligados a outra regiao ficam protegidos, porque o grau deles depende de
+// celulas que a outra faixa pode estar alterando.
+static void sparsify_region(MazeJob* job, int region, uint32_t* rng) {
+    int first;
+    int last;
+    region_bounds(job, region, &first, &last);
+    float removal = 1.0f - job->params->density;
+    if (removal <= 0.0f) return;
+    int passes = (int)(removal * 16.0f) + 1;
+    for (int pass = 0; pass < passes; pass++) {
+        for (int nodeRow = first; nodeRow < last; nodeRow++) {
+            for (int nodeCol = 0; nodeCol < job->nodeCols; nodeCol++) {
+                if (job->protectedNodes[(size_t)nodeRow * job->nodeCols + nodeCol]) continue;
+                if (*node_cell(job, nodeRow, nodeCol) == '#') continue;
+                if (open_degree(job, nodeRow, nodeCol) != 1) continue;
+                if (!chance(rng, removal)) continue;
+                int dir = dead_end_exit(job, nodeRow, nodeCol);
+                if (dir < 0) continue;
+                int nr = nodeRow + kNodeRowStep[dir];
+                if (nr < first || nr >= last) continue;
+                *passage_cell(job, nodeRow, nodeCol, dir) = '#';
+                *node_cell(job, nodeRow, nodeCol) = '#';
+            }
+        }
+    }
+}
+
+// Braid: liga becos restantes a um vizinho aberto da mesma faixa.
+static void braid_region(MazeJob* job, int region, uint32_t* rng) {
+    int first;
+    int last;
+    region_bounds(job, region, &first, &last);
+    for (int nodeRow = first; nodeRow < last; nodeRow++) {
+        for (int nodeCol = 0; nodeCol < job->nodeCols; nodeCol++) {
+            if (*node_cell(job, nodeRow, nodeCol) == '#') continue;
+            if (open_degree(job, nodeRow, nodeCol) != 1) continue;
+            if (!chance(rng, job->params->loops)) continue;
+            int options[4];
+            int optionCount = 0;
+            for (int dir = 0; dir < 4; dir++) {
+                int nr = nodeRow + kNodeRowStep[dir];
+                int nc = nodeCol + kNodeColStep[dir];
+                if (!node_inside(job, first, last, nr, nc)) continue;
+                if (*node_cell(job, nr, nc) == '#') continue;
+                if (*passage_cell(job, nodeRow, nodeCol, dir) != '#') continue;
+                options[optionCount++] = dir;
+            }
+            if (optionCount == 0) continue;
+            int dir = options[maze_random(rng) % (uint32_t)optionCount];
+            *passage_cell(job, nodeRow, nodeCol, dir) = ' ';
+        }
+    }
+}
+
+static void carve_task(void* ctx, int region) {
+    MazeJob* job = (MazeJob*)ctx;
+    uint32_t rng = region_seed(job->params->seed, region, 0xC0FFEEu);
+    carve_region(job, region, &rng);
+}
+
+static void shape_task(void* ctx, int region) {
+    MazeJob* job = (MazeJob*)ctx;
+    uint32_t rng = region_seed(job->params->seed, region, 0xBADA55u);
+    sparsify_region(job, region, &rng);
+    braid_region(job, region, &rng);
+}
+
+static void protect(MazeJob* job, int nodeRow, int nodeCol) {
+    job->protectedNodes[(size_t)nodeRow * job->nodeCols + nodeCol] = 1;
+}
+
+static void stitch_regions(MazeJob* job, uint32_t* rng) {
+    for (int region = 1; region < job->regionCount; region++) {
+        int nodeRow = region * MAZE_REGION_ROWS - 1;
+        int forced = (int)(maze_random(rng) % (uint32_t)job->nodeCols);
+        for (int nodeCol = 0; nodeCol < job->nodeCols; nodeCol++) {
+            if (nodeCol != forced && !chance(rng, job->params->loops * 0.25f)) continue;
+            *passage_cell(job, nodeRow, nodeCol, 1) = ' ';
+            protect(job, nodeRow, nodeCol);
+            protect(job, nodeRow + 1, nodeCol);
+        }
+    }
+}
+
+// Escolhe um no aberto com valor minimo de score (distancia ao alvo com
+// desempate aleatorio) que ainda seja corredor vazio.
+static bool pick_open_near(MazeJob* job, int row, int col, uint32_t* rng, int* outRow, int* outCol) {
+    long best = -1;
+    int bestRow = 0;
+    int bestCol = 0;
+    for (int nodeRow = 0; nodeRow < job->nodeRows; nodeRow++) {
+        for (int nodeCol = 0; nodeCol < job->nodeCols; nodeCol++) {
+            int r = nodeRow * 2 + 1;
+            int c = nodeCol * 2 + 1;
+            if (*cell_at(job, r, c) != '.') continue;
+            long dist = (long)abs(r - row) + abs(c - col);
+            long score = dist * 8 + (long)(maze_random(rng) % 8);
+            if (best < 0 || score < best) {
+                best = score;
+                bestRow = r;
+                bestCol = c;
+            }
+        }
+    }
+    if (best < 0) return false;
+    *outRow = bestRow;
+    *outCol = bestCol;
+    return true;
+}
+
+static void place_portals(MazeJob* job, uint32_t* rng) {
+    int cols = job->params->cols;
+    int pairs = job->params->portalPairs;
+    if (pairs <= 0 || job->nodeRows <= 0) return;
+    for (int i = 0; i < pairs; i++) {
+        int nodeRow = (int)((long)job->nodeRows * (2 * i + 1) / (2 * pairs));
+        nodeRow += (int)(maze_random(rng) % 3) - 1;
+        if (nodeRow < 0) nodeRow = 0;
+        if (nodeRow >= job->nodeRows) nodeRow = job->nodeRows - 1;
+        int row = nodeRow * 2 + 1;
+        if (*cell_at(job, row, 0) == 'T') continue;
+        // Cava da borda ate o primeiro corredor aberto de cada lado.
+        for (int col = 1; col < cols - 1; col++) {
+            char* cell = cell_at(job, row, col);
+            if (*cell != '#') break;
+            *cell = '.';
+        }
+        for (int col = cols - 2; col >= 1; col--) {
+            char* cell = cell_at(job, row, col);
+            if (*cell != '#') break;
+            *cell = '.';
+        }
+        *cell_at(job, row, 0) = 'T';
+        *cell_at(job, row, cols - 1) = 'T';
+    }
+}
+
+static void place_items(MazeJob* job, uint32_t* rng) {
+    const MazeParams* params = job->params;
+    size_t total = (size_t)params->rows * params->cols;
+    for (size_t i = 0; i < total; i++) {
+        if (job->cells[i] == ' ') job->cells[i] = '.';
+    }
+    place_portals(job, rng);
+
+    int row;
+    int col;
+    int centerRow = params->rows / 2;
+    int centerCol = params->cols / 2;
+    for (int i = 0; i < params->ghostCount; i++) {
+        if (!pick_open_near(job, centerRow, centerCol, rng, &row, &col)) break;
+        *cell_at(job, row, col) = 'F';
+    }
+    if (pick_open_near(job, params->rows * 3 / 4, centerCol, rng, &row, &col)) {
+        *cell_at(job, row, col) = 'P';
+    }
+
+    // Power pellets espalhados: o alvo de cada um percorre uma grade
+    // aproximadamente quadrada sobre o mapa.
+    int count = params->powerPellets;
+    if (count <= 0) return;
+    int gridCols = 1;
+    while (gridCols * gridCols < count) gridCols++;
+    int gridRows = (count + gridCols - 1) / gridCols;
+    for (int i = 0; i < count; i++) {
+        int targetRow = (int)((long)params->rows * (2 * (i / gridCols) + 1) / (2 * gridRows));
+        int targetCol = (int)((long)params->cols * (2 * (i % gridCols) + 1) / (2 * gridCols));
+        if (!pick_open_near(job, targetRow, targetCol, rng, &row, &col)) break;
+        *cell_at(job, row, col) = 'o';
+    }
+}
+
+void maze_default_params(MazeParams* params, int rows, int cols, uint32_t seed) {
+    params->rows = rows;
+    params->cols = cols;
+    params->seed = seed;
+    params->density = 0.85f;
+    params->loops = 0.6f;
+    params->portalPairs = 1;
+    params->ghostCount = 4;
+    params->powerPellets = 4;
+    params->threads = 0;
+}
+
+bool maze_generate(const MazeParams* params, char* cells) {
+    if (params->rows < MAZE_MIN_ROWS || params->cols < MAZE_MIN_COLS) return false;
+    MazeJob job = {0};
+    job.params = params;
+    job.cells = cells;
+    job.nodeRows = (params->rows - 1) / 2;
+    job.nodeCols = (params->cols - 1) / 2;
+    job.regionCount = (job.nodeRows + MAZE_REGION_ROWS - 1) / MAZE_REGION_ROWS;
+    job.protectedNodes = (unsigned char*)calloc((size_t)job.nodeRows * job.nodeCols, 1);
+    if (!job.protectedNodes) return false;
+    memset(cells, '#', (size_t)params->rows * params->cols);
+
+    int threads = params->threads > 0 ? params->threads : thread_pool_cpu_count();
+    if (threads > job.regionCount) threads = job.regionCount;
+    ThreadPool pool;
+    if (!thread_pool_init(&pool, threads - 1)) {
+        thread_pool_destroy(&pool);
+        free(job.protectedNodes);
+        return false;
+    }
+
+    uint32_t rng = region_seed(params->seed, -1, 0x5EEDu);
+    thread_pool_for(&pool, job.regionCount, carve_task, &job);
+    stitch_regions(&job, &rng);
+    thread_pool_for(&pool, job.regionCount, shape_task, &job);
+    place_items(&job, &rng);
+
+    thread_pool_destroy(&pool);
+    free(job.protectedNodes);
+    return true;
+}
+
+bool maze_write(const char* path, const char* cells, int rows, int cols) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    bool ok = true;
+    for (int row = 0; row < rows && ok; row++) {
+        ok = fwrite(cells + (size_t)row * cols, 1, (size_t)cols, f) == (size_t)cols &&
+             fputc('\n', f) != EOF;
+    }
+    ok = (fclose(f) == 0) && ok;
+    return ok;
+}
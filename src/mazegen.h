@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MAZE_MIN_ROWS 7
+#define MAZE_MIN_COLS 7
+#define MAZE_REGION_ROWS 32
+
+// Parametros do gerador. density (0..1) controla quanto dos corredores do
+// labirinto perfeito sobrevive a poda de becos; loops (0..1) e a chance de
+// cada beco restante ser ligado a um vizinho e de abrir passagens extras
+// entre regioes. O resultado depende so dos parametros, nunca de threads.
+typedef struct {
+    int rows;
+    int cols;
+    uint32_t seed;
+    float density;
+    float loops;
+    int portalPairs;
+    int ghostCount;
+    int powerPellets;
+    int threads;
+} MazeParams;
+
+void maze_default_params(MazeParams* params, int rows, int cols, uint32_t seed);
+// cells recebe rows * cols caracteres no formato dos mapas (#.oPFT e espaco).
+bool maze_generate(const MazeParams* params, char* cells);
+bool maze_write(const char* path, const char* cells, int rows, int cols);
@@ -0,0 +1,126 @@
+#include "memtrack.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef union {
+    struct {
+        size_t size;
+        int tag;
+    } info;
+    max_align_t align;
+} MemHeader;
+
+typedef struct {
+    atomic_ullong current;
+    atomic_ullong peak;
+    atomic_ullong blocks;
+    atomic_ullong allocations;
+} MemCounters;
+
+static MemCounters tagCounters[MEM_TAG_COUNT];
+static MemCounters totalCounters;
+
+static const char* kTagNames[MEM_TAG_COUNT] = {
+    "mapa", "entidades", "rotas", "audio", "autopilot", "ambiente"
+};
+
+static void raise_peak(MemCounters* counters, unsigned long long current) {
+    unsigned long long peak = atomic_load_explicit(&counters->peak, memory_order_relaxed);
+    while (current > peak &&
+           !atomic_compare_exchange_weak_explicit(&counters->peak, &peak, current, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+static void count_alloc(MemCounters* counters, size_t size) {
+    unsigned long long current =
+        atomic_fetch_add_explicit(&counters->current, size, memory_order_relaxed) + size;
+    raise_peak(counters, current);
+    atomic_fetch_add_explicit(&counters->blocks, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->allocations, 1, memory_order_relaxed);
+}
+
+static void count_free(MemCounters* counters, size_t size) {
+    atomic_fetch_sub_explicit(&counters->current, size, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&counters->blocks, 1, memory_order_relaxed);
+}
+
+static void* track(MemHeader* header, MemTag tag, size_t size) {
+    header->info.size = size;
+    header->info.tag = (int)tag;
+    count_alloc(&tagCounters[tag], size);
+    count_alloc(&totalCounters, size);
+    return header + 1;
+}
+
+static void untrack(const MemHeader* header) {
+    count_free(&tagCounters[header->info.tag], header->info.size);
+    count_free(&totalCounters, header->info.size);
+}
+
+void* mem_alloc(MemTag tag, size_t size) {
+    if (size > SIZE_MAX - sizeof(MemHeader)) return NULL;
+    MemHeader* header = (MemHeader*)malloc(sizeof(MemHeader) + size);
+    return header ? track(header, tag, size) : NULL;
+}
+
+void* mem_calloc(MemTag tag, size_t count, size_t size) {
+    if (size != 0 && count > (SIZE_MAX - sizeof(MemHeader)) / size) return NULL;
+    void* ptr = mem_alloc(tag, count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+// A contagem so muda depois que o realloc deu certo: em caso de falha o
+// bloco antigo continua valido e contado.
+void* mem_realloc(MemTag tag, void* ptr, size_t size) {
+    if (!ptr) return mem_alloc(tag, size);
+    if (size > SIZE_MAX - sizeof(MemHeader)) return NULL;
+    MemHeader* old = (MemHeader*)ptr - 1;
+    MemHeader saved = *old;
+    MemHeader* header = (MemHeader*)realloc(old, sizeof(MemHeader) + size);
+    if (!header) return NULL;
+    untrack(&saved);
+    return track(header, (MemTag)saved.info.tag, size);
+}
+
+void mem_free(void* ptr) {
+    if (!ptr) return;
+    MemHeader* header = (MemHeader*)ptr - 1;
+    untrack(header);
+    free(header);
+}
+
+const char* mem_tag_name(MemTag tag) {
+    return tag >= 0 && tag < MEM_TAG_COUNT ? kTagNames[tag] : "?";
+}
+
+static void load_stats(MemCounters* counters, MemStats* out) {
+    out->current = atomic_load_explicit(&counters->current, memory_order_relaxed);
+    out->peak = atomic_load_explicit(&counters->peak, memory_order_relaxed);
+    out->blocks = atomic_load_explicit(&counters->blocks, memory_order_relaxed);
+    out->allocations = atomic_load_explicit(&counters->allocations, memory_order_relaxed);
+}
+
+void mem_stats(MemTag tag, MemStats* out) {
+    load_stats(&tagCounters[tag], out);
+}
+
+void mem_total(MemStats* out) {
+    load_stats(&totalCounters, out);
+}
+
+void mem_print(FILE* out) {
+    fprintf(out, "memoria: %-10s %12s %12s %8s %10s\n", "tag", "atual", "pico", "blocos", "alocacoes");
+    MemStats stats;
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        mem_stats((MemTag)i, &stats);
+        fprintf(out, "memoria: %-10s %12llu %12llu %8llu %10llu\n", kTagNames[i], stats.current, stats.peak,
+                stats.blocks, stats.allocations);
+    }
+    mem_total(&stats);
+    fprintf(out, "memoria: %-10s %12llu %12llu %8llu %10llu\n", "total", stats.current, stats.peak,
+            stats.blocks, stats.allocations);
+}
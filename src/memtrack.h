@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+// Save e ranking nao tem tag: o ranking e uma tabela fixa e o save le e
+// grava direto da grade do mapa, sem alocar nada.
+typedef enum {
+    MEM_TAG_MAP = 0,
+    MEM_TAG_ENTITIES,
+    MEM_TAG_PATHS,
+    MEM_TAG_AUDIO,
+    MEM_TAG_AUTOPILOT,
+    MEM_TAG_ENV,
+    MEM_TAG_COUNT
+} MemTag;
+
+typedef struct {
+    unsigned long long current;      // bytes vivos
+    unsigned long long peak;
+    unsigned long long blocks;       // blocos vivos
+    unsigned long long allocations;  // total de alocacoes desde o inicio
+} MemStats;
+
+// Alocador com contabilidade por subsistema. Cada bloco leva um cabecalho
+// com tamanho e tag, entao mem_free nao precisa da tag e um bloco de
+// mem_alloc nunca pode ir para free (nem o contrario). Os contadores sao
+// do processo inteiro, com atomics relaxed, como em metrics.h.
+void* mem_alloc(MemTag tag, size_t size);
+void* mem_calloc(MemTag tag, size_t count, size_t size);
+// Com ptr != NULL o bloco mantem a tag com que foi criado.
+void* mem_realloc(MemTag tag, void* ptr, size_t size);
+void mem_free(void* ptr);
+
+const char* mem_tag_name(MemTag tag);
+void mem_stats(MemTag tag, MemStats* out);
+// Soma de todas as tags; o pico e o do total, nao a soma dos picos.
+void mem_total(MemStats* out);
+void mem_print(FILE* out);
@@ -0,0 +1,290 @@
+#include "metrics.h"
+#include "memtrack.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET MetricsHandle;
+#define METRICS_INVALID INVALID_SOCKET
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+typedef int MetricsHandle;
+#define METRICS_INVALID -1
+#endif
+
+#define METRICS_BODY_SIZE 8192
+#define METRICS_REQUEST_SIZE 2048
+
+MetricsRegistry metrics;
+
+typedef struct {
+    const char* family;
+    const char* labels;
+    const char* help;
+} MetricInfo;
+
+static const MetricInfo kCounters[METRIC_COUNTER_COUNT] = {
+    {"pacman_sim_ticks_total", "", "Passos fixos de simulacao executados."},
+    {"pacman_ghost_decisions_total", "", "Escolhas de direcao feitas pelos fantasmas."},
+    {"pacman_collision_checks_total", "", "Testes de contato entre jogador e fantasma."},
+    {"pacman_audio_events_dropped_total", "{queue=\"events\"}",
+     "Eventos de som perdidos por fila cheia."},
+    {"pacman_audio_events_dropped_total", "{queue=\"synth\"}",
+     "Eventos de som perdidos por fila cheia."}
+};
+
+static const MetricInfo kTimers[METRIC_TIMER_COUNT] = {
+    {"pacman_frame", "", "Tempo de quadro da janela."},
+    {"pacman_level_load", "", "Carga de nivel (mapa, rotas e blocos)."},
+    {"pacman_map_parse", "", "Leitura de mapa em texto."},
+    {"pacman_save", "", "Gravacao do save."}
+};
+
+double metrics_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void metrics_observe(MetricTimer timer, double seconds) {
+    unsigned long long micros = seconds > 0.0 ? (unsigned long long)(seconds * 1e6 + 0.5) : 0;
+    atomic_fetch_add_explicit(&metrics.timerCount[timer], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&metrics.timerMicros[timer], micros, memory_order_relaxed);
+    atomic_store_explicit(&metrics.timerLastMicros[timer], micros, memory_order_relaxed);
+}
+
+static unsigned long long load(atomic_ullong* value) {
+    return atomic_load_explicit(value, memory_order_relaxed);
+}
+
+typedef struct {
+    char* out;
+    size_t capacity;
+    size_t length;
+} Text;
+
+static void append(Text* text, const char* format, ...) {
+    if (text->length + 1 >= text->capacity) return;
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(text->out + text->length, text->capacity - text->length, format, args);
+    va_end(args);
+    if (written < 0) return;
+    text->length += (size_t)written;
+    if (text->length >= text->capacity) text->length = text->capacity - 1;
+}
+
+// Familias com varios labels (uma entrada por label, em sequencia) levam
+// HELP e TYPE uma vez so.
+size_t metrics_format(char* out, size_t capacity) {
+    if (capacity == 0) return 0;
+    Text text = {out, capacity, 0};
+    out[0] = '\0';
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        const MetricInfo* info = &kCounters[i];
+        if (i == 0 || strcmp(kCounters[i - 1].family, info->family) != 0) {
+            append(&text, "# HELP %s %s\n# TYPE %s counter\n", info->family, info->help, info->family);
+        }
+        append(&text, "%s%s %llu\n", info->family, info->labels, load(&metrics.counters[i]));
+    }
+    for (int i = 0; i < METRIC_TIMER_COUNT; i++) {
+        const MetricInfo* info = &kTimers[i];
+        append(&text, "# HELP %s_seconds %s\n# TYPE %s_seconds summary\n", info->family, info->help,
+               info->family);
+        append(&text, "%s_seconds_sum %.6f\n", info->family, (double)load(&metrics.timerMicros[i]) / 1e6);
+        append(&text, "%s_seconds_count %llu\n", info->family, load(&metrics.timerCount[i]));
+        append(&text, "# HELP %s_last_seconds Ultima medida de %s_seconds.\n# TYPE %s_last_seconds gauge\n",
+               info->family, info->family, info->family);
+        append(&text, "%s_last_seconds %.6f\n", info->family,
+               (double)load(&metrics.timerLastMicros[i]) / 1e6);
+    }
+    append(&text, "# HELP pacman_memory_bytes Bytes vivos por subsistema.\n# TYPE pacman_memory_bytes gauge\n");
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        MemStats stats;
+        mem_stats((MemTag)i, &stats);
+        append(&text, "pacman_memory_bytes{tag=\"%s\"} %llu\n", mem_tag_name((MemTag)i), stats.current);
+    }
+    append(&text, "# HELP pacman_memory_peak_bytes Maior valor de pacman_memory_bytes.\n"
+                  "# TYPE pacman_memory_peak_bytes gauge\n");
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        MemStats stats;
+        mem_stats((MemTag)i, &stats);
+        append(&text, "pacman_memory_peak_bytes{tag=\"%s\"} %llu\n", mem_tag_name((MemTag)i), stats.peak);
+    }
+    return text.length;
+}
+
+static void close_handle(MetricsHandle handle) {
+#ifdef _WIN32
+    closesocket(handle);
+#else
+    close(handle);
+#endif
+}
+
+static bool send_all(MetricsHandle client, const char* data, size_t size) {
+    while (size > 0) {
+        int sent = (int)send(client, data, (int)size, 0);
+        if (sent <= 0) return false;
+        data += sent;
+        size -= (size_t)sent;
+    }
+    return true;
+}
+
+// Le so a linha de requisicao; cabecalhos e corpo sao ignorados.
+static void serve_client(MetricsServer* server, MetricsHandle client) {
+    char request[METRICS_REQUEST_SIZE];
+    size_t length = 0;
+    while (length + 1 < sizeof(request) && !memchr(request, '\n', length)) {
+        int received = (int)recv(client, request + length, (int)(sizeof(request) - 1 - length), 0);
+        if (received <= 0) return;
+        length += (size_t)received;
+    }
+    request[length] = '\0';
+
+    char body[METRICS_BODY_SIZE];
+    char header[256];
+    bool found = strncmp(request, "GET /metrics ", 13) == 0 || strncmp(request, "GET / ", 6) == 0;
+    size_t bodyLength = 0;
+    if (found) {
+        atomic_fetch_add_explicit(&server->scrapes, 1, memory_order_relaxed);
+        bodyLength = metrics_format(body, sizeof(body));
+    } else {
+        bodyLength = (size_t)snprintf(body, sizeof(body), "use GET /metrics\n");
+    }
+    int headerLength = snprintf(header, sizeof(header),
+                                "HTTP/1.0 %s\r\n"
+                                "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                                "Content-Length: %zu\r\n"
+                                "Connection: close\r\n\r\n",
+                                found ? "200 OK" : "404 Not Found", bodyLength);
+    if (send_all(client, header, (size_t)headerLength)) send_all(client, body, bodyLength);
+}
+
+// Um cliente por vez: um scrape leva microssegundos e o select com timeout
+// deixa a thread ver o pedido de parada.
+static void* server_main(void* arg) {
+    MetricsServer* server = (MetricsServer*)arg;
+    MetricsHandle listener = (MetricsHandle)server->listener;
+    while (atomic_load_explicit(&server->running, memory_order_acquire)) {
+        fd_set ready;
+        FD_ZERO(&ready);
+        FD_SET(listener, &ready);
+        struct timeval wait = {0, 200000};
+        if (select((int)listener + 1, &ready, NULL, NULL, &wait) <= 0) continue;
+        MetricsHandle client = accept(listener, NULL, NULL);
+        if (client == METRICS_INVALID) continue;
+#ifdef _WIN32
+        DWORD timeout = 1000;
+#else
+        struct timeval timeout = {1, 0};
+#endif
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+        serve_client(server, client);
+        close_handle(client);
+    }
+    return NULL;
+}
+
+static MetricsHandle open_tcp(const char* address) {
+    char* end = NULL;
+    long port = strtol(address, &end, 10);
+    if (*address == '\0' || *end != '\0' || port <= 0 || port > 65535) return METRICS_INVALID;
+    MetricsHandle handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (handle == METRICS_INVALID) return METRICS_INVALID;
+    int reuse = 1;
+    setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(handle, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close_handle(handle);
+        return METRICS_INVALID;
+    }
+    return handle;
+}
+
+static MetricsHandle open_unix(MetricsServer* server, const char* path) {
+#ifdef _WIN32
+    (void)server;
+    (void)path;
+    return METRICS_INVALID;
+#else
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (strlen(path) >= sizeof(addr.sun_path) || strlen(path) >= sizeof(server->path)) {
+        return METRICS_INVALID;
+    }
+    MetricsHandle handle = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (handle == METRICS_INVALID) return METRICS_INVALID;
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    unlink(path);
+    if (bind(handle, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close_handle(handle);
+        return METRICS_INVALID;
+    }
+    snprintf(server->path, sizeof(server->path), "%s", path);
+    return handle;
+#endif
+}
+
+bool metrics_server_start(MetricsServer* server, const char* address) {
+    memset(server, 0, sizeof(*server));
+    atomic_init(&server->running, false);
+    atomic_init(&server->scrapes, 0);
+#ifdef _WIN32
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) return false;
+#endif
+    MetricsHandle handle = strchr(address, '/') ? open_unix(server, address) : open_tcp(address);
+    if (handle != METRICS_INVALID && listen(handle, 8) != 0) {
+        close_handle(handle);
+        handle = METRICS_INVALID;
+    }
+    if (handle == METRICS_INVALID) {
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+    server->listener = (intptr_t)handle;
+    atomic_store_explicit(&server->running, true, memory_order_release);
+    if (pthread_create(&server->thread, NULL, server_main, server) != 0) {
+        close_handle(handle);
+#ifndef _WIN32
+        if (server->path[0]) unlink(server->path);
+#else
+        WSACleanup();
+#endif
+        return false;
+    }
+    server->started = true;
+    return true;
+}
+
+void metrics_server_stop(MetricsServer* server) {
+    if (!server->started) return;
+    atomic_store_explicit(&server->running, false, memory_order_release);
+    pthread_join(server->thread, NULL);
+    close_handle((MetricsHandle)server->listener);
+#ifdef _WIN32
+    WSACleanup();
+#else
+    if (server->path[0]) unlink(server->path);
+#endif
+    server->started = false;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define METRICS_PATH_LEN 108
+
+typedef enum {
+    METRIC_SIM_TICKS = 0,
+    METRIC_GHOST_DECISIONS,
+    METRIC_COLLISION_CHECKS,
+    METRIC_GAME_EVENTS_DROPPED,
+    METRIC_SYNTH_EVENTS_DROPPED,
+    METRIC_COUNTER_COUNT
+} MetricCounter;
+
+typedef enum {
+    METRIC_TIMER_FRAME = 0,
+    METRIC_TIMER_LEVEL_LOAD,
+    METRIC_TIMER_MAP_PARSE,
+    METRIC_TIMER_SAVE,
+    METRIC_TIMER_COUNT
+} MetricTimer;
+
+// Contadores do processo inteiro (no servidor, todas as salas somam
+// juntas). Sao escritos com atomics relaxed: o exportador so precisa de
+// cada valor, nunca de uma ordem entre eles. Clones de busca
+// (game_step_fast) nao contam.
+typedef struct {
+    atomic_ullong counters[METRIC_COUNTER_COUNT];
+    atomic_ullong timerCount[METRIC_TIMER_COUNT];
+    atomic_ullong timerMicros[METRIC_TIMER_COUNT];
+    atomic_ullong timerLastMicros[METRIC_TIMER_COUNT];
+} MetricsRegistry;
+
+extern MetricsRegistry metrics;
+
+static inline void metrics_add(MetricCounter counter, unsigned long long amount) {
+    atomic_fetch_add_explicit(&metrics.counters[counter], amount, memory_order_relaxed);
+}
+
+double metrics_now(void);
+void metrics_observe(MetricTimer timer, double seconds);
+// Texto no formato de exposicao do Prometheus. Retorna o tamanho escrito
+// (truncado em capacity - 1).
+size_t metrics_format(char* out, size_t capacity);
+
+// Servidor HTTP minimo numa thread propria: GET /metrics responde com
+// metrics_format. address e uma porta TCP escutada so em 127.0.0.1
+// ("9105") ou o caminho de um socket Unix ("/tmp/pacman.sock").
+typedef struct {
+    pthread_t thread;
+    intptr_t listener;
+    atomic_bool running;
+    bool started;
+    char path[METRICS_PATH_LEN];
+    atomic_ullong scrapes;
+} MetricsServer;
+
+bool metrics_server_start(MetricsServer* server, const char* address);
+void metrics_server_stop(MetricsServer* server);
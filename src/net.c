@@ -0,0 +1,156 @@
+#include "net.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET NetHandle;
+#define NET_INVALID INVALID_SOCKET
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int NetHandle;
+#define NET_INVALID -1
+#endif
+
+#define NET_SOCKET_BUFFER (1 << 20)
+
+bool net_startup(void) {
+#ifdef _WIN32
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+    return true;
+#endif
+}
+
+void net_cleanup(void) {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+static bool set_nonblocking(NetHandle handle) {
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(handle, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(handle, F_GETFL, 0);
+    return flags >= 0 && fcntl(handle, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+static void close_handle(NetHandle handle) {
+#ifdef _WIN32
+    closesocket(handle);
+#else
+    close(handle);
+#endif
+}
+
+// UDP nao bloqueante em todas as interfaces; porta 0 escolhe uma livre.
+bool net_open(NetSocket* sock, uint16_t port) {
+    *sock = (NetSocket){0};
+    NetHandle handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == NET_INVALID) return false;
+    int size = NET_SOCKET_BUFFER;
+    setsockopt(handle, SOL_SOCKET, SO_RCVBUF, (const char*)&size, sizeof(size));
+    setsockopt(handle, SOL_SOCKET, SO_SNDBUF, (const char*)&size, sizeof(size));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(handle, (struct sockaddr*)&addr, sizeof(addr)) != 0 || !set_nonblocking(handle)) {
+        close_handle(handle);
+        return false;
+    }
+    sock->handle = (intptr_t)handle;
+    sock->open = true;
+    return true;
+}
+
+void net_close(NetSocket* sock) {
+    if (sock->open) close_handle((NetHandle)sock->handle);
+    *sock = (NetSocket){0};
+}
+
+bool net_resolve(const char* host, uint16_t port, NetAddress* out) {
+    if (!host || strcmp(host, "localhost") == 0) host = "127.0.0.1";
+    struct in_addr addr;
+    if (inet_pton(AF_INET, host, &addr) != 1) return false;
+    out->ip = addr.s_addr;
+    out->port = htons(port);
+    return true;
+}
+
+bool net_send(NetSocket* sock, const NetAddress* to, const void* data, size_t size) {
+    if (!sock->open) return false;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = to->ip;
+    addr.sin_port = to->port;
+    return sendto((NetHandle)sock->handle, (const char*)data, (int)size, 0,
+                  (struct sockaddr*)&addr, sizeof(addr)) == (int)size;
+}
+
+// Bytes recebidos, 0 se nao ha pacote pendente, -1 em erro.
+int net_receive(NetSocket* sock, NetAddress* from, void* buffer, size_t capacity) {
+    if (!sock->open) return -1;
+    struct sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+    int received = (int)recvfrom((NetHandle)sock->handle, (char*)buffer, (int)capacity, 0,
+                                 (struct sockaddr*)&addr, &length);
+    if (received < 0) {
+#ifdef _WIN32
+        int error = WSAGetLastError();
+        return (error == WSAEWOULDBLOCK || error == WSAECONNRESET) ? 0 : -1;
+#else
+        return 0;
+#endif
+    }
+    if (from) {
+        from->ip = addr.sin_addr.s_addr;
+        from->port = addr.sin_port;
+    }
+    return received;
+}
+
+bool net_address_equal(const NetAddress* a, const NetAddress* b) {
+    return a->ip == b->ip && a->port == b->port;
+}
+
+void net_header_init(NetHeader* header, NetMessageType type) {
+    header->magic = NET_MAGIC;
+    header->version = NET_VERSION;
+    header->type = (uint16_t)type;
+}
+
+static size_t minimum_size(int type) {
+    switch (type) {
+        case NET_MSG_HELLO: return sizeof(NetHello);
+        case NET_MSG_INPUT: return sizeof(NetInput);
+        case NET_MSG_BYE: return sizeof(NetRoomRequest);
+        case NET_MSG_MAP_REQUEST: return sizeof(NetRoomRequest);
+        case NET_MSG_WELCOME: return sizeof(NetWelcome);
+        case NET_MSG_FULL: return sizeof(NetHeader);
+        case NET_MSG_STATE: return sizeof(NetState);
+        case NET_MSG_MAP_CHUNK: return sizeof(NetMapChunk);
+        default: return 0;
+    }
+}
+
+int net_message_type(const void* data, size_t size) {
+    if (!data || size < sizeof(NetHeader)) return 0;
+    NetHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != NET_MAGIC || header.version != NET_VERSION) return 0;
+    size_t needed = minimum_size(header.type);
+    if (needed == 0 || size < needed) return 0;
+    return header.type;
+}
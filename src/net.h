@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ranking.h"
+
+#define NET_DEFAULT_PORT 7777
+#define NET_MAGIC 0x54454E50u   // "PNET"
+#define NET_VERSION 2u
+#define NET_MAX_PACKET 1400
+#define NET_MAX_GHOSTS 64
+#define NET_MAX_TILE_CHANGES 48
+#define NET_MAP_CHUNK 1024
+#define NET_ROOM_ANY -1
+
+// Protocolo UDP entre servidor de salas e clientes. Os pacotes sao structs
+// de tamanho fixo (mais arrays no fim de STATE e MAP_CHUNK) na ordem de
+// bytes da maquina, como os saves: cliente e servidor rodam na mesma rede
+// e na mesma arquitetura.
+typedef enum {
+    NET_MSG_HELLO = 1,     // cliente -> servidor: entrar numa sala
+    NET_MSG_INPUT,         // cliente -> servidor: direcao desejada
+    NET_MSG_BYE,           // cliente -> servidor: sair da sala
+    NET_MSG_MAP_REQUEST,   // cliente -> servidor: reenviar o mapa
+    NET_MSG_WELCOME,       // servidor -> cliente: sala atribuida
+    NET_MSG_FULL,          // servidor -> cliente: sem sala livre
+    NET_MSG_STATE,         // servidor -> cliente: estado a cada tick
+    NET_MSG_MAP_CHUNK      // servidor -> cliente: pedaco dos tiles do mapa
+} NetMessageType;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t type;
+} NetHeader;
+
+typedef struct {
+    NetHeader header;
+    int32_t room;
+    char name[RANKING_NAME_LEN];
+} NetHello;
+
+typedef struct {
+    NetHeader header;
+    int32_t room;
+    uint32_t seq;
+    int32_t dir;
+} NetInput;
+
+// BYE e MAP_REQUEST.
+typedef struct {
+    NetHeader header;
+    int32_t room;
+} NetRoomRequest;
+
+typedef struct {
+    NetHeader header;
+    int32_t room;
+    int32_t tickRate;
+} NetWelcome;
+
+typedef struct {
+    int16_t row;
+    int16_t col;
+} NetTile;
+
+typedef struct {
+    NetTile pos;
+    uint8_t alive;
+    uint8_t vulnerable;
+} NetGhost;
+
+// Seguido de ghostCount NetGhost e tileCount NetTile. Os tiles sao as
+// ultimas mudancas do mapa: a ultima tem numero tileChangeCount - 1. Se o
+// cliente perdeu mais do que isso, pede o mapa de novo. ghostTotal e o
+// numero de fantasmas da sala (saturado em UINT16_MAX): quando passa de
+// ghostCount, o pacote so leva os NET_MAX_GHOSTS primeiros.
+typedef struct {
+    NetHeader header;
+    uint32_t tick;
+    uint32_t mapRevision;
+    uint32_t tileChangeCount;
+    int32_t score;
+    int32_t lives;
+    int32_t level;
+    int32_t phase;
+    NetTile pacman;
+    int8_t pacmanDir;
+    uint8_t powered;
+    uint16_t ghostCount;
+    uint16_t tileCount;
+    uint16_t ghostTotal;
+} NetState;
+
+// Seguido de length tiles do mapa (linha a linha, sem padding) a partir
+// de offset.
+typedef struct {
+    NetHeader header;
+    uint32_t mapRevision;
+    uint32_t tileChangeCount;
+    int32_t rows;
+    int32_t cols;
+    uint32_t offset;
+    uint32_t length;
+} NetMapChunk;
+
+typedef struct {
+    uint32_t ip;      // ordem de bytes da rede
+    uint16_t port;    // ordem de bytes da rede
+} NetAddress;
+
+typedef struct {
+    intptr_t handle;
+    bool open;
+} NetSocket;
+
+bool net_startup(void);
+void net_cleanup(void);
+bool net_open(NetSocket* sock, uint16_t port);
+void net_close(NetSocket* sock);
+bool net_resolve(const char* host, uint16_t port, NetAddress* out);
+bool net_send(NetSocket* sock, const NetAddress* to, const void* data, size_t size);
+int net_receive(NetSocket* sock, NetAddress* from, void* buffer, size_t capacity);
+bool net_address_equal(const NetAddress* a, const NetAddress* b);
+void net_header_init(NetHeader* header, NetMessageType type);
+// Tipo da mensagem se o pacote tem cabecalho valido e o tamanho minimo do
+// tipo; 0 caso contrario.
+int net_message_type(const void* data, size_t size);
@@ -0,0 +1,308 @@
+#include "pathfind.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const int kRowStep[4] = {-1, 1, 0, 0};
+static const int kColStep[4] = {0, 0, -1, 1};
+
+static bool walkable(const Map* map, int row, int col) {
+    return map_in_bounds(map, row, col) && map_get(map, row, col) != '#';
+}
+
+static int manhattan(Position a, Position b) {
+    return abs(a.row - b.row) + abs(a.col - b.col);
+}
+
+void path_service_init(PathService* paths) {
+    memset(paths, 0, sizeof(*paths));
+}
+
+void path_service_free(PathService* paths) {
+    for (int i = 0; i < PATH_CACHE_SIZE; i++) {
+        mem_free(paths->fields[i].dist);
+    }
+    for (int i = 0; i < PATH_TRACKED_FIELDS; i++) {
+        mem_free(paths->tracked[i].dist);
+    }
+    mem_free(paths->queue);
+    mem_free(paths->parent);
+    mem_free(paths->cost);
+    mem_free(paths->heap);
+    path_service_init(paths);
+}
+
+bool path_service_reset(PathService* paths, const Map* map) {
+    unsigned int version = paths->version + 1;
+    if (paths->rows != map->rows || paths->cols != map->cols) {
+        path_service_free(paths);
+        int cellCount = map->rows * map->cols;
+        if (cellCount <= 0) return false;
+        paths->rows = map->rows;
+        paths->cols = map->cols;
+        paths->queue = (int*)mem_alloc(MEM_TAG_PATHS, sizeof(int) * cellCount);
+        paths->parent = (int*)mem_alloc(MEM_TAG_PATHS, sizeof(int) * cellCount);
+        paths->cost = (int*)mem_alloc(MEM_TAG_PATHS, sizeof(int) * cellCount);
+        paths->heapCapacity = cellCount * 4;
+        paths->heap = (PathHeapItem*)mem_alloc(MEM_TAG_PATHS, sizeof(PathHeapItem) * paths->heapCapacity);
+        bool ok = paths->queue && paths->parent && paths->cost && paths->heap;
+        for (int i = 0; i < PATH_CACHE_SIZE && ok; i++) {
+            paths->fields[i].dist = (int16_t*)mem_alloc(MEM_TAG_PATHS, sizeof(int16_t) * cellCount);
+            ok = paths->fields[i].dist != NULL;
+        }
+        if (!ok) {
+            path_service_free(paths);
+            return false;
+        }
+    }
+    paths->version = version;
+    for (int i = 0; i < PATH_CACHE_SIZE; i++) {
+        paths->fields[i].valid = false;
+    }
+    for (int i = 0; i < PATH_TRACKED_FIELDS; i++) {
+        paths->tracked[i].valid = false;
+    }
+    return true;
+}
+
+// Com limite, os campos so cobrem tiles a ate depth passos do alvo (o
+// resto fica PATH_UNREACHABLE), para que o custo da BFS acompanhe a regiao
+// ativa em mapas enormes.
+void path_service_limit_depth(PathService* paths, int depth) {
+    if (depth < 0) depth = 0;
+    if (paths->depthLimit == depth) return;
+    paths->depthLimit = depth;
+    for (int i = 0; i < PATH_CACHE_SIZE; i++) {
+        paths->fields[i].valid = false;
+    }
+    for (int i = 0; i < PATH_TRACKED_FIELDS; i++) {
+        paths->tracked[i].valid = false;
+    }
+}
+
+static void fill_distances(PathService* paths, const Map* map, Position target, int16_t* dist) {
+    int cellCount = paths->rows * paths->cols;
+    for (int i = 0; i < cellCount; i++) dist[i] = PATH_UNREACHABLE;
+    if (!map_in_bounds(map, target.row, target.col)) return;
+
+    // A fila guarda indices da grade com borda, entao os vizinhos sao lidos
+    // sem checar limites; dist usa o indice compacto row * cols + col.
+    const int gridStep[4] = {-map->stride, map->stride, -1, 1};
+    const int distStep[4] = {-paths->cols, paths->cols, -1, 1};
+    int head = 0;
+    int tail = 0;
+    dist[target.row * paths->cols + target.col] = 0;
+    paths->queue[tail++] = map_index(map, target.row, target.col);
+    while (head < tail) {
+        int node = paths->queue[head++];
+        int current = map_index_row(map, node) * paths->cols + map_index_col(map, node);
+        if (paths->depthLimit > 0 && dist[current] >= paths->depthLimit) continue;
+        for (int d = 0; d < 4; d++) {
+            int next = current + distStep[d];
+            if (map->grid[node + gridStep[d]] == '#' || dist[next] != PATH_UNREACHABLE) continue;
+            dist[next] = dist[current] < INT16_MAX ? (int16_t)(dist[current] + 1) : INT16_MAX;
+            paths->queue[tail++] = node + gridStep[d];
+        }
+    }
+}
+
+static PathField* lookup_field(PathService* paths, const Map* map, Position target) {
+    PathField* victim = &paths->fields[0];
+    paths->clock++;
+    for (int i = 0; i < PATH_CACHE_SIZE; i++) {
+        PathField* field = &paths->fields[i];
+        if (field->valid && field->version == paths->version &&
+            field->target.row == target.row && field->target.col == target.col) {
+            field->lastUse = paths->clock;
+            paths->hits++;
+            return field;
+        }
+        if (!field->valid) {
+            if (victim->valid) victim = field;
+        } else if (victim->valid && field->lastUse < victim->lastUse) {
+            victim = field;
+        }
+    }
+    paths->misses++;
+    victim->valid = true;
+    victim->target = target;
+    victim->version = paths->version;
+    victim->lastUse = paths->clock;
+    fill_distances(paths, map, target, victim->dist);
+    return victim;
+}
+
+static bool has_table(const PathService* paths, const Map* map) {
+    const PathTable* table = paths->table;
+    return table && table->dist && table->rows == map->rows && table->cols == map->cols;
+}
+
+static int table_distance(const PathTable* table, const Map* map, Position from, Position to) {
+    if (!map_in_bounds(map, to.row, to.col)) return PATH_UNREACHABLE;
+    size_t cellCount = (size_t)map->rows * (size_t)map->cols;
+    size_t target = (size_t)to.row * map->cols + to.col;
+    return table->dist[target * cellCount + (size_t)from.row * map->cols + from.col];
+}
+
+int path_distance(PathService* paths, const Map* map, Position from, Position to) {
+    if (!paths->queue || paths->rows != map->rows || paths->cols != map->cols) return PATH_UNREACHABLE;
+    if (!map_in_bounds(map, from.row, from.col)) return PATH_UNREACHABLE;
+    if (has_table(paths, map)) return table_distance(paths->table, map, from, to);
+    const PathField* field = lookup_field(paths, map, to);
+    return field->dist[from.row * paths->cols + from.col];
+}
+
+int path_tracked_distance(PathService* paths, const Map* map, int slot, Position from, Position to) {
+    if (slot < 0 || slot >= PATH_TRACKED_FIELDS) return path_distance(paths, map, from, to);
+    if (!paths->queue || paths->rows != map->rows || paths->cols != map->cols) return PATH_UNREACHABLE;
+    if (!map_in_bounds(map, from.row, from.col)) return PATH_UNREACHABLE;
+    if (has_table(paths, map)) return table_distance(paths->table, map, from, to);
+    PathField* field = &paths->tracked[slot];
+    if (!field->dist) {
+        field->dist = (int16_t*)mem_alloc(MEM_TAG_PATHS, sizeof(int16_t) * paths->rows * paths->cols);
+        if (!field->dist) return PATH_UNREACHABLE;
+    }
+    if (field->valid && field->version == paths->version &&
+        field->target.row == to.row && field->target.col == to.col) {
+        paths->hits++;
+    } else {
+        paths->misses++;
+        field->valid = true;
+        field->target = to;
+        field->version = paths->version;
+        fill_distances(paths, map, to, field->dist);
+    }
+    return field->dist[from.row * paths->cols + from.col];
+}
+
+static void heap_push(PathService* paths, int* size, int f, int node) {
+    if (*size >= paths->heapCapacity) return;
+    int i = (*size)++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (paths->heap[parent].f <= f) break;
+        paths->heap[i] = paths->heap[parent];
+        i = parent;
+    }
+    paths->heap[i] = (PathHeapItem){f, node};
+}
+
+static PathHeapItem heap_pop(PathService* paths, int* size) {
+    PathHeapItem top = paths->heap[0];
+    PathHeapItem last = paths->heap[--(*size)];
+    int i = 0;
+    while (true) {
+        int child = i * 2 + 1;
+        if (child >= *size) break;
+        if (child + 1 < *size && paths->heap[child + 1].f < paths->heap[child].f) child++;
+        if (paths->heap[child].f >= last.f) break;
+        paths->heap[i] = paths->heap[child];
+        i = child;
+    }
+    if (*size > 0) paths->heap[i] = last;
+    return top;
+}
+
+int path_astar(PathService* paths, const Map* map, Position from, Position to,
+               Position* out, int maxLen) {
+    if (!paths->heap || paths->rows != map->rows || paths->cols != map->cols) return PATH_UNREACHABLE;
+    if (!walkable(map, from.row, from.col) || !walkable(map, to.row, to.col)) return PATH_UNREACHABLE;
+
+    int cellCount = paths->rows * paths->cols;
+    for (int i = 0; i < cellCount; i++) {
+        paths->cost[i] = -1;
+        paths->parent[i] = -1;
+    }
+    // Como em fill_distances: o heap guarda indices da grade com borda e
+    // cost/parent usam o indice compacto.
+    const int gridStep[4] = {-map->stride, map->stride, -1, 1};
+    const int costStep[4] = {-paths->cols, paths->cols, -1, 1};
+    int goal = to.row * paths->cols + to.col;
+    int goalNode = map_index(map, to.row, to.col);
+    int heapSize = 0;
+    paths->cost[from.row * paths->cols + from.col] = 0;
+    heap_push(paths, &heapSize, manhattan(from, to), map_index(map, from.row, from.col));
+
+    bool found = false;
+    while (heapSize > 0) {
+        PathHeapItem item = heap_pop(paths, &heapSize);
+        int node = item.node;
+        if (node == goalNode) {
+            found = true;
+            break;
+        }
+        int row = map_index_row(map, node);
+        int col = map_index_col(map, node);
+        int current = row * paths->cols + col;
+        if (item.f > paths->cost[current] + manhattan((Position){row, col}, to)) continue;
+        for (int d = 0; d < 4; d++) {
+            if (map->grid[node + gridStep[d]] == '#') continue;
+            int next = current + costStep[d];
+            int g = paths->cost[current] + 1;
+            if (paths->cost[next] >= 0 && paths->cost[next] <= g) continue;
+            paths->cost[next] = g;
+            paths->parent[next] = current;
+            Position pos = {row + kRowStep[d], col + kColStep[d]};
+            heap_push(paths, &heapSize, g + manhattan(pos, to), node + gridStep[d]);
+        }
+    }
+    if (!found) return PATH_UNREACHABLE;
+
+    int length = paths->cost[goal];
+    if (out && maxLen > 0) {
+        int node = goal;
+        for (int step = length; step >= 0; step--) {
+            if (step < maxLen) {
+                out[step].row = node / paths->cols;
+                out[step].col = node % paths->cols;
+            }
+            node = paths->parent[node];
+        }
+    }
+    return length;
+}
+
+bool path_table_build(PathTable* table, PathService* paths, const Map* map) {
+    path_table_free(table);
+    if (!paths->queue || paths->rows != map->rows || paths->cols != map->cols) return false;
+    size_t cellCount = (size_t)map->rows * (size_t)map->cols;
+    if (cellCount > PATH_TABLE_MAX_CELLS) return false;
+    table->dist = (int16_t*)mem_alloc(MEM_TAG_PATHS, sizeof(int16_t) * cellCount * cellCount);
+    if (!table->dist) return false;
+    table->rows = map->rows;
+    table->cols = map->cols;
+    for (int row = 0; row < map->rows; row++) {
+        for (int col = 0; col < map->cols; col++) {
+            size_t target = (size_t)row * map->cols + col;
+            fill_distances(paths, map, (Position){row, col}, table->dist + target * cellCount);
+        }
+    }
+    return true;
+}
+
+void path_table_free(PathTable* table) {
+    mem_free(table->dist);
+    table->dist = NULL;
+    table->rows = 0;
+    table->cols = 0;
+}
+
+GhostStrategy ghost_default_strategy(int index) {
+    static const GhostStrategy kRotation[] = {
+        GHOST_STRATEGY_CHASE,
+        GHOST_STRATEGY_AMBUSH,
+        GHOST_STRATEGY_SCATTER,
+        GHOST_STRATEGY_CHASE
+    };
+    return kRotation[index % 4];
+}
+
+Position ghost_scatter_corner(const Map* map, int index) {
+    Position corners[4] = {
+        {1, 1},
+        {1, map->cols - 2},
+        {map->rows - 2, 1},
+        {map->rows - 2, map->cols - 2}
+    };
+    return corners[(index / 4 + index) % 4];
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "entity.h"
+#include "map.h"
+
+#define PATH_CACHE_SIZE 16
+#define PATH_UNREACHABLE -1
+#define PATH_TABLE_MAX_CELLS 4096
+#define PATH_TRACKED_FIELDS 32
+
+// Campo de distancias BFS ate um alvo. Um campo responde a consulta
+// (from, to, version) para qualquer from, entao e reaproveitado por todos
+// os fantasmas e por todos os ticks em que o alvo nao muda.
+typedef struct {
+    bool valid;
+    Position target;
+    unsigned int version;
+    unsigned int lastUse;
+    int16_t* dist;
+} PathField;
+
+typedef struct {
+    int f;
+    int node;
+} PathHeapItem;
+
+// Distancias de todos para todos (alvo x origem) de um mapa. Depois de
+// montada e somente leitura, entao pode ser compartilhada por varias
+// PathService (por exemplo, clones usados em busca). Ocupa cells^2 int16,
+// entao so e montada ate PATH_TABLE_MAX_CELLS tiles.
+typedef struct {
+    int rows;
+    int cols;
+    int16_t* dist;
+} PathTable;
+
+typedef struct {
+    int rows;
+    int cols;
+    unsigned int version;
+    unsigned int clock;
+    PathField fields[PATH_CACHE_SIZE];
+    int* queue;
+    int* parent;
+    int* cost;
+    PathHeapItem* heap;
+    int heapCapacity;
+    // Campos fora do LRU para alvos que andam (dois por jogador: a posicao
+    // e o tile a frente dele), alocados no primeiro uso.
+    PathField tracked[PATH_TRACKED_FIELDS];
+    const PathTable* table;
+    int depthLimit;       // 0 = BFS sem limite
+    unsigned long long hits;
+    unsigned long long misses;
+} PathService;
+
+void path_service_init(PathService* paths);
+bool path_service_reset(PathService* paths, const Map* map);
+void path_service_free(PathService* paths);
+void path_service_limit_depth(PathService* paths, int depth);
+int path_distance(PathService* paths, const Map* map, Position from, Position to);
+// Como path_distance, mas no campo tracked[slot]: ele so e refeito quando
+// to muda de tile, entao os fantasmas que seguem um jogador dividem uma
+// BFS por passo dele sem expulsar do cache os alvos fixos.
+int path_tracked_distance(PathService* paths, const Map* map, int slot, Position from, Position to);
+int path_astar(PathService* paths, const Map* map, Position from, Position to,
+               Position* out, int maxLen);
+bool path_table_build(PathTable* table, PathService* paths, const Map* map);
+void path_table_free(PathTable* table);
+GhostStrategy ghost_default_strategy(int index);
+Position ghost_scatter_corner(const Map* map, int index);
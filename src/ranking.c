@@ -1,4 +1,5 @@
 #include "ranking.h"
+#include "trace.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -25,10 +26,14 @@ bool ranking_load(Ranking* ranking, const char* path) {
 }
 
 bool ranking_save(const Ranking* ranking, const char* path) {
+    trace_begin("ranking_save");
+    size_t written = 0;
     FILE* f = fopen(path, "wb");
-    if (!f) return false;
-    size_t written = fwrite(ranking->entries, sizeof(RankingEntry), RANKING_MAX_ENTRIES, f);
-    fclose(f);
+    if (f) {
+        written = fwrite(ranking->entries, sizeof(RankingEntry), RANKING_MAX_ENTRIES, f);
+        fclose(f);
+    }
+    trace_end("ranking_save");
     return written == RANKING_MAX_ENTRIES;
 }
 
@@ -1,8 +1,14 @@
 #include "render.h"
 #include "game.h"
+#include "memtrack.h"
+#include "trace.h"
+#include "uitext.h"
 #include "raylib.h"
-#include <stdio.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MEMORY_COLUMNS 4
 
 static const Color WALL_COLOR = {0, 82, 204, 255};
 static const Color FLOOR_COLOR = {15, 15, 15, 255};
@@ -25,10 +31,112 @@ static Vector2 tile_center(int row, int col) {
     return v;
 }
 
-static void draw_map_tiles(const GameState* game) {
+static float step_fraction(float moveTimer, float interval, float alpha) {
+    float t = (moveTimer + alpha * SIM_TICK_DT) / interval;
+    if (t < 0.0f) return 0.0f;
+    if (t > 1.0f) return 1.0f;
+    return t;
+}
+
+static Vector2 interpolated_center(Position from, Position to, float t) {
+    Vector2 end = tile_center(to.row, to.col);
+    if (abs(from.row - to.row) + abs(from.col - to.col) != 1) return end;
+    Vector2 start = tile_center(from.row, from.col);
+    Vector2 v = {
+        start.x + (end.x - start.x) * t,
+        start.y + (end.y - start.y) * t
+    };
+    return v;
+}
+
+// Faixa de tiles visivel (inclusiva) e retangulo do mundo coberto pela camera.
+typedef struct {
+    Camera2D camera;
+    Rectangle world;
+    int rowStart;
+    int rowEnd;
+    int colStart;
+    int colEnd;
+} RenderView;
+
+void render_camera_init(RenderCamera* camera) {
+    camera->zoom = 1.0f;
+}
+
+void render_camera_zoom(RenderCamera* camera, float factor) {
+    float zoom = camera->zoom * factor;
+    if (zoom < RENDER_ZOOM_MIN) zoom = RENDER_ZOOM_MIN;
+    if (zoom > RENDER_ZOOM_MAX) zoom = RENDER_ZOOM_MAX;
+    camera->zoom = zoom;
+}
+
+static Vector2 pacman_center(const Pacman* pacman, float alpha) {
+    float t = step_fraction(pacman->moveTimer, PACMAN_STEP_INTERVAL, alpha);
+    return interpolated_center(pacman->prevPos, pacman->pos, t);
+}
+
+// A camera segue o jogador local; se ele ja saiu da partida, o primeiro
+// ainda ativo.
+static const Pacman* camera_player(const GameState* game) {
+    for (int i = 0; i < game->playerCount; i++) {
+        if (game->players[i].active) return &game->players[i];
+    }
+    return &game->players[0];
+}
+
+static float follow_axis(float focus, float mapSize, float viewSize) {
+    if (mapSize <= viewSize) return mapSize / 2.0f;
+    if (focus < viewSize / 2.0f) return viewSize / 2.0f;
+    if (focus > mapSize - viewSize / 2.0f) return mapSize - viewSize / 2.0f;
+    return focus;
+}
+
+static int clamp_index(int value, int count) {
+    if (value < 0) return 0;
+    if (value >= count) return count - 1;
+    return value;
+}
+
+static RenderView make_view(const GameState* game, const RenderCamera* camera, float alpha) {
+    RenderView view;
+    float zoom = camera ? camera->zoom : 1.0f;
+    float screenWidth = (float)WINDOW_WIDTH;
+    float screenHeight = (float)(MAP_ROWS * TILE_SIZE);
+    float viewWidth = screenWidth / zoom;
+    float viewHeight = screenHeight / zoom;
+    Vector2 focus = pacman_center(camera_player(game), alpha);
+
+    view.camera.offset = (Vector2){screenWidth / 2.0f, screenHeight / 2.0f};
+    view.camera.target = (Vector2){
+        follow_axis(focus.x, (float)(game->map.cols * TILE_SIZE), viewWidth),
+        follow_axis(focus.y, (float)(game->map.rows * TILE_SIZE), viewHeight)
+    };
+    view.camera.rotation = 0.0f;
+    view.camera.zoom = zoom;
+    view.world = (Rectangle){
+        view.camera.target.x - viewWidth / 2.0f,
+        view.camera.target.y - viewHeight / 2.0f,
+        viewWidth,
+        viewHeight
+    };
+    view.colStart = clamp_index((int)floorf(view.world.x / TILE_SIZE), game->map.cols);
+    view.colEnd = clamp_index((int)floorf((view.world.x + viewWidth) / TILE_SIZE), game->map.cols);
+    view.rowStart = clamp_index((int)floorf(view.world.y / TILE_SIZE), game->map.rows);
+    view.rowEnd = clamp_index((int)floorf((view.world.y + viewHeight) / TILE_SIZE), game->map.rows);
+    return view;
+}
+
+static bool view_contains(const RenderView* view, Vector2 center) {
+    const Rectangle* world = &view->world;
+    return center.x + TILE_SIZE >= world->x && center.x - TILE_SIZE <= world->x + world->width &&
+           center.y + TILE_SIZE >= world->y && center.y - TILE_SIZE <= world->y + world->height;
+}
+
+static void draw_map_tiles(const GameState* game, const RenderView* view) {
     const Map* map = &game->map;
-    for (int row = 0; row < map->rows; row++) {
-        for (int col = 0; col < map->cols; col++) {
+    if (!map->grid) return;
+    for (int row = view->rowStart; row <= view->rowEnd; row++) {
+        for (int col = view->colStart; col <= view->colEnd; col++) {
             char cell = map_get(map, row, col);
             Rectangle rect = tile_rect(row, col);
             DrawRectangleRec(rect, FLOOR_COLOR);
@@ -57,9 +165,18 @@ static void draw_map_tiles(const GameState* game) {
     }
 }
 
-static void draw_pacman(const Pacman* pacman) {
-    Vector2 center = tile_center(pacman->pos.row, pacman->pos.col);
-    Color color = pacman->powered ? GOLD : YELLOW;
+static const Color PLAYER_COLORS[] = {
+    YELLOW, SKYBLUE, LIME, PINK, ORANGE, VIOLET, BEIGE, MAGENTA
+};
+#define PLAYER_COLOR_COUNT ((int)(sizeof(PLAYER_COLORS) / sizeof(PLAYER_COLORS[0])))
+
+static Color player_color(const GameState* game, int index) {
+    if (index == 0 && game->powered) return GOLD;
+    return PLAYER_COLORS[index % PLAYER_COLOR_COUNT];
+}
+
+static void draw_pacman(const Pacman* pacman, Color color, float alpha) {
+    Vector2 center = pacman_center(pacman, alpha);
     float radius = (float)TILE_SIZE / 2.2f;
     DrawCircleV(center, radius, color);
 
@@ -130,37 +247,104 @@ static void draw_ghost_shape(Vector2 center, bool vulnerable) {
     DrawCircleV((Vector2){rightEye.x + 4, rightEye.y}, headRadius * 0.15f, pupil);
 }
 
-static void draw_ghosts(const GameState* game) {
+static void draw_players(const GameState* game, const RenderView* view, float alpha) {
+    for (int i = 0; i < game->playerCount; i++) {
+        const Pacman* player = &game->players[i];
+        if (!player->active && game->playerCount > 1) continue;
+        if (!view_contains(view, tile_center(player->pos.row, player->pos.col))) continue;
+        draw_pacman(player, player_color(game, i), alpha);
+    }
+}
+
+static void draw_ghosts(const GameState* game, const RenderView* view, float alpha) {
     if (!game->ghosts) return;
     for (int i = 0; i < game->ghostCount; i++) {
         const Ghost* ghost = &game->ghosts[i];
         if (!ghost->alive) continue;
-        Vector2 center = tile_center(ghost->pos.row, ghost->pos.col);
-        draw_ghost_shape(center, ghost->vulnerable);
+        if (!view_contains(view, tile_center(ghost->pos.row, ghost->pos.col))) continue;
+        bool vulnerable = game_ghost_vulnerable(game, ghost);
+        float interval = vulnerable ? GHOST_STEP_INTERVAL_VULNERABLE : GHOST_STEP_INTERVAL;
+        float t = step_fraction(ghost->moveTimer, interval, alpha);
+        Vector2 center = interpolated_center(ghost->prevPos, ghost->pos, t);
+        draw_ghost_shape(center, vulnerable);
     }
 }
 
+// Textos retidos do HUD e das telas: cada um so e reformatado e medido
+// quando o valor que ele mostra muda. Usado so pela thread de desenho.
+static struct {
+    UiText lives;
+    UiText score;
+    UiText level;
+    UiText pellets;
+    UiText timeScale;
+    UiText autopilot;
+    UiText message;
+    UiText players[GAME_MAX_PLAYERS];
+    UiText endTitle;
+    UiText endSubtitle;
+    UiText recordTitle;
+    UiText recordScore;
+    UiText recordHint;
+    UiText recordName;
+    UiText title;
+    UiText subtitle;
+    UiText titleOptions[4];
+    UiText rankingTitle;
+    UiText rankingHint;
+    UiText rankingLines[RANKING_MAX_ENTRIES];
+    RankingEntry rankingShown[RANKING_MAX_ENTRIES];
+    UiText menuTitle;
+    UiText menuOptions[5];
+    UiText memoryHeaders[MEMORY_COLUMNS];
+    UiText memoryCells[MEM_TAG_COUNT + 1][MEMORY_COLUMNS];
+    MemStats memoryShown[MEM_TAG_COUNT + 1];
+} ui;
+
 static void draw_hud(const GameState* game) {
     const float hudY = (float)(MAP_ROWS * TILE_SIZE);
+    const int textY = (int)hudY + 10;
     Rectangle hudRect = {0, hudY, WINDOW_WIDTH, HUD_HEIGHT};
     DrawRectangleRec(hudRect, (Color){25, 25, 25, 255});
     DrawLine(0, (int)hudY, WINDOW_WIDTH, (int)hudY, DARKGRAY);
 
-    char text[64];
-    snprintf(text, sizeof(text), "Vidas: %d", game->lives);
-    DrawText(text, 10, (int)hudY + 10, 18, RAYWHITE);
+    ui_text_bind_int(&ui.lives, 18, "Vidas: %d", game->lives);
+    ui_text_draw(&ui.lives, 10, textY, RAYWHITE);
+
+    ui_text_bind_int(&ui.score, 18, "Score: %06d", game->score);
+    ui_text_draw(&ui.score, 170, textY, RAYWHITE);
 
-    snprintf(text, sizeof(text), "Score: %06d", game->score);
-    DrawText(text, 170, (int)hudY + 10, 18, RAYWHITE);
+    ui_text_bind_int(&ui.level, 18, "Nivel: %d", game->level);
+    ui_text_draw(&ui.level, 370, textY, RAYWHITE);
 
-    snprintf(text, sizeof(text), "Nivel: %d", game->level);
-    DrawText(text, 370, (int)hudY + 10, 18, RAYWHITE);
+    ui_text_bind_int2(&ui.pellets, 18, "Pellets: %d/%d", game->pelletsRemaining, game->map.pelletsInitial);
+    ui_text_draw(&ui.pellets, 520, textY, RAYWHITE);
 
-    snprintf(text, sizeof(text), "Pellets: %d/%d", game->pelletsRemaining, game->map.pelletsInitial);
-    DrawText(text, 520, (int)hudY + 10, 18, RAYWHITE);
+    if (game->timeScale != 1.0f) {
+        ui_text_bind_float(&ui.timeScale, 18, "x%.2f", game->timeScale);
+        ui_text_draw(&ui.timeScale, WINDOW_WIDTH - 90, textY, ORANGE);
+    }
+    if (game->autopilot) {
+        ui_text_label(&ui.autopilot, 18, "AUTO");
+        ui_text_draw(&ui.autopilot, WINDOW_WIDTH - 160, textY, SKYBLUE);
+    }
 
-    if (game->hudMessageTimer > 0.0f && game->hudMessage[0] != '\0') {
-        DrawText(game->hudMessage, 820, (int)hudY + 10, 18, YELLOW);
+    if (game->hudMessage[0] != '\0') {
+        ui_text_bind_string(&ui.message, 18, game->hudMessage);
+        ui_text_draw(&ui.message, 820, textY, YELLOW);
+    }
+
+    // Com varios jogadores, uma faixa no topo com score e vidas de cada um.
+    if (game->playerCount > 1) {
+        const int slot = WINDOW_WIDTH / GAME_MAX_PLAYERS;
+        DrawRectangle(0, 0, slot * game->playerCount, 22, (Color){0, 0, 0, 170});
+        for (int i = 0; i < game->playerCount; i++) {
+            const Pacman* player = &game->players[i];
+            Color color = player->active ? PLAYER_COLORS[i % PLAYER_COLOR_COUNT] : DARKGRAY;
+            DrawCircle(i * slot + 10, 11, 6.0f, color);
+            ui_text_bind_int2(&ui.players[i], 14, "%d x%d", player->score, player->lives);
+            ui_text_draw(&ui.players[i], i * slot + 20, 4, player->active ? RAYWHITE : GRAY);
+        }
     }
 }
 
@@ -171,30 +355,27 @@ static void draw_end_overlay(const GameState* game) {
     }
     if (overlayPhase != GAME_PHASE_VICTORY && overlayPhase != GAME_PHASE_GAMEOVER) return;
     DrawRectangle(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, Fade(BLACK, 0.75f));
-    const char* title = (overlayPhase == GAME_PHASE_VICTORY) ? "Vitoria!" : "Game Over";
-    const char* subtitle = (overlayPhase == GAME_PHASE_VICTORY)
+    bool victory = overlayPhase == GAME_PHASE_VICTORY;
+    ui_text_label(&ui.endTitle, 48, victory ? "Vitoria!" : "Game Over");
+    ui_text_label(&ui.endSubtitle, 24, victory
         ? "N: Novo jogo  R: Ranking  Q: Sair"
-        : "N: Reiniciar  R: Ranking  Q: Sair";
-    int titleWidth = MeasureText(title, 48);
-    int subWidth = MeasureText(subtitle, 24);
+        : "N: Reiniciar  R: Ranking  Q: Sair");
     int centerX = WINDOW_WIDTH / 2;
-    DrawText(title, centerX - titleWidth / 2, WINDOW_HEIGHT / 2 - 60, 48, GOLD);
-    DrawText(subtitle, centerX - subWidth / 2, WINDOW_HEIGHT / 2, 24, RAYWHITE);
+    ui_text_draw_centered(&ui.endTitle, centerX, WINDOW_HEIGHT / 2 - 60, GOLD);
+    ui_text_draw_centered(&ui.endSubtitle, centerX, WINDOW_HEIGHT / 2, RAYWHITE);
 }
 
 static void render_name_entry_overlay(const GameState* game) {
     if (game->phase != GAME_PHASE_ENTER_SCORE) return;
     DrawRectangle(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, Fade(BLACK, 0.8f));
-    const char* title = "Novo recorde!";
-    char scoreText[64];
-    snprintf(scoreText, sizeof(scoreText), "Pontuacao: %06d", game->pendingRankingScore);
-    const char* hint = "Digite seu nome e pressione ENTER (ESC para ignorar)";
+    ui_text_label(&ui.recordTitle, 42, "Novo recorde!");
+    ui_text_bind_int(&ui.recordScore, 24, "Pontuacao: %06d", game->pendingRankingScore);
+    ui_text_label(&ui.recordHint, 20, "Digite seu nome e pressione ENTER (ESC para ignorar)");
     int centerX = WINDOW_WIDTH / 2;
     int y = WINDOW_HEIGHT / 2 - 80;
-    int titleWidth = MeasureText(title, 42);
-    DrawText(title, centerX - titleWidth / 2, y, 42, GOLD);
-    DrawText(scoreText, centerX - MeasureText(scoreText, 24) / 2, y + 60, 24, RAYWHITE);
-    DrawText(hint, centerX - MeasureText(hint, 20) / 2, y + 100, 20, LIGHTGRAY);
+    ui_text_draw_centered(&ui.recordTitle, centerX, y, GOLD);
+    ui_text_draw_centered(&ui.recordScore, centerX, y + 60, RAYWHITE);
+    ui_text_draw_centered(&ui.recordHint, centerX, y + 100, LIGHTGRAY);
 
     Rectangle inputRect = {
         .x = (float)(centerX - 200),
@@ -204,54 +385,107 @@ static void render_name_entry_overlay(const GameState* game) {
     };
     DrawRectangleRec(inputRect, (Color){20, 20, 20, 255});
     DrawRectangleLinesEx(inputRect, 2.0f, GOLD);
-    const char* name = (game->nameEntryLen > 0) ? game->nameEntry : "_";
-    DrawText(name, centerX - MeasureText(name, 28) / 2, (int)inputRect.y + 10, 28, RAYWHITE);
+    ui_text_bind_string(&ui.recordName, 28, (game->nameEntryLen > 0) ? game->nameEntry : "_");
+    ui_text_draw_centered(&ui.recordName, centerX, (int)inputRect.y + 10, RAYWHITE);
 }
 
 void render_title_screen(const GameState* game) {
     (void)game;
-    const char* title = "PAC-MAN Prog II";
-    const char* subtitle = "Trabalho Pratico - Turma 2025/2";
     int centerX = WINDOW_WIDTH / 2;
-    int titleWidth = MeasureText(title, 48);
-    DrawText(title, centerX - titleWidth / 2, 160, 48, YELLOW);
-    DrawText(subtitle, centerX - MeasureText(subtitle, 20) / 2, 220, 20, LIGHTGRAY);
+    ui_text_label(&ui.title, 48, "PAC-MAN Prog II");
+    ui_text_label(&ui.subtitle, 20, "Trabalho Pratico - Turma 2025/2");
+    ui_text_draw_centered(&ui.title, centerX, 160, YELLOW);
+    ui_text_draw_centered(&ui.subtitle, centerX, 220, LIGHTGRAY);
 
-    const char* options[] = {
+    static const char* options[] = {
         "[N] Novo jogo",
         "[C] Carregar jogo salvo",
         "[R] Ver ranking",
         "[Q] Sair"
     };
     for (int i = 0; i < 4; i++) {
-        DrawText(options[i], centerX - 160, 300 + i * 40, 24, RAYWHITE);
+        ui_text_label(&ui.titleOptions[i], 24, options[i]);
+        ui_text_draw(&ui.titleOptions[i], centerX - 160, 300 + i * 40, RAYWHITE);
     }
 }
 
+static void update_ranking_line(int index, const RankingEntry* entry) {
+    RankingEntry* shown = &ui.rankingShown[index];
+    UiText* line = &ui.rankingLines[index];
+    if (line->valid && shown->score == entry->score && strcmp(shown->name, entry->name) == 0) return;
+    *shown = *entry;
+    ui_text_printf(line, 24, "%2d. %-10s %6d", index + 1, entry->name, entry->score);
+}
+
 void render_ranking_screen(const GameState* game) {
     DrawRectangle(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, Fade(BLACK, 0.7f));
-    const char* title = "Ranking de Pontuacoes";
     int centerX = WINDOW_WIDTH / 2;
-    DrawText(title, centerX - MeasureText(title, 36) / 2, 80, 36, GOLD);
+    ui_text_label(&ui.rankingTitle, 36, "Ranking de Pontuacoes");
+    ui_text_draw_centered(&ui.rankingTitle, centerX, 80, GOLD);
 
     for (int i = 0; i < RANKING_MAX_ENTRIES; i++) {
-        const RankingEntry* entry = &game->ranking.entries[i];
-        char line[64];
-        snprintf(line, sizeof(line), "%2d. %-10s %6d", i + 1, entry->name, entry->score);
-        DrawText(line, centerX - 150, 150 + i * 28, 24, RAYWHITE);
+        update_ranking_line(i, &game->ranking.entries[i]);
+        ui_text_draw(&ui.rankingLines[i], centerX - 150, 150 + i * 28, RAYWHITE);
     }
 
-    const char* hint = "[ESC] Voltar  [N] Novo jogo  [Q] Sair";
-    DrawText(hint, centerX - MeasureText(hint, 20) / 2, WINDOW_HEIGHT - 80, 20, LIGHTGRAY);
+    ui_text_label(&ui.rankingHint, 20, "[ESC] Voltar  [N] Novo jogo  [Q] Sair");
+    ui_text_draw_centered(&ui.rankingHint, centerX, WINDOW_HEIGHT - 80, LIGHTGRAY);
 }
 
-void render_game(const GameState* game) {
-    draw_map_tiles(game);
-    draw_pacman(&game->pacman);
-    draw_ghosts(game);
+void render_game(const GameState* game, const RenderCamera* camera, float alpha) {
+    trace_begin("render_game");
+    RenderView view = make_view(game, camera, alpha);
+    BeginMode2D(view.camera);
+    trace_begin("draw_map_tiles");
+    draw_map_tiles(game, &view);
+    trace_end("draw_map_tiles");
+    trace_begin("draw_entities");
+    draw_players(game, &view, alpha);
+    draw_ghosts(game, &view, alpha);
+    trace_end("draw_entities");
+    EndMode2D();
+    trace_begin("draw_hud");
     draw_hud(game);
     draw_end_overlay(game);
     render_name_entry_overlay(game);
+    trace_end("draw_hud");
+    trace_end("render_game");
+}
+
+static const int kMemoryColumnX[MEMORY_COLUMNS] = {0, 100, 190, 280};
+
+// A fonte padrao nao e monoespacada: cada coluna e um texto proprio.
+static void draw_memory_row(int index, const char* name, const MemStats* stats, int x, int y, Color color) {
+    UiText* cells = ui.memoryCells[index];
+    if (!cells[0].valid || memcmp(&ui.memoryShown[index], stats, sizeof(*stats)) != 0) {
+        ui.memoryShown[index] = *stats;
+        ui_text_printf(&cells[0], 14, "%s", name);
+        ui_text_printf(&cells[1], 14, "%.1f", (double)stats->current / 1024.0);
+        ui_text_printf(&cells[2], 14, "%.1f", (double)stats->peak / 1024.0);
+        ui_text_printf(&cells[3], 14, "%llu", stats->blocks);
+    }
+    for (int i = 0; i < MEMORY_COLUMNS; i++) ui_text_draw(&cells[i], x + kMemoryColumnX[i], y, color);
+}
+
+// Independe do estado do jogo: os contadores sao do processo inteiro.
+void render_memory_overlay(void) {
+    static const char* headers[MEMORY_COLUMNS] = {"memoria", "KB", "pico KB", "blocos"};
+    const int lineHeight = 16;
+    const int width = 330;
+    const int x = WINDOW_WIDTH - width - 10;
+    const int y = 30;
+    DrawRectangle(x - 8, y - 6, width + 16, lineHeight * (MEM_TAG_COUNT + 2) + 12, Fade(BLACK, 0.75f));
+    for (int i = 0; i < MEMORY_COLUMNS; i++) {
+        ui_text_label(&ui.memoryHeaders[i], 14, headers[i]);
+        ui_text_draw(&ui.memoryHeaders[i], x + kMemoryColumnX[i], y, LIGHTGRAY);
+    }
+    MemStats stats;
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        mem_stats((MemTag)i, &stats);
+        draw_memory_row(i, mem_tag_name((MemTag)i), &stats, x, y + lineHeight * (i + 1), RAYWHITE);
+    }
+    mem_total(&stats);
+    draw_memory_row(MEM_TAG_COUNT, "total", &stats, x, y + lineHeight * (MEM_TAG_COUNT + 1), YELLOW);
 }
 
 void render_menu(const GameState* game) {
@@ -259,7 +493,8 @@ void render_menu(const GameState* game) {
 
     DrawRectangle(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, Fade(BLACK, 0.6f));
 
-    DrawText("MENU", 60, 60, 32, YELLOW);
+    ui_text_label(&ui.menuTitle, 32, "MENU");
+    ui_text_draw(&ui.menuTitle, 60, 60, YELLOW);
     static const char* options[] = {
         "Novo jogo (N)",
         "Carregar (C)",
@@ -274,6 +509,7 @@ void render_menu(const GameState* game) {
 
     for (int i = 0; i < optionCount; i++) {
         Color color = (i == highlight) ? GOLD : RAYWHITE;
-        DrawText(options[i], 80, 120 + i * 32, 24, color);
+        ui_text_label(&ui.menuOptions[i], 24, options[i]);
+        ui_text_draw(&ui.menuOptions[i], 80, 120 + i * 32, color);
     }
 }
@@ -2,7 +2,22 @@
 
 struct GameState;
 
-void render_game(const struct GameState* game);
+#define RENDER_ZOOM_MIN 0.25f
+#define RENDER_ZOOM_MAX 4.0f
+
+// Camera da area de jogo: segue o Pac-Man sem mostrar fora do mapa (mapas
+// menores que a tela ficam centralizados) e aplica o zoom. Tiles e
+// fantasmas fora da visao nao geram chamadas de desenho.
+typedef struct RenderCamera {
+    float zoom;
+} RenderCamera;
+
+void render_camera_init(RenderCamera* camera);
+void render_camera_zoom(RenderCamera* camera, float factor);
+
+void render_game(const struct GameState* game, const RenderCamera* camera, float alpha);
 void render_menu(const struct GameState* game);
 void render_title_screen(const struct GameState* game);
 void render_ranking_screen(const struct GameState* game);
+// Painel de depuracao (F3) com a memoria por tag de memtrack.h.
+void render_memory_overlay(void);
@@ -1,5 +1,9 @@
 #include "save.h"
 #include "game.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "trace.h"
+#include "zobrist.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -33,6 +37,18 @@ typedef struct {
     float moveTimer;
 } SaveGhostState;
 
+// Bloco opcional no fim do arquivo (saves antigos terminam nos fantasmas e
+// carregam como um jogador so).
+typedef struct {
+    Position pos;
+    int dir;
+    int pendingDir;
+    float moveTimer;
+    int score;
+    int lives;
+    int active;
+} SavePlayerState;
+
 static bool write_data(const void* ptr, size_t size, size_t count, FILE* f) {
     return fwrite(ptr, size, count, f) == count;
 }
@@ -41,10 +57,7 @@ static bool read_data(void* ptr, size_t size, size_t count, FILE* f) {
     return fread(ptr, size, count, f) == count;
 }
 
-bool save_game(const GameState* game, const char* path) {
-    FILE* f = fopen(path, "wb");
-    if (!f) return false;
-
+static bool write_save(const GameState* game, FILE* f) {
     SaveHeader header = {
         .level = game->level,
         .score = game->score,
@@ -55,19 +68,20 @@ bool save_game(const GameState* game, const char* path) {
         .mapCols = game->map.cols,
         .ghostCount = game->ghostCount,
         .portalCount = game->map.portalCount,
-        .pacmanPos = game->pacman.pos,
+        .pacmanPos = game->players[0].pos,
         .pacmanStart = game->map.pacmanStart,
-        .pacmanDir = game->pacman.dir,
-        .pacmanPending = game->pacman.pendingDir,
-        .pacmanPowered = game->pacman.powered ? 1 : 0,
-        .pacmanPowerTimeLeft = game->pacman.powerTimeLeft,
-        .pacmanMoveTimer = game->pacman.moveTimer
+        .pacmanDir = game->players[0].dir,
+        .pacmanPending = game->players[0].pendingDir,
+        .pacmanPowered = game->powered ? 1 : 0,
+        .pacmanPowerTimeLeft = game_power_time_left(game),
+        .pacmanMoveTimer = game->players[0].moveTimer
     };
     snprintf(header.currentMapPath, sizeof(header.currentMapPath), "%s", game->currentMapPath);
 
-    size_t totalCells = (size_t)game->map.rows * (size_t)game->map.cols;
-    bool ok = write_data(&header, sizeof(SaveHeader), 1, f) &&
-              write_data(game->map.cells, sizeof(char), totalCells, f);
+    bool ok = write_data(&header, sizeof(SaveHeader), 1, f);
+    for (int row = 0; row < game->map.rows && ok; row++) {
+        ok = write_data(map_row(&game->map, row), sizeof(char), (size_t)game->map.cols, f);
+    }
 
     if (ok && game->map.ghostCount > 0 && game->map.ghostStarts) {
         ok = write_data(game->map.ghostStarts, sizeof(Position), game->map.ghostCount, f);
@@ -82,8 +96,8 @@ bool save_game(const GameState* game, const char* path) {
             SaveGhostState state = {
                 .pos = game->ghosts[i].pos,
                 .dir = game->ghosts[i].dir,
-                .vulnerable = game->ghosts[i].vulnerable ? 1 : 0,
-                .vulnerableTimeLeft = game->ghosts[i].vulnerableTimeLeft,
+                .vulnerable = game_ghost_vulnerable(game, &game->ghosts[i]) ? 1 : 0,
+                .vulnerableTimeLeft = game_power_time_left(game),
                 .alive = game->ghosts[i].alive ? 1 : 0,
                 .moveTimer = game->ghosts[i].moveTimer
             };
@@ -91,35 +105,56 @@ bool save_game(const GameState* game, const char* path) {
         }
     }
 
-    fclose(f);
+    int counts[2] = {game->playerCount, game->humanPlayers};
+    ok = ok && write_data(counts, sizeof(int), 2, f);
+    for (int i = 0; i < game->playerCount && ok; i++) {
+        const Pacman* player = &game->players[i];
+        SavePlayerState state = {
+            .pos = player->pos,
+            .dir = player->dir,
+            .pendingDir = player->pendingDir,
+            .moveTimer = player->moveTimer,
+            .score = player->score,
+            .lives = player->lives,
+            .active = player->active ? 1 : 0
+        };
+        ok = write_data(&state, sizeof(SavePlayerState), 1, f);
+    }
+    return ok;
+}
+
+bool save_game(const GameState* game, const char* path) {
+    double start = metrics_now();
+    trace_begin("save_game");
+    FILE* f = fopen(path, "wb");
+    bool ok = f && write_save(game, f);
+    if (f) ok = fclose(f) == 0 && ok;
+    trace_end("save_game");
+    metrics_observe(METRIC_TIMER_SAVE, metrics_now() - start);
     return ok;
 }
 
 static bool allocate_map_structures(Map* map, int rows, int cols, int ghostCount, int portalCount) {
-    size_t totalCells = (size_t)rows * (size_t)cols;
-    map->rows = rows;
-    map->cols = cols;
-    map->cells = (char*)malloc(totalCells);
-    if (!map->cells) return false;
+    if (!map_alloc(map, rows, cols)) return false;
 
     map->ghostCount = ghostCount;
     map->portalCount = portalCount;
     map->ghostStarts = NULL;
     map->portals = NULL;
     if (ghostCount > 0) {
-        map->ghostStarts = (Position*)malloc(sizeof(Position) * ghostCount);
+        map->ghostStarts = (Position*)mem_alloc(MEM_TAG_MAP, sizeof(Position) * ghostCount);
         if (!map->ghostStarts) {
-            free(map->cells);
-            map->cells = NULL;
+            mem_free(map->grid);
+            map->grid = NULL;
             return false;
         }
     }
     if (portalCount > 0) {
-        map->portals = (Position*)malloc(sizeof(Position) * portalCount);
+        map->portals = (Position*)mem_alloc(MEM_TAG_MAP, sizeof(Position) * portalCount);
         if (!map->portals) {
-            free(map->cells);
-            map->cells = NULL;
-            free(map->ghostStarts);
+            mem_free(map->grid);
+            map->grid = NULL;
+            mem_free(map->ghostStarts);
             map->ghostStarts = NULL;
             return false;
         }
@@ -127,29 +162,23 @@ static bool allocate_map_structures(Map* map, int rows, int cols, int ghostCount
     return true;
 }
 
-bool load_game(GameState* game, const char* path) {
-    FILE* f = fopen(path, "rb");
-    if (!f) return false;
-
+static bool read_save(GameState* game, FILE* f) {
     SaveHeader header;
     bool ok = read_data(&header, sizeof(SaveHeader), 1, f);
-    if (!ok) {
-        fclose(f);
-        return false;
-    }
+    if (!ok) return false;
 
     map_free(&game->map);
-    free(game->ghosts);
+    mem_free(game->ghosts);
     game->ghosts = NULL;
 
     if (!allocate_map_structures(&game->map, header.mapRows, header.mapCols,
                                  header.ghostCount, header.portalCount)) {
-        fclose(f);
         return false;
     }
 
-    size_t totalCells = (size_t)header.mapRows * (size_t)header.mapCols;
-    ok = read_data(game->map.cells, sizeof(char), totalCells, f);
+    for (int row = 0; row < header.mapRows && ok; row++) {
+        ok = read_data(map_row(&game->map, row), sizeof(char), (size_t)header.mapCols, f);
+    }
     if (ok && header.ghostCount > 0) {
         ok = read_data(game->map.ghostStarts, sizeof(Position), header.ghostCount, f);
     }
@@ -158,32 +187,29 @@ bool load_game(GameState* game, const char* path) {
     }
 
     if (!ok) {
-        fclose(f);
         map_free(&game->map);
         return false;
     }
 
     game->ghostCount = header.ghostCount;
     if (game->ghostCount > 0) {
-        game->ghosts = (Ghost*)malloc(sizeof(Ghost) * game->ghostCount);
+        game->ghosts = (Ghost*)mem_alloc(MEM_TAG_ENTITIES, sizeof(Ghost) * game->ghostCount);
         if (!game->ghosts) {
-            fclose(f);
             map_free(&game->map);
             return false;
         }
         for (int i = 0; i < game->ghostCount; i++) {
             SaveGhostState state;
             if (!read_data(&state, sizeof(SaveGhostState), 1, f)) {
-                fclose(f);
                 map_free(&game->map);
-                free(game->ghosts);
+                mem_free(game->ghosts);
                 game->ghosts = NULL;
                 return false;
             }
             game->ghosts[i].pos = state.pos;
+            game->ghosts[i].prevPos = state.pos;
             game->ghosts[i].dir = state.dir;
-            game->ghosts[i].vulnerable = state.vulnerable;
-            game->ghosts[i].vulnerableTimeLeft = state.vulnerableTimeLeft;
+            game->ghosts[i].strategy = ghost_default_strategy(i);
             game->ghosts[i].alive = state.alive;
             game->ghosts[i].moveTimer = state.moveTimer;
         }
@@ -191,7 +217,39 @@ bool load_game(GameState* game, const char* path) {
         game->ghosts = NULL;
     }
 
-    fclose(f);
+    Pacman* players = game->players;
+    memset(players, 0, sizeof(game->players));
+    players[0].pos = header.pacmanPos;
+    players[0].dir = header.pacmanDir;
+    players[0].pendingDir = header.pacmanPending;
+    players[0].moveTimer = header.pacmanMoveTimer;
+    players[0].score = header.score;
+    players[0].lives = header.lives;
+    players[0].active = true;
+    game->playerCount = 1;
+    game->humanPlayers = 1;
+    int counts[2];
+    if (read_data(counts, sizeof(int), 2, f) && counts[0] >= 1 && counts[0] <= GAME_MAX_PLAYERS &&
+        counts[1] >= 0 && counts[1] <= counts[0]) {
+        for (int i = 0; i < counts[0]; i++) {
+            SavePlayerState state;
+            if (!read_data(&state, sizeof(SavePlayerState), 1, f)) break;
+            players[i].pos = state.pos;
+            players[i].dir = state.dir;
+            players[i].pendingDir = state.pendingDir;
+            players[i].moveTimer = state.moveTimer;
+            players[i].score = state.score;
+            players[i].lives = state.lives;
+            players[i].active = state.active != 0;
+            game->playerCount = i + 1;
+        }
+        game->humanPlayers = counts[1] < game->playerCount ? counts[1] : game->playerCount;
+    }
+    game->activePlayers = 0;
+    for (int i = 0; i < game->playerCount; i++) {
+        players[i].prevPos = players[i].pos;
+        if (players[i].active) game->activePlayers++;
+    }
 
     game->map.pacmanStart = header.pacmanStart;
     game->map.pelletsRemaining = header.pelletsRemaining;
@@ -200,23 +258,33 @@ bool load_game(GameState* game, const char* path) {
     game->level = header.level;
     game->score = header.score;
     game->lives = header.lives;
-    game->pacman.pos = header.pacmanPos;
-    game->pacman.dir = header.pacmanDir;
-    game->pacman.pendingDir = header.pacmanPending;
-    game->pacman.powered = header.pacmanPowered != 0;
-    game->pacman.powerTimeLeft = header.pacmanPowerTimeLeft;
-    game->pacman.moveTimer = header.pacmanMoveTimer;
+    game_set_power(game, header.pacmanPowered != 0, header.pacmanPowerTimeLeft);
     game->pelletsRemaining = header.pelletsRemaining;
+    game->mapRevision = game_new_map_revision();
+    path_service_reset(&game->paths, &game->map);
+    chunk_grid_reset(&game->chunks, &game->map, game->ghosts, game->ghostCount);
+    entity_store_reset(&game->entities, &game->map, game->ghosts, game->ghostCount,
+                       game->players, game->playerCount);
+    path_service_limit_depth(&game->paths, chunk_grid_path_depth(&game->chunks));
     snprintf(game->currentMapPath, sizeof(game->currentMapPath), "%s", header.currentMapPath);
+    game->hash = zobrist_hash(game);
 
     game->running = true;
     game->paused = false;
     game->phase = GAME_PHASE_PLAYING;
     game->hudMessage[0] = '\0';
-    game->hudMessageTimer = 0.0f;
     game->menu.status = MENU_HIDDEN;
     game->menu.pendingAction = MENU_ACTION_NONE;
     game->menu.selectedIndex = 0;
 
     return true;
 }
+
+bool load_game(GameState* game, const char* path) {
+    trace_begin("load_game");
+    FILE* f = fopen(path, "rb");
+    bool ok = f && read_save(game, f);
+    if (f) fclose(f);
+    trace_end("load_game");
+    return ok;
+}
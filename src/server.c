@@ -0,0 +1,354 @@
+#include "server.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SERVER_MAX_PACKETS_PER_TICK 8192
+#define SERVER_MAX_LATE_TICKS 5
+
+static void sleep_until(double deadline) {
+    double remaining = deadline - input_timestamp();
+    if (remaining <= 0.0) return;
+    struct timespec ts;
+    ts.tv_sec = (time_t)remaining;
+    ts.tv_nsec = (long)((remaining - (double)ts.tv_sec) * 1e9);
+    nanosleep(&ts, NULL);
+}
+
+bool server_init(GameServer* server, uint16_t port, int roomCount, int threads, const char* rankingPath) {
+    memset(server, 0, sizeof(*server));
+    atomic_init(&server->packetsOut, 0);
+    if (roomCount <= 0 || roomCount > SERVER_MAX_ROOMS) return false;
+    snprintf(server->rankingPath, sizeof(server->rankingPath), "%s",
+             rankingPath ? rankingPath : SERVER_RANKING_PATH);
+    ranking_load(&server->ranking, server->rankingPath);
+
+    server->rooms = (ServerRoom*)calloc((size_t)roomCount, sizeof(ServerRoom));
+    server->active = (int*)calloc((size_t)roomCount, sizeof(int));
+    if (!server->rooms || !server->active) {
+        server_shutdown(server);
+        return false;
+    }
+    server->roomCount = roomCount;
+
+    if (threads <= 0) threads = thread_pool_cpu_count();
+    server->threads = threads;
+    server->poolReady = true;
+    if (!thread_pool_init(&server->pool, threads - 1) || !net_startup()) {
+        server_shutdown(server);
+        return false;
+    }
+    if (!net_open(&server->socket, port)) {
+        server_shutdown(server);
+        return false;
+    }
+    return true;
+}
+
+void server_shutdown(GameServer* server) {
+    net_close(&server->socket);
+    if (server->poolReady) thread_pool_destroy(&server->pool);
+    server->poolReady = false;
+    for (int i = 0; i < server->roomCount; i++) {
+        if (server->rooms[i].ready) game_shutdown(&server->rooms[i].game);
+    }
+    free(server->rooms);
+    free(server->active);
+    server->rooms = NULL;
+    server->active = NULL;
+    server->roomCount = 0;
+    net_cleanup();
+}
+
+int server_active_rooms(const GameServer* server) {
+    int count = 0;
+    for (int i = 0; i < server->roomCount; i++) {
+        if (server->rooms[i].occupied) count++;
+    }
+    return count;
+}
+
+static void send_packet(GameServer* server, const NetAddress* to, const void* data, size_t size) {
+    if (net_send(&server->socket, to, data, size)) {
+        atomic_fetch_add_explicit(&server->packetsOut, 1, memory_order_relaxed);
+    }
+}
+
+static void send_header(GameServer* server, const NetAddress* to, NetMessageType type) {
+    NetHeader header;
+    net_header_init(&header, type);
+    send_packet(server, to, &header, sizeof(header));
+}
+
+static void send_map(GameServer* server, ServerRoom* room) {
+    const Map* map = &room->game.map;
+    if (!map->grid) return;
+    unsigned char packet[sizeof(NetMapChunk) + NET_MAP_CHUNK];
+    NetMapChunk chunk;
+    net_header_init(&chunk.header, NET_MSG_MAP_CHUNK);
+    chunk.mapRevision = room->game.mapRevision;
+    chunk.tileChangeCount = room->game.tileChangeCount;
+    chunk.rows = map->rows;
+    chunk.cols = map->cols;
+    size_t total = (size_t)map->rows * (size_t)map->cols;
+    for (size_t offset = 0; offset < total; offset += NET_MAP_CHUNK) {
+        size_t length = total - offset < NET_MAP_CHUNK ? total - offset : NET_MAP_CHUNK;
+        chunk.offset = (uint32_t)offset;
+        chunk.length = (uint32_t)length;
+        memcpy(packet, &chunk, sizeof(chunk));
+        map_read_tiles(map, offset, (char*)packet + sizeof(chunk), length);
+        send_packet(server, &room->client, packet, sizeof(chunk) + length);
+    }
+    room->sentRevision = room->game.mapRevision;
+    room->resendMap = false;
+}
+
+static NetTile net_tile(Position pos) {
+    return (NetTile){(int16_t)pos.row, (int16_t)pos.col};
+}
+
+static void send_state(GameServer* server, ServerRoom* room) {
+    const GameState* game = &room->game;
+    unsigned char packet[NET_MAX_PACKET];
+    NetState state;
+    memset(&state, 0, sizeof(state));
+    net_header_init(&state.header, NET_MSG_STATE);
+    state.tick = server->tick;
+    state.mapRevision = game->mapRevision;
+    state.tileChangeCount = game->tileChangeCount;
+    state.score = game->players[0].score;
+    state.lives = game->players[0].lives;
+    state.level = game->level;
+    state.phase = game->phase;
+    state.pacman = net_tile(game->players[0].pos);
+    state.pacmanDir = (int8_t)game->players[0].dir;
+    state.powered = game->powered ? 1 : 0;
+    int ghostTotal = game->ghosts ? game->ghostCount : 0;
+    int ghostCount = ghostTotal > NET_MAX_GHOSTS ? NET_MAX_GHOSTS : ghostTotal;
+    uint32_t tileCount = game->tileChangeCount < NET_MAX_TILE_CHANGES ? game->tileChangeCount : NET_MAX_TILE_CHANGES;
+    state.ghostCount = (uint16_t)ghostCount;
+    state.ghostTotal = (uint16_t)(ghostTotal > UINT16_MAX ? UINT16_MAX : ghostTotal);
+    state.tileCount = (uint16_t)tileCount;
+
+    size_t size = sizeof(state);
+    memcpy(packet, &state, sizeof(state));
+    for (int i = 0; i < ghostCount; i++) {
+        const Ghost* ghost = &game->ghosts[i];
+        NetGhost out = {
+            .pos = net_tile(ghost->pos),
+            .alive = ghost->alive ? 1 : 0,
+            .vulnerable = game_ghost_vulnerable(game, ghost) ? 1 : 0
+        };
+        memcpy(packet + size, &out, sizeof(out));
+        size += sizeof(out);
+    }
+    for (uint32_t i = game->tileChangeCount - tileCount; i < game->tileChangeCount; i++) {
+        NetTile tile = net_tile(game->tileChanges[i % GAME_TILE_LOG_SIZE]);
+        memcpy(packet + size, &tile, sizeof(tile));
+        size += sizeof(tile);
+    }
+    send_packet(server, &room->client, packet, size);
+}
+
+static ServerRoom* room_for(GameServer* server, int index, const NetAddress* from) {
+    if (index < 0 || index >= server->roomCount) return NULL;
+    ServerRoom* room = &server->rooms[index];
+    if (!room->occupied || !net_address_equal(&room->client, from)) return NULL;
+    return room;
+}
+
+static void send_welcome(GameServer* server, int index) {
+    NetWelcome welcome;
+    net_header_init(&welcome.header, NET_MSG_WELCOME);
+    welcome.room = index;
+    welcome.tickRate = SIM_TICK_RATE;
+    send_packet(server, &server->rooms[index].client, &welcome, sizeof(welcome));
+}
+
+static void start_room_game(ServerRoom* room) {
+    input_clear(&room->game.input);
+    game_start_new(&room->game);
+    room->input = DIR_NONE;
+    room->finished = false;
+    room->gamesPlayed++;
+}
+
+static void handle_hello(GameServer* server, const NetAddress* from, const NetHello* hello) {
+    int chosen = -1;
+    for (int i = 0; i < server->roomCount; i++) {
+        if (server->rooms[i].occupied && net_address_equal(&server->rooms[i].client, from)) {
+            send_welcome(server, i);
+            return;
+        }
+    }
+    if (hello->room >= 0 && hello->room < server->roomCount && !server->rooms[hello->room].occupied) {
+        chosen = hello->room;
+    }
+    for (int i = 0; i < server->roomCount && chosen < 0 && hello->room == NET_ROOM_ANY; i++) {
+        if (!server->rooms[i].occupied) chosen = i;
+    }
+    if (chosen < 0) {
+        send_header(server, from, NET_MSG_FULL);
+        return;
+    }
+
+    ServerRoom* room = &server->rooms[chosen];
+    if (!room->ready) {
+        if (!game_init(&room->game, SERVER_FIRST_MAP_PATH, 0)) {
+            game_shutdown(&room->game);
+            send_header(server, from, NET_MSG_FULL);
+            return;
+        }
+        room->ready = true;
+    }
+    game_set_players(&room->game, 1 + server->botsPerRoom, 1);
+    game_seed(&room->game, (uint32_t)time(NULL) ^ ((uint32_t)chosen * 0x9E3779B9u));
+    room->occupied = true;
+    room->client = *from;
+    memcpy(room->name, hello->name, RANKING_NAME_LEN);
+    room->name[RANKING_NAME_LEN - 1] = '\0';
+    if (room->name[0] == '\0') snprintf(room->name, sizeof(room->name), "SALA%d", chosen + 1);
+    room->inputSeq = 0;
+    room->lastSeen = server->now;
+    room->sentRevision = 0;
+    start_room_game(room);
+    send_welcome(server, chosen);
+}
+
+static void handle_packet(GameServer* server, const NetAddress* from, const unsigned char* data, int size) {
+    int type = net_message_type(data, (size_t)size);
+    switch (type) {
+        case NET_MSG_HELLO: {
+            NetHello hello;
+            memcpy(&hello, data, sizeof(hello));
+            handle_hello(server, from, &hello);
+            break;
+        }
+        case NET_MSG_INPUT: {
+            NetInput input;
+            memcpy(&input, data, sizeof(input));
+            ServerRoom* room = room_for(server, input.room, from);
+            if (!room) break;
+            room->lastSeen = server->now;
+            // UDP pode reordenar: entradas mais antigas que a ultima aplicada sao descartadas.
+            if ((int32_t)(input.seq - room->inputSeq) < 0) break;
+            room->inputSeq = input.seq;
+            if (input.dir >= DIR_NONE && input.dir <= DIR_RIGHT) room->input = (Direction)input.dir;
+            break;
+        }
+        case NET_MSG_BYE:
+        case NET_MSG_MAP_REQUEST: {
+            NetRoomRequest request;
+            memcpy(&request, data, sizeof(request));
+            ServerRoom* room = room_for(server, request.room, from);
+            if (!room) break;
+            room->lastSeen = server->now;
+            if (type == NET_MSG_BYE) room->occupied = false;
+            else room->resendMap = true;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void receive_packets(GameServer* server) {
+    unsigned char buffer[NET_MAX_PACKET];
+    NetAddress from;
+    for (int i = 0; i < SERVER_MAX_PACKETS_PER_TICK; i++) {
+        int size = net_receive(&server->socket, &from, buffer, sizeof(buffer));
+        if (size <= 0) break;
+        server->packetsIn++;
+        handle_packet(server, &from, buffer, size);
+    }
+}
+
+static void step_room(void* ctx, int index) {
+    GameServer* server = (GameServer*)ctx;
+    ServerRoom* room = &server->rooms[server->active[index]];
+    GameState* game = &room->game;
+    trace_begin("step_room");
+    if (room->input != DIR_NONE) {
+        game->players[0].pendingDir = room->input;
+        game->players[0].pendingTime = 0.0;
+    }
+    game_update(game, SIM_TICK_DT);
+    // O jogo da sala acaba quando o cliente perde, mesmo com bots em jogo.
+    room->finished = !game->running || game->phase != GAME_PHASE_PLAYING || !game->players[0].active;
+    if (room->resendMap || room->sentRevision != game->mapRevision) send_map(server, room);
+    send_state(server, room);
+    trace_end("step_room");
+}
+
+// Jogos encerrados entram no ranking central com o nome do cliente e a
+// sala recomeca; feito fora do pool para o ranking nao precisar de lock.
+static void finish_games(GameServer* server) {
+    bool dirty = false;
+    for (int k = 0; k < server->activeCount; k++) {
+        ServerRoom* room = &server->rooms[server->active[k]];
+        if (!room->finished) continue;
+        int score = room->game.players[0].score;
+        if (ranking_position_for_score(&server->ranking, score) >= 0) {
+            ranking_insert(&server->ranking, room->name, score);
+            dirty = true;
+        }
+        start_room_game(room);
+    }
+    if (dirty) ranking_save(&server->ranking, server->rankingPath);
+}
+
+void server_tick(GameServer* server, double now) {
+    server->now = now;
+    server->tick++;
+    receive_packets(server);
+
+    server->activeCount = 0;
+    for (int i = 0; i < server->roomCount; i++) {
+        ServerRoom* room = &server->rooms[i];
+        if (!room->occupied) continue;
+        if (now - room->lastSeen > SERVER_CLIENT_TIMEOUT) {
+            room->occupied = false;
+            continue;
+        }
+        server->active[server->activeCount++] = i;
+    }
+    if (server->activeCount == 0) return;
+
+    double start = input_timestamp();
+    thread_pool_for(&server->pool, server->activeCount, step_room, server);
+    server->stepSeconds += input_timestamp() - start;
+    server->roomTicks += (unsigned long long)server->activeCount;
+    finish_games(server);
+}
+
+void server_run(GameServer* server, atomic_bool* quit, double statsSeconds) {
+    double next = input_timestamp();
+    double statsAt = next + statsSeconds;
+    double lastStep = 0.0;
+    unsigned long long lastRoomTicks = 0;
+    while (!atomic_load_explicit(quit, memory_order_relaxed)) {
+        sleep_until(next);
+        double now = input_timestamp();
+        server_tick(server, now);
+        next += SIM_TICK_DT;
+        if (now - next > SERVER_MAX_LATE_TICKS * SIM_TICK_DT) next = now;
+
+        if (statsSeconds > 0.0 && now >= statsAt) {
+            double step = server->stepSeconds - lastStep;
+            unsigned long long roomTicks = server->roomTicks - lastRoomTicks;
+            // Custo de CPU por sala-tick (tempo de parede do passo x threads)
+            // convertido em quantas salas um nucleo sustenta a SIM_TICK_RATE.
+            double perRoomTick = roomTicks > 0 ? step * server->threads / (double)roomTicks : 0.0;
+            double roomsPerCore = perRoomTick > 0.0 ? SIM_TICK_DT / perRoomTick : 0.0;
+            printf("salas ativas: %d, %.3f ms por sala-tick, ~%.0f salas por nucleo, pacotes %llu in / %llu out\n",
+                   server_active_rooms(server), perRoomTick * 1000.0, roomsPerCore, server->packetsIn,
+                   (unsigned long long)atomic_load_explicit(&server->packetsOut, memory_order_relaxed));
+            fflush(stdout);
+            lastStep = server->stepSeconds;
+            lastRoomTicks = server->roomTicks;
+            statsAt = now + statsSeconds;
+        }
+    }
+}
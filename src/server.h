@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "game.h"
+#include "net.h"
+#include "ranking.h"
+#include "threadpool.h"
+
+#define SERVER_MAX_ROOMS 1024
+#define SERVER_CLIENT_TIMEOUT 5.0
+#define SERVER_FIRST_MAP_PATH "assets/maps/mapa1.txt"
+#define SERVER_RANKING_PATH "ranking_servidor.dat"
+
+// Uma sala = um gabinete: um GameState com dono autoritativo no servidor,
+// um cliente (endereco UDP) que so manda direcoes e recebe estado.
+typedef struct {
+    GameState game;
+    bool ready;
+    bool occupied;
+    bool finished;
+    NetAddress client;
+    char name[RANKING_NAME_LEN];
+    Direction input;
+    uint32_t inputSeq;
+    double lastSeen;
+    uint32_t sentRevision;
+    bool resendMap;
+    unsigned int gamesPlayed;
+} ServerRoom;
+
+// Servidor de salas: a cada tick fixo le todos os pacotes pendentes, avanca
+// as salas ocupadas em paralelo no ThreadPool (cada sala manda o proprio
+// estado) e, de volta na thread do servidor, registra no ranking central os
+// jogos que terminaram e os reinicia.
+typedef struct {
+    NetSocket socket;
+    ServerRoom* rooms;
+    int roomCount;
+    int* active;
+    int activeCount;
+    ThreadPool pool;
+    bool poolReady;
+    int threads;
+    int botsPerRoom;      // jogadores automaticos somados ao cliente em cada sala
+    Ranking ranking;
+    char rankingPath[128];
+    uint32_t tick;
+    double now;
+    double stepSeconds;
+    unsigned long long roomTicks;
+    unsigned long long packetsIn;
+    atomic_ullong packetsOut;
+} GameServer;
+
+bool server_init(GameServer* server, uint16_t port, int roomCount, int threads, const char* rankingPath);
+void server_shutdown(GameServer* server);
+void server_tick(GameServer* server, double now);
+// Roda server_tick a SIM_TICK_RATE ate *quit virar true; a cada
+// statsSeconds (> 0) imprime salas ativas e salas por nucleo.
+void server_run(GameServer* server, atomic_bool* quit, double statsSeconds);
+int server_active_rooms(const GameServer* server);
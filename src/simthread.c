@@ -0,0 +1,304 @@
+#include "simthread.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SNAPSHOT_FRESH 0x80000000u
+
+static void sleep_until(double deadline) {
+    double remaining = deadline - input_timestamp();
+    if (remaining <= 0.0) return;
+    struct timespec ts;
+    ts.tv_sec = (time_t)remaining;
+    ts.tv_nsec = (long)((remaining - (double)ts.tv_sec) * 1e9);
+    nanosleep(&ts, NULL);
+}
+
+static void snapshot_capture(RenderSnapshot* snap, const GameState* game) {
+    size_t gridSize = game->map.grid ? map_grid_size(&game->map) : 0;
+    if (gridSize > snap->gridCapacity) {
+        char* grid = (char*)mem_realloc(MEM_TAG_MAP, snap->grid, gridSize);
+        if (grid) {
+            snap->grid = grid;
+            snap->gridCapacity = gridSize;
+        }
+    }
+    int ghostCount = game->ghosts ? game->ghostCount : 0;
+    if (ghostCount > snap->ghostCapacity) {
+        Ghost* ghosts = (Ghost*)mem_realloc(MEM_TAG_ENTITIES, snap->ghosts, sizeof(Ghost) * (size_t)ghostCount);
+        if (ghosts) {
+            snap->ghosts = ghosts;
+            snap->ghostCapacity = ghostCount;
+        }
+    }
+
+    // Campo a campo, so o que render.c e o laco da janela leem: a fila de
+    // eventos, o audio, timers, input e indices ficam fora da copia.
+    GameState* view = &snap->state;
+    view->map = game->map;
+    view->map.ghostStarts = NULL;
+    view->map.portals = NULL;
+    if (gridSize > 0 && gridSize <= snap->gridCapacity) {
+        memcpy(snap->grid, game->map.grid, gridSize);
+        view->map.grid = snap->grid;
+    } else {
+        view->map.grid = NULL;
+        view->map.rows = 0;
+        view->map.cols = 0;
+    }
+    if (ghostCount > 0 && ghostCount <= snap->ghostCapacity) {
+        memcpy(snap->ghosts, game->ghosts, sizeof(Ghost) * (size_t)ghostCount);
+        view->ghosts = snap->ghosts;
+        view->ghostCount = ghostCount;
+    } else {
+        view->ghosts = NULL;
+        view->ghostCount = 0;
+    }
+    memcpy(view->players, game->players, sizeof(Pacman) * (size_t)game->playerCount);
+    view->playerCount = game->playerCount;
+    view->powered = game->powered;
+    view->pelletsRemaining = game->pelletsRemaining;
+    view->level = game->level;
+    view->score = game->score;
+    view->lives = game->lives;
+    view->timeScale = game->timeScale;
+    view->autopilot = game->autopilot;
+    view->running = game->running;
+    view->menu = game->menu;
+    view->phase = game->phase;
+    view->postPhase = game->postPhase;
+    memcpy(view->hudMessage, game->hudMessage, sizeof(view->hudMessage));
+    view->ranking = game->ranking;
+    view->pendingRankingScore = game->pendingRankingScore;
+    view->nameEntryLen = game->nameEntryLen;
+    memcpy(view->nameEntry, game->nameEntry, sizeof(view->nameEntry));
+    snap->tickTime = game->input.tickTime;
+}
+
+static void snapshot_free(RenderSnapshot* snap) {
+    mem_free(snap->grid);
+    mem_free(snap->ghosts);
+    memset(snap, 0, sizeof(*snap));
+}
+
+// Copia os eventos desde o ultimo que a janela tocou; um snapshot que ela
+// pule nao perde nada, o seguinte leva os mesmos eventos de novo.
+static void snapshot_events(RenderSnapshot* snap, const SimThread* sim) {
+    uint64_t first = atomic_load_explicit(&sim->playedEvents, memory_order_acquire);
+    if (sim->eventSeq - first > SIM_SNAPSHOT_EVENTS) first = sim->eventSeq - SIM_SNAPSHOT_EVENTS;
+    snap->firstEvent = first;
+    snap->eventCount = (int)(sim->eventSeq - first);
+    for (int i = 0; i < snap->eventCount; i++) {
+        snap->events[i] = sim->recentEvents[(first + (uint64_t)i) % SIM_SNAPSHOT_EVENTS];
+    }
+}
+
+static void publish_snapshot(SimThread* sim) {
+    snapshot_capture(&sim->snapshots[sim->back], sim->game);
+    snapshot_events(&sim->snapshots[sim->back], sim);
+    unsigned int previous = atomic_exchange_explicit(&sim->middle, sim->back | SNAPSHOT_FRESH,
+                                                     memory_order_acq_rel);
+    sim->back = previous & ~SNAPSHOT_FRESH;
+}
+
+static void drain_events(SimThread* sim) {
+    GameEvent drained[SIM_SNAPSHOT_EVENTS];
+    int count = game_drain_events(sim->game, drained, SIM_SNAPSHOT_EVENTS);
+    for (int i = 0; i < count; i++) {
+        sim->recentEvents[sim->eventSeq % SIM_SNAPSHOT_EVENTS] = drained[i];
+        sim->eventSeq++;
+    }
+}
+
+static void take_input(SimThread* sim, double tickTime) {
+    GameInput* pending = &sim->pendingInput;
+    pthread_mutex_lock(&sim->inputLock);
+    sim->game->input = *pending;
+    memset(pending->pressed, 0, sizeof(pending->pressed));
+    pending->charCount = 0;
+    pending->charRead = 0;
+    pending->eventCount = 0;
+    pending->eventRead = 0;
+    pthread_mutex_unlock(&sim->inputLock);
+    sim->game->input.tickTime = tickTime;
+}
+
+static void record_tick(SimThread* sim) {
+    size_t bound = stream_frame_bound(sim->game);
+    if (bound > sim->streamCapacity) {
+        uint8_t* buffer = (uint8_t*)realloc(sim->streamBuffer, bound);
+        if (!buffer) return;
+        sim->streamBuffer = buffer;
+        sim->streamCapacity = bound;
+    }
+    size_t size = stream_encode(&sim->stream, sim->game, sim->streamBuffer, sim->streamCapacity);
+    if (size > 0 && !stream_write_frame(sim->record, sim->streamBuffer, size)) {
+        sim->record = NULL;
+    }
+}
+
+// Uma recarga de outro arquivo (o nivel mudou enquanto o vigia lia) e
+// descartada.
+static bool apply_map_reload(SimThread* sim) {
+    char path[HOT_RELOAD_PATH_LEN];
+    game_map_source(sim->game, path, sizeof(path));
+    if (strcmp(path, sim->watchedPath) != 0) {
+        memcpy(sim->watchedPath, path, sizeof(path));
+        map_watcher_watch(sim->watcher, path);
+    }
+    MapReload* reload = map_watcher_take(sim->watcher);
+    if (!reload) return false;
+    bool current = strcmp(reload->path, path) == 0;
+    if (current) game_swap_map(sim->game, &reload->map, reload->path);
+    map_reload_free(reload);
+    return current;
+}
+
+static void* sim_thread_main(void* arg) {
+    SimThread* sim = (SimThread*)arg;
+    trace_thread_name("simulacao");
+    double previous = input_timestamp();
+    double accumulator = 0.0;
+    while (!atomic_load(&sim->quit) && sim->game->running) {
+        double now = input_timestamp();
+        float scale = atomic_load(&sim->timeScale);
+        accumulator += (now - previous) * scale;
+        previous = now;
+        if (accumulator > SIM_MAX_DEBT_TICKS * SIM_TICK_DT) {
+            accumulator = SIM_MAX_DEBT_TICKS * SIM_TICK_DT;
+        }
+
+        bool reloaded = sim->watcher && apply_map_reload(sim);
+
+        // Orcamento por quadro: o que sobrar fica no acumulador para os
+        // proximos quadros em vez de travar a thread num unico laco.
+        int ticks = 0;
+        double budgetEnd = now + SIM_FRAME_BUDGET_SECONDS;
+        while (accumulator >= SIM_TICK_DT && sim->game->running && ticks < SIM_MAX_TICKS_PER_FRAME) {
+            accumulator -= SIM_TICK_DT;
+            take_input(sim, now - accumulator / scale);
+            sim->game->timeScale = scale;
+            if (sim->autopilot) autopilot_drive(sim->autopilot, sim->game);
+            game_update(sim->game, SIM_TICK_DT);
+            drain_events(sim);
+            if (sim->record) {
+                trace_begin("record_tick");
+                record_tick(sim);
+                trace_end("record_tick");
+            }
+            ticks++;
+            if (input_timestamp() >= budgetEnd) break;
+        }
+        if (ticks > 0 || reloaded) {
+            trace_begin("publish_snapshot");
+            publish_snapshot(sim);
+            trace_end("publish_snapshot");
+        }
+        if (accumulator < SIM_TICK_DT) {
+            sleep_until(now + (SIM_TICK_DT - accumulator) / scale);
+        }
+    }
+    publish_snapshot(sim);
+    return NULL;
+}
+
+bool sim_thread_start(SimThread* sim, GameState* game, Autopilot* autopilot, MapWatcher* watcher,
+                      FILE* record) {
+    memset(sim->snapshots, 0, sizeof(sim->snapshots));
+    sim->game = game;
+    sim->autopilot = autopilot;
+    sim->watcher = watcher;
+    sim->watchedPath[0] = '\0';
+    sim->record = record;
+    stream_encoder_init(&sim->stream, STREAM_KEYFRAME_INTERVAL);
+    sim->streamBuffer = NULL;
+    sim->streamCapacity = 0;
+    for (unsigned int i = 0; i < SIM_SNAPSHOT_COUNT; i++) {
+        snapshot_capture(&sim->snapshots[i], game);
+    }
+    sim->front = 0;
+    sim->eventSeq = 0;
+    atomic_init(&sim->playedEvents, 0);
+    atomic_init(&sim->middle, 1u);
+    sim->back = 2;
+    input_clear(&sim->pendingInput);
+    atomic_init(&sim->quit, false);
+    atomic_init(&sim->timeScale, 1.0f);
+    sim->started = false;
+    if (pthread_mutex_init(&sim->inputLock, NULL) != 0) return false;
+    if (pthread_create(&sim->thread, NULL, sim_thread_main, sim) != 0) {
+        pthread_mutex_destroy(&sim->inputLock);
+        return false;
+    }
+    sim->started = true;
+    return true;
+}
+
+void sim_thread_stop(SimThread* sim) {
+    if (sim->started) {
+        atomic_store(&sim->quit, true);
+        pthread_join(sim->thread, NULL);
+        pthread_mutex_destroy(&sim->inputLock);
+        sim->started = false;
+    }
+    for (unsigned int i = 0; i < SIM_SNAPSHOT_COUNT; i++) {
+        snapshot_free(&sim->snapshots[i]);
+    }
+    stream_encoder_free(&sim->stream);
+    free(sim->streamBuffer);
+    sim->streamBuffer = NULL;
+    sim->streamCapacity = 0;
+}
+
+void sim_thread_post_input(SimThread* sim, const GameInput* input) {
+    pthread_mutex_lock(&sim->inputLock);
+    input_merge(&sim->pendingInput, input);
+    pthread_mutex_unlock(&sim->inputLock);
+}
+
+void sim_thread_set_time_scale(SimThread* sim, float scale) {
+    if (scale < SIM_TIME_SCALE_MIN) scale = SIM_TIME_SCALE_MIN;
+    if (scale > SIM_TIME_SCALE_MAX) scale = SIM_TIME_SCALE_MAX;
+    atomic_store(&sim->timeScale, scale);
+}
+
+float sim_thread_time_scale(SimThread* sim) {
+    return atomic_load(&sim->timeScale);
+}
+
+const GameState* sim_thread_acquire(SimThread* sim, float* alpha) {
+    if (atomic_load_explicit(&sim->middle, memory_order_acquire) & SNAPSHOT_FRESH) {
+        unsigned int previous = atomic_exchange_explicit(&sim->middle, sim->front, memory_order_acq_rel);
+        sim->front = previous & ~SNAPSHOT_FRESH;
+    }
+    const RenderSnapshot* snap = &sim->snapshots[sim->front];
+    const GameState* view = &snap->state;
+    if (alpha) {
+        // Na escala em que o tick publicado rodou, o proximo chega
+        // SIM_TICK_DT / timeScale segundos reais depois dele.
+        double scale = view->timeScale > 0.0f ? view->timeScale : 1.0;
+        float t = (float)((input_timestamp() - snap->tickTime) * scale / SIM_TICK_DT);
+        if (t < 0.0f) t = 0.0f;
+        if (t > 1.0f) t = 1.0f;
+        *alpha = t;
+    }
+    return view;
+}
+
+int sim_thread_take_events(SimThread* sim, const GameEvent** events) {
+    const RenderSnapshot* snap = &sim->snapshots[sim->front];
+    uint64_t played = atomic_load_explicit(&sim->playedEvents, memory_order_relaxed);
+    uint64_t end = snap->firstEvent + (uint64_t)snap->eventCount;
+    if (end <= played) return 0;
+    uint64_t start = played;
+    if (snap->firstEvent > played) {
+        metrics_add(METRIC_GAME_EVENTS_DROPPED, snap->firstEvent - played);
+        start = snap->firstEvent;
+    }
+    atomic_store_explicit(&sim->playedEvents, end, memory_order_release);
+    *events = snap->events + (start - snap->firstEvent);
+    return (int)(end - start);
+}
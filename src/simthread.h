@@ -0,0 +1,75 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "autopilot.h"
+#include "game.h"
+#include "hotreload.h"
+#include "statestream.h"
+
+#define SIM_SNAPSHOT_COUNT 3
+#define SIM_MAX_TICKS_PER_FRAME 128
+#define SIM_MAX_DEBT_TICKS (SIM_MAX_TICKS_PER_FRAME * 4)
+#define SIM_FRAME_BUDGET_SECONDS 0.012
+#define SIM_SNAPSHOT_EVENTS EVENT_RING_SIZE
+
+// Vista para desenho: state so tem os campos que game_draw le (o resto
+// fica zerado) e map.grid e ghosts apontam para os buffers do proprio
+// snapshot, nunca para a memoria da simulacao. events leva os eventos que
+// a janela ainda nao tinha tocado quando o snapshot foi publicado, a
+// partir do numero de sequencia firstEvent.
+typedef struct {
+    GameState state;
+    double tickTime;
+    char* grid;
+    size_t gridCapacity;
+    Ghost* ghosts;
+    int ghostCapacity;
+    uint64_t firstEvent;
+    int eventCount;
+    GameEvent events[SIM_SNAPSHOT_EVENTS];
+} RenderSnapshot;
+
+// Simulacao em thread propria com passo fixo, consumindo um acumulador de
+// tempo real. Os snapshots circulam em triple buffer: a simulacao escreve
+// em back, o desenho le de front e os dois trocam de indice com middle
+// por atomic_exchange. Os eventos de cada tick vao para recentEvents com
+// numero de sequencia; a janela devolve em playedEvents ate onde tocou.
+typedef struct {
+    GameState* game;
+    Autopilot* autopilot;
+    MapWatcher* watcher;
+    char watchedPath[HOT_RELOAD_PATH_LEN];
+    RenderSnapshot snapshots[SIM_SNAPSHOT_COUNT];
+    atomic_uint middle;
+    unsigned int back;
+    unsigned int front;
+    GameEvent recentEvents[SIM_SNAPSHOT_EVENTS];
+    uint64_t eventSeq;
+    atomic_uint_fast64_t playedEvents;
+    pthread_mutex_t inputLock;
+    GameInput pendingInput;
+    _Atomic float timeScale;
+    atomic_bool quit;
+    pthread_t thread;
+    bool started;
+    FILE* record;
+    StreamEncoder stream;
+    uint8_t* streamBuffer;
+    size_t streamCapacity;
+} SimThread;
+
+// autopilot, watcher e record podem ser NULL. Com record, cada tick grava
+// um quadro de statestream.h no arquivo. Com watcher, a simulacao aponta o
+// vigia para o arquivo do nivel atual e aplica as recargas entre ticks.
+bool sim_thread_start(SimThread* sim, GameState* game, Autopilot* autopilot, MapWatcher* watcher,
+                      FILE* record);
+void sim_thread_stop(SimThread* sim);
+void sim_thread_post_input(SimThread* sim, const GameInput* input);
+void sim_thread_set_time_scale(SimThread* sim, float scale);
+float sim_thread_time_scale(SimThread* sim);
+const GameState* sim_thread_acquire(SimThread* sim, float* alpha);
+// Eventos do snapshot atual que a janela ainda nao tocou; cada um sai uma
+// vez so, na ordem em que a simulacao os emitiu.
+int sim_thread_take_events(SimThread* sim, const GameEvent** events);
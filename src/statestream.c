@@ -0,0 +1,629 @@
+#include "statestream.h"
+#include "memtrack.h"
+#include "zobrist.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STREAM_FLAG_POWERED 0x01
+#define STREAM_FLAG_AUTOPILOT 0x02
+#define STREAM_FLAG_PAUSED 0x04
+#define STREAM_MAX_CELLS (1u << 26)
+
+typedef enum {
+    DELTA_PLAYERS = 1 << 0,
+    DELTA_GHOSTS = 1 << 1,
+    DELTA_TILES = 1 << 2,
+    DELTA_SCORE = 1 << 3,
+    DELTA_LIVES = 1 << 4,
+    DELTA_LEVEL = 1 << 5,
+    DELTA_PHASE = 1 << 6,
+    DELTA_FLAGS = 1 << 7,
+    DELTA_PELLETS = 1 << 8,
+    DELTA_MESSAGE = 1 << 9
+} DeltaField;
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+    bool overflow;
+} Writer;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    bool bad;
+} Reader;
+
+static void put_byte(Writer* w, uint8_t value) {
+    if (w->size >= w->capacity) {
+        w->overflow = true;
+        return;
+    }
+    w->data[w->size++] = value;
+}
+
+static void put_varint(Writer* w, uint64_t value) {
+    while (value >= 0x80) {
+        put_byte(w, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    put_byte(w, (uint8_t)value);
+}
+
+static void put_signed(Writer* w, int64_t value) {
+    put_varint(w, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static void put_bytes(Writer* w, const void* data, size_t size) {
+    if (w->size + size > w->capacity) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->data + w->size, data, size);
+    w->size += size;
+}
+
+static uint8_t get_byte(Reader* r) {
+    if (r->pos >= r->size) {
+        r->bad = true;
+        return 0;
+    }
+    return r->data[r->pos++];
+}
+
+static uint64_t get_varint(Reader* r) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = get_byte(r);
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    r->bad = true;
+    return 0;
+}
+
+static int64_t get_signed(Reader* r) {
+    uint64_t value = get_varint(r);
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static const uint8_t* get_bytes(Reader* r, size_t size) {
+    if (r->pos + size > r->size) {
+        r->bad = true;
+        return NULL;
+    }
+    const uint8_t* data = r->data + r->pos;
+    r->pos += size;
+    return data;
+}
+
+static uint8_t state_flags(const GameState* game) {
+    uint8_t flags = 0;
+    if (game->powered) flags |= STREAM_FLAG_POWERED;
+    if (game->autopilot) flags |= STREAM_FLAG_AUTOPILOT;
+    if (game->paused) flags |= STREAM_FLAG_PAUSED;
+    return flags;
+}
+
+static uint8_t ghost_bits(const Ghost* ghost) {
+    return (uint8_t)((ghost->dir & 0x07) | (ghost->alive ? 0x08 : 0));
+}
+
+static bool player_changed(const Pacman* a, const Pacman* b) {
+    return a->pos.row != b->pos.row || a->pos.col != b->pos.col || a->dir != b->dir ||
+           a->score != b->score || a->lives != b->lives || a->active != b->active;
+}
+
+static uint8_t phase_bits(const GameState* game) {
+    return (uint8_t)((game->phase & 0x0F) | ((game->postPhase & 0x0F) << 4));
+}
+
+void stream_encoder_init(StreamEncoder* enc, uint32_t keyframeInterval) {
+    memset(enc, 0, sizeof(*enc));
+    enc->keyframeInterval = keyframeInterval > 0 ? keyframeInterval : STREAM_KEYFRAME_INTERVAL;
+}
+
+void stream_encoder_free(StreamEncoder* enc) {
+    mem_free(enc->ghosts);
+    enc->ghosts = NULL;
+    enc->ghostCount = 0;
+    enc->ghostCapacity = 0;
+    enc->primed = false;
+}
+
+void stream_encoder_force_keyframe(StreamEncoder* enc) {
+    enc->primed = false;
+}
+
+size_t stream_frame_bound(const GameState* game) {
+    size_t cells = game->map.grid ? (size_t)game->map.rows * (size_t)game->map.cols : 0;
+    size_t ghosts = game->ghosts ? (size_t)game->ghostCount : 0;
+    return 128 + STREAM_MESSAGE_LEN + cells * 11 + ghosts * 32 + GAME_TILE_LOG_SIZE * 12;
+}
+
+// Runs atravessam o fim das linhas: a ordem e a do mapa sem padding.
+static void write_cells(Writer* w, const Map* map) {
+    char cell = map_tile(map, 0, 0);
+    size_t run = 0;
+    for (int row = 0; row < map->rows; row++) {
+        const char* line = map_row(map, row);
+        for (int col = 0; col < map->cols; col++) {
+            if (line[col] == cell) {
+                run++;
+                continue;
+            }
+            put_byte(w, (uint8_t)cell);
+            put_varint(w, run);
+            cell = line[col];
+            run = 1;
+        }
+    }
+    put_byte(w, (uint8_t)cell);
+    put_varint(w, run);
+}
+
+static void write_message(Writer* w, const GameState* game) {
+    size_t length = strnlen(game->hudMessage, STREAM_MESSAGE_LEN - 1);
+    put_varint(w, length);
+    put_bytes(w, game->hudMessage, length);
+}
+
+static void write_keyframe(Writer* w, const GameState* game) {
+    const Map* map = &game->map;
+    int ghostCount = game->ghosts ? game->ghostCount : 0;
+    put_varint(w, (uint64_t)map->rows);
+    put_varint(w, (uint64_t)map->cols);
+    put_varint(w, game->mapRevision);
+    put_varint(w, (uint64_t)map->pelletsInitial);
+    write_cells(w, map);
+    put_varint(w, (uint64_t)game->playerCount);
+    put_varint(w, (uint64_t)game->humanPlayers);
+    for (int i = 0; i < game->playerCount; i++) {
+        const Pacman* player = &game->players[i];
+        put_varint(w, (uint64_t)player->pos.row);
+        put_varint(w, (uint64_t)player->pos.col);
+        put_byte(w, (uint8_t)((player->dir & 0x07) | (player->active ? 0x08 : 0)));
+        put_signed(w, player->score);
+        put_signed(w, player->lives);
+    }
+    put_byte(w, state_flags(game));
+    put_varint(w, (uint64_t)ghostCount);
+    for (int i = 0; i < ghostCount; i++) {
+        put_varint(w, (uint64_t)game->ghosts[i].pos.row);
+        put_varint(w, (uint64_t)game->ghosts[i].pos.col);
+        put_byte(w, ghost_bits(&game->ghosts[i]));
+    }
+    put_signed(w, game->score);
+    put_signed(w, game->lives);
+    put_signed(w, game->level);
+    put_byte(w, phase_bits(game));
+    put_signed(w, game->pendingRankingScore);
+    put_varint(w, (uint64_t)game->pelletsRemaining);
+    write_message(w, game);
+}
+
+static bool ghost_changed(const Ghost* a, const Ghost* b) {
+    return a->pos.row != b->pos.row || a->pos.col != b->pos.col || ghost_bits(a) != ghost_bits(b);
+}
+
+static void write_delta(Writer* w, const StreamEncoder* enc, const GameState* game) {
+    int changedPlayers = 0;
+    for (int i = 0; i < enc->playerCount; i++) {
+        if (player_changed(&game->players[i], &enc->players[i])) changedPlayers++;
+    }
+    int changedGhosts = 0;
+    for (int i = 0; i < enc->ghostCount; i++) {
+        if (ghost_changed(&game->ghosts[i], &enc->ghosts[i])) changedGhosts++;
+    }
+    uint32_t mask = 0;
+    if (changedPlayers > 0) mask |= DELTA_PLAYERS;
+    if (changedGhosts > 0) mask |= DELTA_GHOSTS;
+    if (game->tileChangeCount != enc->tileChangeCount) mask |= DELTA_TILES;
+    if (game->score != enc->score) mask |= DELTA_SCORE;
+    if (game->lives != enc->lives) mask |= DELTA_LIVES;
+    if (game->level != enc->level) mask |= DELTA_LEVEL;
+    if (phase_bits(game) != enc->phase) mask |= DELTA_PHASE;
+    if (state_flags(game) != enc->flags) mask |= DELTA_FLAGS;
+    if (game->pelletsRemaining != enc->pelletsRemaining) mask |= DELTA_PELLETS;
+    if (strncmp(game->hudMessage, enc->message, STREAM_MESSAGE_LEN - 1) != 0) mask |= DELTA_MESSAGE;
+    put_varint(w, mask);
+
+    if (mask & DELTA_PLAYERS) {
+        put_varint(w, (uint64_t)changedPlayers);
+        int previous = -1;
+        for (int i = 0; i < enc->playerCount; i++) {
+            const Pacman* player = &game->players[i];
+            const Pacman* old = &enc->players[i];
+            if (!player_changed(player, old)) continue;
+            put_varint(w, (uint64_t)(i - previous - 1));
+            put_signed(w, player->pos.row - old->pos.row);
+            put_signed(w, player->pos.col - old->pos.col);
+            put_byte(w, (uint8_t)((player->dir & 0x07) | (player->active ? 0x08 : 0)));
+            put_signed(w, (int64_t)player->score - old->score);
+            put_signed(w, (int64_t)player->lives - old->lives);
+            previous = i;
+        }
+    }
+    if (mask & DELTA_GHOSTS) {
+        put_varint(w, (uint64_t)changedGhosts);
+        int previous = -1;
+        for (int i = 0; i < enc->ghostCount; i++) {
+            const Ghost* ghost = &game->ghosts[i];
+            const Ghost* old = &enc->ghosts[i];
+            if (!ghost_changed(ghost, old)) continue;
+            put_varint(w, (uint64_t)(i - previous - 1));
+            put_signed(w, ghost->pos.row - old->pos.row);
+            put_signed(w, ghost->pos.col - old->pos.col);
+            put_byte(w, ghost_bits(ghost));
+            previous = i;
+        }
+    }
+    if (mask & DELTA_TILES) {
+        // O valor enviado e o atual do tile: repeticoes no anel so reenviam
+        // o mesmo conteudo.
+        uint32_t count = game->tileChangeCount - enc->tileChangeCount;
+        put_varint(w, count);
+        int64_t previous = 0;
+        for (uint32_t seq = enc->tileChangeCount; seq != game->tileChangeCount; seq++) {
+            Position pos = game->tileChanges[seq % GAME_TILE_LOG_SIZE];
+            int64_t index = (int64_t)pos.row * game->map.cols + pos.col;
+            put_signed(w, index - previous);
+            put_byte(w, (uint8_t)map_get(&game->map, pos.row, pos.col));
+            previous = index;
+        }
+    }
+    if (mask & DELTA_SCORE) put_signed(w, (int64_t)game->score - enc->score);
+    if (mask & DELTA_LIVES) put_signed(w, (int64_t)game->lives - enc->lives);
+    if (mask & DELTA_LEVEL) put_signed(w, (int64_t)game->level - enc->level);
+    if (mask & DELTA_PHASE) {
+        put_byte(w, phase_bits(game));
+        put_signed(w, game->pendingRankingScore);
+    }
+    if (mask & DELTA_FLAGS) put_byte(w, state_flags(game));
+    if (mask & DELTA_PELLETS) put_signed(w, (int64_t)game->pelletsRemaining - enc->pelletsRemaining);
+    if (mask & DELTA_MESSAGE) write_message(w, game);
+}
+
+static bool remember(StreamEncoder* enc, const GameState* game) {
+    int ghostCount = game->ghosts ? game->ghostCount : 0;
+    if (ghostCount > enc->ghostCapacity) {
+        Ghost* ghosts = (Ghost*)mem_realloc(MEM_TAG_ENTITIES, enc->ghosts, sizeof(Ghost) * (size_t)ghostCount);
+        if (!ghosts) return false;
+        enc->ghosts = ghosts;
+        enc->ghostCapacity = ghostCount;
+    }
+    if (ghostCount > 0) memcpy(enc->ghosts, game->ghosts, sizeof(Ghost) * (size_t)ghostCount);
+    enc->ghostCount = ghostCount;
+    enc->mapRevision = game->mapRevision;
+    enc->tileChangeCount = game->tileChangeCount;
+    enc->rows = game->map.rows;
+    enc->cols = game->map.cols;
+    memcpy(enc->players, game->players, sizeof(enc->players));
+    enc->playerCount = game->playerCount;
+    enc->flags = state_flags(game);
+    enc->score = game->score;
+    enc->lives = game->lives;
+    enc->level = game->level;
+    enc->phase = phase_bits(game);
+    enc->pelletsRemaining = game->pelletsRemaining;
+    snprintf(enc->message, sizeof(enc->message), "%s", game->hudMessage);
+    return true;
+}
+
+size_t stream_encode(StreamEncoder* enc, const GameState* game, uint8_t* out, size_t capacity) {
+    if (!game->map.grid) return 0;
+    int ghostCount = game->ghosts ? game->ghostCount : 0;
+    bool key = !enc->primed || enc->sinceKeyframe + 1 >= enc->keyframeInterval ||
+               game->mapRevision != enc->mapRevision ||
+               game->tileChangeCount - enc->tileChangeCount > GAME_TILE_LOG_SIZE ||
+               ghostCount != enc->ghostCount || game->playerCount != enc->playerCount || game->map.rows != enc->rows || game->map.cols != enc->cols;
+
+    Writer w = {out, 0, capacity, false};
+    put_byte(&w, key ? STREAM_FRAME_KEY : STREAM_FRAME_DELTA);
+    put_varint(&w, enc->tick);
+    if (key) write_keyframe(&w, game);
+    else write_delta(&w, enc, game);
+    if (w.overflow || !remember(enc, game)) return 0;
+
+    enc->tick++;
+    enc->primed = true;
+    enc->sinceKeyframe = key ? 0 : enc->sinceKeyframe + 1;
+    if (key) enc->keyframes++;
+    else enc->deltas++;
+    enc->bytes += w.size;
+    return w.size;
+}
+
+void stream_decoder_init(StreamDecoder* dec) {
+    memset(dec, 0, sizeof(*dec));
+}
+
+static void read_message(Reader* r, GameState* game) {
+    size_t length = (size_t)get_varint(r);
+    const uint8_t* text = length < sizeof(game->hudMessage) ? get_bytes(r, length) : NULL;
+    if (!text) {
+        r->bad = true;
+        return;
+    }
+    memcpy(game->hudMessage, text, length);
+    game->hudMessage[length] = '\0';
+}
+
+static bool read_phase(Reader* r, GameState* game) {
+    uint8_t bits = get_byte(r);
+    int pendingScore = (int)get_signed(r);
+    if (r->bad || (bits & 0x0F) > GAME_PHASE_ENTER_SCORE || (bits >> 4) > GAME_PHASE_ENTER_SCORE) return false;
+    game->phase = (GamePhase)(bits & 0x0F);
+    game->postPhase = (GamePhase)(bits >> 4);
+    game->pendingRankingScore = pendingScore;
+    return true;
+}
+
+// Posicoes e direcoes vindas do arquivo indexam a grade, o hash e os
+// blocos sem conferir limites: so entram no estado depois de validadas.
+static bool valid_entity(const Map* map, Position pos, uint8_t bits) {
+    return map_in_bounds(map, pos.row, pos.col) && (bits & 0x07) <= DIR_RIGHT;
+}
+
+static void apply_flags(GameState* game, uint8_t flags) {
+    bool powered = (flags & STREAM_FLAG_POWERED) != 0;
+    game->hash ^= zobrist_powered(game->powered) ^ zobrist_powered(powered);
+    game->powered = powered;
+    game->autopilot = (flags & STREAM_FLAG_AUTOPILOT) != 0;
+    game->paused = (flags & STREAM_FLAG_PAUSED) != 0;
+}
+
+static bool resize_game(GameState* game, int rows, int cols, int ghostCount) {
+    if (!game->map.grid || game->map.rows != rows || game->map.cols != cols) {
+        mem_free(game->map.grid);
+        game->map.grid = NULL;
+        if (!map_alloc(&game->map, rows, cols)) return false;
+    }
+    if (ghostCount != (game->ghosts ? game->ghostCount : 0)) {
+        mem_free(game->ghosts);
+        game->ghosts =
+            ghostCount > 0 ? (Ghost*)mem_calloc(MEM_TAG_ENTITIES, (size_t)ghostCount, sizeof(Ghost)) : NULL;
+        if (ghostCount > 0 && !game->ghosts) return false;
+    }
+    game->ghostCount = ghostCount;
+    return true;
+}
+
+static void fill_cells(Map* map, size_t offset, char cell, size_t count) {
+    int row = (int)(offset / (size_t)map->cols);
+    int col = (int)(offset % (size_t)map->cols);
+    while (count > 0) {
+        size_t length = (size_t)(map->cols - col);
+        if (length > count) length = count;
+        memset(map_row(map, row) + col, cell, length);
+        count -= length;
+        row++;
+        col = 0;
+    }
+}
+
+static bool decode_keyframe(Reader* r, GameState* game) {
+    int rows = (int)get_varint(r);
+    int cols = (int)get_varint(r);
+    uint32_t revision = (uint32_t)get_varint(r);
+    int pelletsInitial = (int)get_varint(r);
+    if (r->bad || rows <= 0 || cols <= 0 || (size_t)rows * (size_t)cols > STREAM_MAX_CELLS) return false;
+
+    // Os fantasmas so sao contados depois das celulas: dimensiona o mapa
+    // primeiro e ajusta o vetor de fantasmas em seguida.
+    if (!resize_game(game, rows, cols, game->ghosts ? game->ghostCount : 0)) return false;
+    size_t total = (size_t)rows * (size_t)cols;
+    size_t filled = 0;
+    while (filled < total && !r->bad) {
+        char cell = (char)get_byte(r);
+        size_t run = (size_t)get_varint(r);
+        if (run == 0 || run > total - filled) return false;
+        fill_cells(&game->map, filled, cell, run);
+        filled += run;
+    }
+    if (r->bad) return false;
+
+    int playerCount = (int)get_varint(r);
+    int humanPlayers = (int)get_varint(r);
+    if (r->bad || playerCount < 1 || playerCount > GAME_MAX_PLAYERS) return false;
+    game->playerCount = playerCount;
+    game->humanPlayers = humanPlayers < playerCount ? humanPlayers : playerCount;
+    game->activePlayers = 0;
+    for (int i = 0; i < playerCount; i++) {
+        Pacman* player = &game->players[i];
+        Position pos = {(int)get_varint(r), (int)get_varint(r)};
+        uint8_t bits = get_byte(r);
+        if (r->bad || !valid_entity(&game->map, pos, bits)) return false;
+        player->pos = pos;
+        player->prevPos = pos;
+        player->dir = (Direction)(bits & 0x07);
+        player->active = (bits & 0x08) != 0;
+        player->score = (int)get_signed(r);
+        player->lives = (int)get_signed(r);
+        player->moveTimer = 0.0f;
+        if (player->active) game->activePlayers++;
+    }
+    uint8_t flags = get_byte(r);
+    int ghostCount = (int)get_varint(r);
+    if (r->bad || ghostCount < 0 || (size_t)ghostCount > r->size) return false;
+    if (!resize_game(game, rows, cols, ghostCount)) return false;
+    for (int i = 0; i < ghostCount; i++) {
+        Ghost* ghost = &game->ghosts[i];
+        Position pos = {(int)get_varint(r), (int)get_varint(r)};
+        uint8_t bits = get_byte(r);
+        if (r->bad || !valid_entity(&game->map, pos, bits)) return false;
+        ghost->pos = pos;
+        ghost->prevPos = pos;
+        ghost->dir = (Direction)(bits & 0x07);
+        ghost->alive = (bits & 0x08) != 0;
+        ghost->strategy = ghost_default_strategy(i);
+        ghost->moveTimer = 0.0f;
+    }
+    game->score = (int)get_signed(r);
+    game->lives = (int)get_signed(r);
+    game->level = (int)get_signed(r);
+    if (!read_phase(r, game)) return false;
+    game->pelletsRemaining = (int)get_varint(r);
+    read_message(r, game);
+    if (r->bad) return false;
+
+    game->map.pelletsInitial = pelletsInitial;
+    game->map.pelletsRemaining = game->pelletsRemaining;
+    apply_flags(game, flags);
+    if (game->mapRevision != revision) path_service_reset(&game->paths, &game->map);
+    game->mapRevision = revision;
+    game->running = true;
+    game->hash = zobrist_hash(game);
+    return true;
+}
+
+// Um keyframe recusado no meio pode ter redimensionado o mapa com as
+// entidades antigas ainda dentro dele: sem grade, nada e desenhado nem
+// consultado ate o proximo keyframe valido.
+static bool read_keyframe(Reader* r, GameState* game) {
+    if (decode_keyframe(r, game)) return true;
+    map_free(&game->map);
+    return false;
+}
+
+static void move_entity(Position* pos, Position* prevPos, float* moveTimer, Position next) {
+    *prevPos = *pos;
+    *pos = next;
+    *moveTimer = 0.0f;
+}
+
+static bool read_delta(Reader* r, GameState* game) {
+    uint32_t mask = (uint32_t)get_varint(r);
+    for (int i = 0; i < game->playerCount; i++) game->players[i].moveTimer += SIM_TICK_DT;
+    for (int i = 0; i < game->ghostCount; i++) game->ghosts[i].moveTimer += SIM_TICK_DT;
+
+    if (mask & DELTA_PLAYERS) {
+        int count = (int)get_varint(r);
+        int index = -1;
+        for (int k = 0; k < count && !r->bad; k++) {
+            index += (int)get_varint(r) + 1;
+            if (index < 0 || index >= game->playerCount) return false;
+            Pacman* player = &game->players[index];
+            Position next = {player->pos.row + (int)get_signed(r), player->pos.col + (int)get_signed(r)};
+            uint8_t bits = get_byte(r);
+            if (r->bad || !valid_entity(&game->map, next, bits)) return false;
+            bool active = (bits & 0x08) != 0;
+            if (player->active) game->hash ^= zobrist_pacman(index, player->pos);
+            if (active) game->hash ^= zobrist_pacman(index, next);
+            if (active != player->active) game->activePlayers += active ? 1 : -1;
+            if (next.row != player->pos.row || next.col != player->pos.col) {
+                move_entity(&player->pos, &player->prevPos, &player->moveTimer, next);
+            }
+            player->dir = (Direction)(bits & 0x07);
+            player->active = active;
+            player->score += (int)get_signed(r);
+            player->lives += (int)get_signed(r);
+        }
+    }
+    if (mask & DELTA_GHOSTS) {
+        int count = (int)get_varint(r);
+        int index = -1;
+        for (int k = 0; k < count && !r->bad; k++) {
+            index += (int)get_varint(r) + 1;
+            if (index < 0 || index >= game->ghostCount) return false;
+            Ghost* ghost = &game->ghosts[index];
+            Position next = {ghost->pos.row + (int)get_signed(r), ghost->pos.col + (int)get_signed(r)};
+            uint8_t bits = get_byte(r);
+            if (r->bad || !valid_entity(&game->map, next, bits)) return false;
+            bool alive = (bits & 0x08) != 0;
+            game->hash ^= zobrist_ghost(index, ghost->pos, ghost->alive) ^ zobrist_ghost(index, next, alive);
+            if (next.row != ghost->pos.row || next.col != ghost->pos.col) {
+                move_entity(&ghost->pos, &ghost->prevPos, &ghost->moveTimer, next);
+            }
+            ghost->dir = (Direction)(bits & 0x07);
+            ghost->alive = alive;
+        }
+    }
+    if (mask & DELTA_TILES) {
+        uint32_t count = (uint32_t)get_varint(r);
+        int64_t index = 0;
+        int64_t total = (int64_t)game->map.rows * game->map.cols;
+        for (uint32_t k = 0; k < count && !r->bad; k++) {
+            index += get_signed(r);
+            char cell = (char)get_byte(r);
+            if (index < 0 || index >= total) return false;
+            Position pos = {(int)(index / game->map.cols), (int)(index % game->map.cols)};
+            char old = map_get(&game->map, pos.row, pos.col);
+            game->hash ^= zobrist_tile(pos.row, pos.col, old) ^ zobrist_tile(pos.row, pos.col, cell);
+            map_set(&game->map, pos.row, pos.col, cell);
+            game->tileChanges[game->tileChangeCount % GAME_TILE_LOG_SIZE] = pos;
+            game->tileChangeCount++;
+        }
+    }
+    if (mask & DELTA_SCORE) {
+        int score = game->score + (int)get_signed(r);
+        game->hash ^= zobrist_score(game->score) ^ zobrist_score(score);
+        game->score = score;
+    }
+    if (mask & DELTA_LIVES) {
+        int lives = game->lives + (int)get_signed(r);
+        game->hash ^= zobrist_lives(game->lives) ^ zobrist_lives(lives);
+        game->lives = lives;
+    }
+    if (mask & DELTA_LEVEL) {
+        int level = game->level + (int)get_signed(r);
+        game->hash ^= zobrist_level(game->level) ^ zobrist_level(level);
+        game->level = level;
+    }
+    if ((mask & DELTA_PHASE) && !read_phase(r, game)) return false;
+    if (mask & DELTA_FLAGS) apply_flags(game, get_byte(r));
+    if (mask & DELTA_PELLETS) {
+        game->pelletsRemaining += (int)get_signed(r);
+        game->map.pelletsRemaining = game->pelletsRemaining;
+    }
+    if (mask & DELTA_MESSAGE) read_message(r, game);
+    return !r->bad;
+}
+
+bool stream_decode(StreamDecoder* dec, GameState* game, const uint8_t* data, size_t size) {
+    Reader r = {data, size, 0, false};
+    uint8_t type = get_byte(&r);
+    uint32_t tick = (uint32_t)get_varint(&r);
+    if (r.bad || (type != STREAM_FRAME_KEY && type != STREAM_FRAME_DELTA)) {
+        dec->rejected++;
+        return false;
+    }
+    if (type == STREAM_FRAME_DELTA && (!dec->synced || tick != dec->tick + 1)) {
+        dec->synced = false;
+        dec->rejected++;
+        return false;
+    }
+    bool ok = type == STREAM_FRAME_KEY ? read_keyframe(&r, game) : read_delta(&r, game);
+    dec->synced = ok;
+    if (!ok) {
+        dec->rejected++;
+        return false;
+    }
+    dec->tick = tick;
+    dec->frames++;
+    return true;
+}
+
+bool stream_write_frame(FILE* file, const uint8_t* data, size_t size) {
+    uint8_t prefix[4] = {(uint8_t)size, (uint8_t)(size >> 8), (uint8_t)(size >> 16), (uint8_t)(size >> 24)};
+    return fwrite(prefix, 1, sizeof(prefix), file) == sizeof(prefix) && fwrite(data, 1, size, file) == size;
+}
+
+bool stream_read_frame(FILE* file, uint8_t** buffer, size_t* capacity, size_t* size) {
+    uint8_t prefix[4];
+    if (fread(prefix, 1, sizeof(prefix), file) != sizeof(prefix)) return false;
+    size_t length = (size_t)prefix[0] | ((size_t)prefix[1] << 8) | ((size_t)prefix[2] << 16) | ((size_t)prefix[3] << 24);
+    if (length == 0 || length > STREAM_MAX_CELLS * 2u) return false;
+    if (length > *capacity) {
+        uint8_t* grown = (uint8_t*)realloc(*buffer, length);
+        if (!grown) return false;
+        *buffer = grown;
+        *capacity = length;
+    }
+    if (fread(*buffer, 1, length, file) != length) return false;
+    *size = length;
+    return true;
+}
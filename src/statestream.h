@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "game.h"
+
+#define STREAM_KEYFRAME_INTERVAL 300
+#define STREAM_MESSAGE_LEN 96
+
+typedef enum {
+    STREAM_FRAME_KEY = 1,
+    STREAM_FRAME_DELTA = 2
+} StreamFrameType;
+
+// Codifica um quadro por tick. Keyframes levam os tiles do mapa (em RLE) e
+// todos os fantasmas; deltas levam so o que mudou desde o quadro anterior: tiles
+// alterados (lidos de game->tileChanges, sem varrer o mapa), jogadores
+// (posicao, score e vidas), fantasmas, flags, score, vidas, nivel e fase. Inteiros vao em
+// varint, diferencas em zigzag. Um keyframe sai a cada keyframeInterval
+// quadros e sempre que o delta nao puder ser montado (mapa trocado, anel
+// de tiles estourado, numero de fantasmas ou jogadores diferente).
+typedef struct {
+    uint32_t tick;
+    uint32_t keyframeInterval;
+    uint32_t sinceKeyframe;
+    bool primed;
+    uint32_t mapRevision;
+    uint32_t tileChangeCount;
+    int rows;
+    int cols;
+    Pacman players[GAME_MAX_PLAYERS];
+    int playerCount;
+    uint8_t flags;
+    Ghost* ghosts;
+    int ghostCount;
+    int ghostCapacity;
+    int score;
+    int lives;
+    int level;
+    uint8_t phase;
+    int pelletsRemaining;
+    char message[STREAM_MESSAGE_LEN];
+    unsigned long long keyframes;
+    unsigned long long deltas;
+    unsigned long long bytes;
+} StreamEncoder;
+
+// Reconstroi o estado num GameState preparado com game_clone_init (liberar
+// com game_shutdown). O hash Zobrist e atualizado junto, entao deve bater
+// com o da origem. Deltas fora de sequencia sao recusados ate o proximo
+// keyframe.
+typedef struct {
+    uint32_t tick;
+    bool synced;
+    unsigned long long frames;
+    unsigned long long rejected;
+} StreamDecoder;
+
+void stream_encoder_init(StreamEncoder* enc, uint32_t keyframeInterval);
+void stream_encoder_free(StreamEncoder* enc);
+void stream_encoder_force_keyframe(StreamEncoder* enc);
+size_t stream_frame_bound(const GameState* game);
+// Retorna o tamanho do quadro, ou 0 se capacity nao basta (use
+// stream_frame_bound).
+size_t stream_encode(StreamEncoder* enc, const GameState* game, uint8_t* out, size_t capacity);
+
+void stream_decoder_init(StreamDecoder* dec);
+bool stream_decode(StreamDecoder* dec, GameState* game, const uint8_t* data, size_t size);
+
+// Arquivo (ou pipe) de quadros: cada quadro vai precedido do tamanho em 4
+// bytes little-endian. stream_read_frame aumenta *buffer conforme preciso.
+bool stream_write_frame(FILE* file, const uint8_t* data, size_t size);
+bool stream_read_frame(FILE* file, uint8_t** buffer, size_t* capacity, size_t* size);
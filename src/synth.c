@@ -0,0 +1,113 @@
+#include "synth.h"
+#include <math.h>
+#include <string.h>
+
+#define SYNTH_AMPLITUDE 0.4f
+#define SYNTH_ATTACK_FRAMES 64
+#define SYNTH_RELEASE_FRAMES 256
+
+typedef struct {
+    float frequency;
+    float duration;
+} SynthTone;
+
+static const SynthTone kTones[SYNTH_SOUND_COUNT] = {
+    [SYNTH_SOUND_PELLET] = {880.0f, 0.08f},
+    [SYNTH_SOUND_POWER] = {523.0f, 0.25f},
+    [SYNTH_SOUND_GHOST] = {660.0f, 0.3f},
+    [SYNTH_SOUND_LOSE_LIFE] = {200.0f, 0.4f},
+    [SYNTH_SOUND_WIN] = {440.0f, 0.5f}
+};
+
+void synth_init(Synth* synth, int sampleRate) {
+    memset(synth->voices, 0, sizeof(synth->voices));
+    synth->sampleRate = sampleRate > 0 ? sampleRate : SYNTH_SAMPLE_RATE;
+    for (int i = 0; i < SYNTH_WAVETABLE_SIZE; i++) {
+        float angle = 2.0f * 3.14159265f * (float)i / (float)SYNTH_WAVETABLE_SIZE;
+        synth->wavetable[i] = (int16_t)(SYNTH_AMPLITUDE * 32767.0f * sinf(angle));
+    }
+    atomic_init(&synth->queueHead, 0);
+    atomic_init(&synth->queueTail, 0);
+    atomic_init(&synth->droppedEvents, 0);
+}
+
+bool synth_trigger(Synth* synth, SynthSound sound) {
+    if ((int)sound < 0 || sound >= SYNTH_SOUND_COUNT) return false;
+    unsigned int head = atomic_load_explicit(&synth->queueHead, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&synth->queueTail, memory_order_acquire);
+    if (head - tail >= SYNTH_QUEUE_SIZE) {
+        atomic_fetch_add_explicit(&synth->droppedEvents, 1, memory_order_relaxed);
+        return false;
+    }
+    synth->queue[head % SYNTH_QUEUE_SIZE] = (uint8_t)sound;
+    atomic_store_explicit(&synth->queueHead, head + 1, memory_order_release);
+    return true;
+}
+
+static SynthVoice* pick_voice(Synth* synth, SynthSound sound) {
+    SynthVoice* freeVoice = NULL;
+    SynthVoice* shortest = &synth->voices[0];
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) {
+        SynthVoice* voice = &synth->voices[i];
+        if (voice->active && voice->sound == sound) return voice;
+        if (!voice->active && !freeVoice) freeVoice = voice;
+        if (voice->framesLeft < shortest->framesLeft) shortest = voice;
+    }
+    return freeVoice ? freeVoice : shortest;
+}
+
+static void start_voice(Synth* synth, SynthSound sound) {
+    const SynthTone* tone = &kTones[sound];
+    SynthVoice* voice = pick_voice(synth, sound);
+    int frames = (int)(tone->duration * (float)synth->sampleRate);
+    if (frames <= 0) frames = synth->sampleRate / 10;
+    voice->active = true;
+    voice->sound = sound;
+    voice->phase = 0;
+    voice->phaseStep = (uint32_t)((double)tone->frequency * 4294967296.0 / (double)synth->sampleRate);
+    voice->framesLeft = frames;
+    voice->framesTotal = frames;
+}
+
+static void drain_queue(Synth* synth) {
+    unsigned int tail = atomic_load_explicit(&synth->queueTail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&synth->queueHead, memory_order_acquire);
+    while (tail != head) {
+        start_voice(synth, (SynthSound)synth->queue[tail % SYNTH_QUEUE_SIZE]);
+        tail++;
+    }
+    atomic_store_explicit(&synth->queueTail, tail, memory_order_release);
+}
+
+static int32_t envelope_q8(const SynthVoice* voice) {
+    int elapsed = voice->framesTotal - voice->framesLeft;
+    if (elapsed < SYNTH_ATTACK_FRAMES) return (elapsed * 256) / SYNTH_ATTACK_FRAMES;
+    if (voice->framesLeft < SYNTH_RELEASE_FRAMES) return (voice->framesLeft * 256) / SYNTH_RELEASE_FRAMES;
+    return 256;
+}
+
+void synth_render(Synth* synth, int16_t* out, int frames) {
+    drain_queue(synth);
+    for (int f = 0; f < frames; f++) {
+        int32_t mix = 0;
+        for (int v = 0; v < SYNTH_MAX_VOICES; v++) {
+            SynthVoice* voice = &synth->voices[v];
+            if (!voice->active) continue;
+            int16_t sample = synth->wavetable[voice->phase >> (32 - SYNTH_WAVETABLE_BITS)];
+            mix += (sample * envelope_q8(voice)) >> 8;
+            voice->phase += voice->phaseStep;
+            if (--voice->framesLeft <= 0) voice->active = false;
+        }
+        if (mix > 32767) mix = 32767;
+        if (mix < -32768) mix = -32768;
+        out[f] = (int16_t)mix;
+    }
+}
+
+int synth_active_voices(const Synth* synth) {
+    int count = 0;
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) {
+        if (synth->voices[i].active) count++;
+    }
+    return count;
+}
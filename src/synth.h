@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SYNTH_SAMPLE_RATE 22050
+#define SYNTH_MAX_VOICES 8
+#define SYNTH_WAVETABLE_BITS 10
+#define SYNTH_WAVETABLE_SIZE (1 << SYNTH_WAVETABLE_BITS)
+#define SYNTH_QUEUE_SIZE 64
+
+typedef enum {
+    SYNTH_SOUND_PELLET = 0,
+    SYNTH_SOUND_POWER,
+    SYNTH_SOUND_GHOST,
+    SYNTH_SOUND_LOSE_LIFE,
+    SYNTH_SOUND_WIN,
+    SYNTH_SOUND_COUNT
+} SynthSound;
+
+typedef struct {
+    bool active;
+    SynthSound sound;
+    uint32_t phase;
+    uint32_t phaseStep;
+    int framesLeft;
+    int framesTotal;
+} SynthVoice;
+
+// O jogo chama synth_trigger e a thread de audio chama synth_render:
+// a fila de eventos e single-producer/single-consumer, sem locks.
+typedef struct {
+    int sampleRate;
+    int16_t wavetable[SYNTH_WAVETABLE_SIZE];
+    SynthVoice voices[SYNTH_MAX_VOICES];
+    uint8_t queue[SYNTH_QUEUE_SIZE];
+    atomic_uint queueHead;
+    atomic_uint queueTail;
+    atomic_uint droppedEvents;
+} Synth;
+
+void synth_init(Synth* synth, int sampleRate);
+bool synth_trigger(Synth* synth, SynthSound sound);
+void synth_render(Synth* synth, int16_t* out, int frames);
+int synth_active_voices(const Synth* synth);
@@ -0,0 +1,118 @@
+#include "threadpool.h"
+#include "trace.h"
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+int thread_pool_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long count = (long)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return count > 0 ? (int)count : 1;
+}
+
+static void run_indices(ThreadPool* pool) {
+    int index;
+    while ((index = atomic_fetch_add(&pool->next, 1)) < pool->count) {
+        pool->task(pool->ctx, index);
+    }
+}
+
+static void* worker_main(void* arg) {
+    ThreadPool* pool = (ThreadPool*)arg;
+    unsigned int seen = 0;
+    while (true) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->stopping) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stopping) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        trace_thread_name("pool");
+        run_indices(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) pthread_cond_signal(&pool->done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return NULL;
+}
+
+bool thread_pool_init(ThreadPool* pool, int workerCount) {
+    pool->threads = NULL;
+    pool->threadCount = 0;
+    pool->task = NULL;
+    pool->ctx = NULL;
+    pool->count = 0;
+    atomic_init(&pool->next, 0);
+    pool->active = 0;
+    pool->generation = 0;
+    pool->stopping = false;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    if (workerCount <= 0) return true;
+
+    pool->threads = (pthread_t*)malloc(sizeof(pthread_t) * workerCount);
+    if (!pool->threads) return false;
+    for (int i = 0; i < workerCount; i++) {
+        if (pthread_create(&pool->threads[i], NULL, worker_main, pool) != 0) break;
+        pool->threadCount++;
+    }
+    return pool->threadCount == workerCount;
+}
+
+void thread_pool_destroy(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->threadCount; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    free(pool->threads);
+    pool->threads = NULL;
+    pool->threadCount = 0;
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+}
+
+void thread_pool_for(ThreadPool* pool, int count, ThreadPoolTask task, void* ctx) {
+    if (count <= 0) return;
+    if (pool->threadCount == 0 || count == 1) {
+        for (int i = 0; i < count; i++) task(ctx, i);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->ctx = ctx;
+    pool->count = count;
+    atomic_store(&pool->next, 0);
+    pool->active = pool->threadCount;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_indices(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+typedef void (*ThreadPoolTask)(void* ctx, int index);
+
+// Pool fixo de workers para lacos paralelos: thread_pool_for distribui os
+// indices [0, count) entre os workers e a propria thread chamadora, e so
+// retorna quando todos terminaram.
+typedef struct {
+    pthread_t* threads;
+    int threadCount;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    ThreadPoolTask task;
+    void* ctx;
+    int count;
+    atomic_int next;
+    int active;
+    unsigned int generation;
+    bool stopping;
+} ThreadPool;
+
+int thread_pool_cpu_count(void);
+bool thread_pool_init(ThreadPool* pool, int workerCount);
+void thread_pool_destroy(ThreadPool* pool);
+void thread_pool_for(ThreadPool* pool, int count, ThreadPoolTask task, void* ctx);
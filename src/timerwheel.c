@@ -0,0 +1,150 @@
+#include "timerwheel.h"
+#include <stddef.h>
+
+static int handle_index(int handle) {
+    return handle & 0xFFFF;
+}
+
+static uint16_t handle_generation(int handle) {
+    return (uint16_t)((unsigned int)handle >> 16);
+}
+
+static int make_handle(int index, uint16_t generation) {
+    return (int)(((unsigned int)(generation & 0x7FFF) << 16) | (unsigned int)index);
+}
+
+static TimerNode* resolve(const TimerWheel* wheel, int handle) {
+    if (handle < 0) return NULL;
+    int index = handle_index(handle);
+    if (index >= TIMER_WHEEL_CAPACITY) return NULL;
+    const TimerNode* node = &wheel->nodes[index];
+    if (!node->active || (node->generation & 0x7FFF) != handle_generation(handle)) return NULL;
+    return (TimerNode*)node;
+}
+
+static void link_node(TimerWheel* wheel, int index) {
+    TimerNode* node = &wheel->nodes[index];
+    uint32_t delta = node->expires - wheel->now;
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1u << (TIMER_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    int slot = (int)((node->expires >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+    node->level = level;
+    node->slot = slot;
+    node->prev = -1;
+    node->next = wheel->slots[level][slot];
+    if (node->next >= 0) wheel->nodes[node->next].prev = index;
+    wheel->slots[level][slot] = index;
+}
+
+static void unlink_node(TimerWheel* wheel, int index) {
+    TimerNode* node = &wheel->nodes[index];
+    if (node->prev >= 0) {
+        wheel->nodes[node->prev].next = node->next;
+    } else {
+        wheel->slots[node->level][node->slot] = node->next;
+    }
+    if (node->next >= 0) wheel->nodes[node->next].prev = node->prev;
+    node->next = -1;
+    node->prev = -1;
+}
+
+static void release_node(TimerWheel* wheel, int index) {
+    TimerNode* node = &wheel->nodes[index];
+    node->active = false;
+    node->generation++;
+    node->next = wheel->freeList;
+    wheel->freeList = index;
+}
+
+void timer_wheel_init(TimerWheel* wheel) {
+    wheel->now = 0;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            wheel->slots[level][slot] = -1;
+        }
+    }
+    for (int i = 0; i < TIMER_WHEEL_CAPACITY; i++) {
+        wheel->nodes[i] = (TimerNode){0};
+        wheel->nodes[i].prev = -1;
+        wheel->nodes[i].next = (i + 1 < TIMER_WHEEL_CAPACITY) ? i + 1 : -1;
+    }
+    wheel->freeList = 0;
+}
+
+int timer_wheel_schedule(TimerWheel* wheel, uint32_t delayTicks, int kind, int data) {
+    if (wheel->freeList < 0) return TIMER_NONE;
+    if (delayTicks == 0) delayTicks = 1;
+    if (delayTicks > TIMER_WHEEL_MAX_DELAY) delayTicks = TIMER_WHEEL_MAX_DELAY;
+
+    int index = wheel->freeList;
+    TimerNode* node = &wheel->nodes[index];
+    wheel->freeList = node->next;
+    node->active = true;
+    node->expires = wheel->now + delayTicks;
+    node->kind = kind;
+    node->data = data;
+    link_node(wheel, index);
+    return make_handle(index, node->generation);
+}
+
+bool timer_wheel_cancel(TimerWheel* wheel, int handle) {
+    TimerNode* node = resolve(wheel, handle);
+    if (!node) return false;
+    int index = handle_index(handle);
+    unlink_node(wheel, index);
+    release_node(wheel, index);
+    return true;
+}
+
+bool timer_wheel_active(const TimerWheel* wheel, int handle) {
+    return resolve(wheel, handle) != NULL;
+}
+
+uint32_t timer_wheel_remaining(const TimerWheel* wheel, int handle) {
+    const TimerNode* node = resolve(wheel, handle);
+    if (!node) return 0;
+    return node->expires - wheel->now;
+}
+
+static void cascade(TimerWheel* wheel, int level) {
+    int slot = (int)((wheel->now >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+    int index = wheel->slots[level][slot];
+    wheel->slots[level][slot] = -1;
+    while (index >= 0) {
+        int next = wheel->nodes[index].next;
+        link_node(wheel, index);
+        index = next;
+    }
+}
+
+int timer_wheel_advance(TimerWheel* wheel, TimerExpired* out, int maxOut) {
+    wheel->now++;
+    int top = 0;
+    while (top + 1 < TIMER_WHEEL_LEVELS &&
+           (wheel->now & ((1u << (TIMER_WHEEL_BITS * (top + 1))) - 1u)) == 0) {
+        top++;
+    }
+    for (int level = top; level >= 1; level--) {
+        cascade(wheel, level);
+    }
+
+    int count = 0;
+    int slot = (int)(wheel->now & (TIMER_WHEEL_SLOTS - 1));
+    int index = wheel->slots[0][slot];
+    while (index >= 0) {
+        TimerNode* node = &wheel->nodes[index];
+        int next = node->next;
+        if (node->expires == wheel->now && count < maxOut) {
+            out[count].handle = make_handle(index, node->generation);
+            out[count].kind = node->kind;
+            out[count].data = node->data;
+            count++;
+            unlink_node(wheel, index);
+            release_node(wheel, index);
+        }
+        index = next;
+    }
+    return count;
+}
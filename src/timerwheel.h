@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 3
+#define TIMER_WHEEL_CAPACITY 32
+#define TIMER_WHEEL_MAX_DELAY ((1u << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1u)
+#define TIMER_NONE -1
+
+typedef struct {
+    int next;
+    int prev;
+    int level;
+    int slot;
+    uint32_t expires;
+    uint16_t generation;
+    bool active;
+    int kind;
+    int data;
+} TimerNode;
+
+typedef struct {
+    int handle;
+    int kind;
+    int data;
+} TimerExpired;
+
+// Roda de timers hierarquica (3 niveis de 64 slots, ~72 min a 60 ticks/s).
+// Agendar e cancelar sao O(1); avancar um tick custa O(expirados), mais
+// uma cascata de um slot a cada 64 ticks.
+typedef struct {
+    uint32_t now;
+    int slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    TimerNode nodes[TIMER_WHEEL_CAPACITY];
+    int freeList;
+} TimerWheel;
+
+void timer_wheel_init(TimerWheel* wheel);
+int timer_wheel_schedule(TimerWheel* wheel, uint32_t delayTicks, int kind, int data);
+bool timer_wheel_cancel(TimerWheel* wheel, int handle);
+bool timer_wheel_active(const TimerWheel* wheel, int handle);
+uint32_t timer_wheel_remaining(const TimerWheel* wheel, int handle);
+int timer_wheel_advance(TimerWheel* wheel, TimerExpired* out, int maxOut);
@@ -0,0 +1,141 @@
+#include "trace.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+    const char* name;
+    uint64_t time;      // ns desde trace_start
+    char phase;
+} TraceEvent;
+
+typedef struct TraceBuffer {
+    struct TraceBuffer* next;
+    TraceEvent* chunks[TRACE_MAX_CHUNKS];
+    atomic_uint count;
+    atomic_uint dropped;
+    int tid;
+    const char* name;
+} TraceBuffer;
+
+atomic_bool traceEnabled;
+static _Atomic(TraceBuffer*) traceBuffers;
+static atomic_uint traceGeneration;
+static atomic_int nextThreadId;
+static uint64_t traceOrigin;
+static FILE* traceFile;
+
+// Um buffer de geracao anterior ja foi liberado por trace_stop; a thread
+// so o reaproveita se a geracao bater.
+static _Thread_local TraceBuffer* localBuffer;
+static _Thread_local unsigned int localGeneration;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+bool trace_start(const char* path) {
+    if (atomic_load(&traceEnabled)) return false;
+    traceFile = fopen(path, "w");
+    if (!traceFile) return false;
+    atomic_store(&traceBuffers, NULL);
+    atomic_store(&nextThreadId, 0);
+    atomic_fetch_add(&traceGeneration, 1);
+    traceOrigin = now_ns();
+    atomic_store_explicit(&traceEnabled, true, memory_order_release);
+    return true;
+}
+
+static TraceBuffer* local_buffer(void) {
+    unsigned int generation = atomic_load_explicit(&traceGeneration, memory_order_relaxed);
+    if (localBuffer && localGeneration == generation) return localBuffer;
+    TraceBuffer* buffer = (TraceBuffer*)calloc(1, sizeof(TraceBuffer));
+    if (!buffer) return NULL;
+    atomic_init(&buffer->count, 0);
+    atomic_init(&buffer->dropped, 0);
+    buffer->tid = atomic_fetch_add(&nextThreadId, 1);
+    TraceBuffer* head = atomic_load(&traceBuffers);
+    do {
+        buffer->next = head;
+    } while (!atomic_compare_exchange_weak(&traceBuffers, &head, buffer));
+    localBuffer = buffer;
+    localGeneration = generation;
+    return buffer;
+}
+
+void trace_record(const char* name, char phase) {
+    TraceBuffer* buffer = local_buffer();
+    if (!buffer) return;
+    unsigned int count = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    unsigned int chunk = count / TRACE_CHUNK_EVENTS;
+    if (chunk >= TRACE_MAX_CHUNKS) {
+        atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    if (!buffer->chunks[chunk]) {
+        buffer->chunks[chunk] = (TraceEvent*)malloc(sizeof(TraceEvent) * TRACE_CHUNK_EVENTS);
+        if (!buffer->chunks[chunk]) {
+            atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+            return;
+        }
+    }
+    TraceEvent* event = &buffer->chunks[chunk][count % TRACE_CHUNK_EVENTS];
+    event->name = name;
+    event->time = now_ns() - traceOrigin;
+    event->phase = phase;
+    atomic_store_explicit(&buffer->count, count + 1, memory_order_release);
+}
+
+void trace_thread_name(const char* name) {
+    if (!atomic_load_explicit(&traceEnabled, memory_order_relaxed)) return;
+    TraceBuffer* buffer = local_buffer();
+    if (buffer) buffer->name = name;
+}
+
+static void write_separator(FILE* f, bool* first) {
+    if (!*first) fputs(",\n", f);
+    *first = false;
+}
+
+bool trace_stop(unsigned long long* written, unsigned long long* dropped) {
+    if (!atomic_exchange(&traceEnabled, false)) return false;
+    unsigned long long events = 0;
+    unsigned long long lost = 0;
+    FILE* f = traceFile;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+    bool first = true;
+    write_separator(f, &first);
+    fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"pacman\"}}", f);
+    TraceBuffer* buffer = atomic_exchange(&traceBuffers, NULL);
+    while (buffer) {
+        if (buffer->name) {
+            write_separator(f, &first);
+            fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    buffer->tid, buffer->name);
+        }
+        unsigned int count = atomic_load_explicit(&buffer->count, memory_order_acquire);
+        for (unsigned int i = 0; i < count; i++) {
+            const TraceEvent* event = &buffer->chunks[i / TRACE_CHUNK_EVENTS][i % TRACE_CHUNK_EVENTS];
+            write_separator(f, &first);
+            fprintf(f, "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+                    event->name, event->phase, (double)event->time / 1000.0, buffer->tid);
+        }
+        events += count;
+        lost += atomic_load(&buffer->dropped);
+        TraceBuffer* next = buffer->next;
+        for (int i = 0; i < TRACE_MAX_CHUNKS; i++) free(buffer->chunks[i]);
+        free(buffer);
+        buffer = next;
+    }
+    fputs("\n]}\n", f);
+    bool ok = !ferror(f);
+    ok = fclose(f) == 0 && ok;
+    traceFile = NULL;
+    localBuffer = NULL;
+    if (written) *written = events;
+    if (dropped) *dropped = lost;
+    return ok;
+}
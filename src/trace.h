@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#define TRACE_CHUNK_EVENTS 16384
+#define TRACE_MAX_CHUNKS 256
+
+// Linha do tempo opcional no formato Trace Event do Chrome (abre em
+// chrome://tracing e no Perfetto). Cada thread grava pares begin/end no seu
+// proprio buffer, sem locks: so ela escreve, e o total publicado com
+// release diz ao flush ate onde ler. Os buffers crescem em blocos de
+// TRACE_CHUNK_EVENTS ate TRACE_MAX_CHUNKS; depois disso os eventos sao
+// descartados e contados.
+extern atomic_bool traceEnabled;
+
+bool trace_start(const char* path);
+// Grava o JSON e libera os buffers. Chamar depois de parar as threads que
+// gravaram eventos. written e dropped podem ser NULL.
+bool trace_stop(unsigned long long* written, unsigned long long* dropped);
+// name precisa continuar valido ate trace_stop (use literais).
+void trace_record(const char* name, char phase);
+void trace_thread_name(const char* name);
+
+static inline void trace_begin(const char* name) {
+    if (atomic_load_explicit(&traceEnabled, memory_order_relaxed)) trace_record(name, 'B');
+}
+
+static inline void trace_end(const char* name) {
+    if (atomic_load_explicit(&traceEnabled, memory_order_relaxed)) trace_record(name, 'E');
+}
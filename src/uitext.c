@@ -0,0 +1,68 @@
+#include "uitext.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static void measure(UiText* text, int fontSize) {
+    text->fontSize = fontSize;
+    text->width = MeasureText(text->source ? text->source : text->text, fontSize);
+    text->valid = true;
+}
+
+void ui_text_printf(UiText* text, int fontSize, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text->text, sizeof(text->text), format, args);
+    va_end(args);
+    text->source = NULL;
+    measure(text, fontSize);
+}
+
+// Para textos constantes: guarda so o ponteiro, sem copiar.
+bool ui_text_label(UiText* text, int fontSize, const char* label) {
+    if (text->valid && text->source == label && text->fontSize == fontSize) return false;
+    text->source = label;
+    measure(text, fontSize);
+    return true;
+}
+
+bool ui_text_bind_int(UiText* text, int fontSize, const char* format, int value) {
+    if (text->valid && text->fontSize == fontSize && text->boundInt[0] == value) return false;
+    text->boundInt[0] = value;
+    ui_text_printf(text, fontSize, format, value);
+    return true;
+}
+
+bool ui_text_bind_int2(UiText* text, int fontSize, const char* format, int a, int b) {
+    if (text->valid && text->fontSize == fontSize && text->boundInt[0] == a && text->boundInt[1] == b) {
+        return false;
+    }
+    text->boundInt[0] = a;
+    text->boundInt[1] = b;
+    ui_text_printf(text, fontSize, format, a, b);
+    return true;
+}
+
+bool ui_text_bind_float(UiText* text, int fontSize, const char* format, float value) {
+    if (text->valid && text->fontSize == fontSize && text->boundFloat == value) return false;
+    text->boundFloat = value;
+    ui_text_printf(text, fontSize, format, (double)value);
+    return true;
+}
+
+bool ui_text_bind_string(UiText* text, int fontSize, const char* value) {
+    if (text->valid && !text->source && text->fontSize == fontSize && strcmp(text->text, value) == 0) {
+        return false;
+    }
+    ui_text_printf(text, fontSize, "%s", value);
+    return true;
+}
+
+void ui_text_draw(const UiText* text, int x, int y, Color color) {
+    if (!text->valid) return;
+    DrawText(text->source ? text->source : text->text, x, y, text->fontSize, color);
+}
+
+void ui_text_draw_centered(const UiText* text, int centerX, int y, Color color) {
+    ui_text_draw(text, centerX - text->width / 2, y, color);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include "raylib.h"
+
+#define UI_TEXT_CAPACITY 96
+
+// Texto retido da interface: guarda a string formatada e a largura medida
+// e so refaz snprintf/MeasureText quando o valor ligado (ou o tamanho da
+// fonte) muda. As funcoes bind retornam true quando o texto foi refeito.
+typedef struct {
+    char text[UI_TEXT_CAPACITY];
+    const char* source;
+    int fontSize;
+    int width;
+    int boundInt[2];
+    float boundFloat;
+    bool valid;
+} UiText;
+
+void ui_text_printf(UiText* text, int fontSize, const char* format, ...);
+bool ui_text_label(UiText* text, int fontSize, const char* label);
+bool ui_text_bind_int(UiText* text, int fontSize, const char* format, int value);
+bool ui_text_bind_int2(UiText* text, int fontSize, const char* format, int a, int b);
+bool ui_text_bind_float(UiText* text, int fontSize, const char* format, float value);
+bool ui_text_bind_string(UiText* text, int fontSize, const char* value);
+void ui_text_draw(const UiText* text, int x, int y, Color color);
+void ui_text_draw_centered(const UiText* text, int centerX, int y, Color color);
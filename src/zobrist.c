@@ -0,0 +1,86 @@
+#include "zobrist.h"
+#include "game.h"
+
+typedef enum {
+    ZOBRIST_WALL = 1,
+    ZOBRIST_PELLET,
+    ZOBRIST_POWER_PELLET,
+    ZOBRIST_PORTAL,
+    ZOBRIST_PACMAN,
+    ZOBRIST_GHOST,
+    ZOBRIST_GHOST_DEAD,
+    ZOBRIST_POWERED,
+    ZOBRIST_LIVES,
+    ZOBRIST_SCORE,
+    ZOBRIST_LEVEL
+} ZobristKind;
+
+static uint64_t key(ZobristKind kind, uint32_t a, uint32_t b) {
+    uint64_t x = ((uint64_t)kind << 56) ^ ((uint64_t)a << 24) ^ (uint64_t)b;
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+static uint32_t cell_index(Position pos) {
+    return ((uint32_t)pos.row << 16) ^ (uint32_t)pos.col;
+}
+
+uint64_t zobrist_tile(int row, int col, char cell) {
+    uint32_t index = cell_index((Position){row, col});
+    switch (cell) {
+        case '#': return key(ZOBRIST_WALL, index, 0);
+        case '.': return key(ZOBRIST_PELLET, index, 0);
+        case 'o': return key(ZOBRIST_POWER_PELLET, index, 0);
+        case 'T': return key(ZOBRIST_PORTAL, index, 0);
+        default: return 0;
+    }
+}
+
+uint64_t zobrist_pacman(int index, Position pos) {
+    return key(ZOBRIST_PACMAN, cell_index(pos), (uint32_t)index);
+}
+
+uint64_t zobrist_ghost(int index, Position pos, bool alive) {
+    return key(alive ? ZOBRIST_GHOST : ZOBRIST_GHOST_DEAD, cell_index(pos), (uint32_t)index);
+}
+
+uint64_t zobrist_powered(bool powered) {
+    return powered ? key(ZOBRIST_POWERED, 0, 0) : 0;
+}
+
+uint64_t zobrist_lives(int lives) {
+    return key(ZOBRIST_LIVES, 0, (uint32_t)lives);
+}
+
+uint64_t zobrist_score(int score) {
+    return key(ZOBRIST_SCORE, 0, (uint32_t)score);
+}
+
+uint64_t zobrist_level(int level) {
+    return key(ZOBRIST_LEVEL, 0, (uint32_t)level);
+}
+
+uint64_t zobrist_hash(const GameState* game) {
+    uint64_t hash = 0;
+    const Map* map = &game->map;
+    if (map->grid) {
+        for (int row = 0; row < map->rows; row++) {
+            for (int col = 0; col < map->cols; col++) {
+                hash ^= zobrist_tile(row, col, map_tile(map, row, col));
+            }
+        }
+    }
+    for (int i = 0; i < game->playerCount; i++) {
+        if (game->players[i].active) hash ^= zobrist_pacman(i, game->players[i].pos);
+    }
+    for (int i = 0; i < game->ghostCount && game->ghosts; i++) {
+        hash ^= zobrist_ghost(i, game->ghosts[i].pos, game->ghosts[i].alive);
+    }
+    hash ^= zobrist_powered(game->powered);
+    hash ^= zobrist_lives(game->lives);
+    hash ^= zobrist_score(game->score);
+    hash ^= zobrist_level(game->level);
+    return hash;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "entity.h"
+
+struct GameState;
+
+// Chaves Zobrist derivadas por splitmix64 de (tipo, a, b): nao ha tabela
+// para dimensionar, entao qualquer tamanho de mapa funciona. O hash do
+// estado e o XOR das chaves de cada tile ocupado, jogadores ativos,
+// fantasmas (posicao e se estao vivos), power mode, vidas, score e nivel.
+uint64_t zobrist_tile(int row, int col, char cell);
+uint64_t zobrist_pacman(int index, Position pos);
+uint64_t zobrist_ghost(int index, Position pos, bool alive);
+uint64_t zobrist_powered(bool powered);
+uint64_t zobrist_lives(int lives);
+uint64_t zobrist_score(int score);
+uint64_t zobrist_level(int level);
+uint64_t zobrist_hash(const struct GameState* game);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdio.h>
+
+// Verificacao minima para os testes em tests/: cada falha e impressa com
+// arquivo e linha e o main retorna test_report() (0 se tudo passou).
+static int testFailures = 0;
+static int testChecks = 0;
+
+#define CHECK(cond)                                                           \
+    do {                                                                      \
+        testChecks++;                                                         \
+        if (!(cond)) {                                                        \
+            testFailures++;                                                   \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+        }                                                                     \
+    } while (0)
+
+static inline int test_report(const char* name) {
+    printf("%s: %d verificacoes, %d falhas\n", name, testChecks, testFailures);
+    return testFailures == 0 ? 0 : 1;
+}
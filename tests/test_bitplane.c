@@ -0,0 +1,117 @@
+#include "bitplane.h"
+#include "game.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BITPLANE_TICKS 3000
+#define SWAP_TICK 1500
+
+static const Direction kDirs[4] = {DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT};
+
+// Janelas testadas: grade inteira, recorte pequeno e um recorte com mais
+// de 64 colunas (duas palavras por linha, com borda fora do mapa).
+static const int kWindows[][2] = {{0, 0}, {21, 21}, {100, 7}};
+#define WINDOWS (int)(sizeof(kWindows) / sizeof(kWindows[0]))
+
+static bool bit_at(const uint64_t* planes, const BitplaneEncoder* enc, int plane, int row, int col) {
+    const uint64_t* line = planes + ((size_t)plane * enc->height + row) * enc->rowWords;
+    return (line[col / 64] >> (col % 64)) & 1u;
+}
+
+// Confere a grade inteira tile a tile contra o mapa e as entidades.
+static bool matches_game(const uint64_t* planes, const BitplaneEncoder* enc, const GameState* game) {
+    const Map* map = &game->map;
+    for (int row = 0; row < enc->height; row++) {
+        for (int col = 0; col < enc->width; col++) {
+            bool inside = row < map->rows && col < map->cols;
+            char cell = inside ? map_get(map, row, col) : '#';
+            if (bit_at(planes, enc, BITPLANE_WALL, row, col) != (cell == '#')) return false;
+            if (bit_at(planes, enc, BITPLANE_PELLET, row, col) != (cell == '.')) return false;
+            if (bit_at(planes, enc, BITPLANE_POWER, row, col) != (cell == 'o')) return false;
+            if (bit_at(planes, enc, BITPLANE_PORTAL, row, col) != (cell == 'T')) return false;
+        }
+    }
+    Position pac = game->players[0].pos;
+    if (!bit_at(planes, enc, BITPLANE_PACMAN, pac.row, pac.col)) return false;
+    for (int i = 0; i < game->ghostCount; i++) {
+        const Ghost* ghost = &game->ghosts[i];
+        if (!ghost->alive) continue;
+        int plane = game_ghost_vulnerable(game, ghost) ? BITPLANE_GHOST_VULNERABLE : BITPLANE_GHOST;
+        if (!bit_at(planes, enc, plane, ghost->pos.row, ghost->pos.col)) return false;
+    }
+    return true;
+}
+
+static int count_plane(const uint64_t* planes, const BitplaneEncoder* enc, int plane) {
+    int count = 0;
+    for (int row = 0; row < enc->height; row++) {
+        for (int col = 0; col < enc->width; col++) count += bit_at(planes, enc, plane, row, col);
+    }
+    return count;
+}
+
+// Os codificadores incrementais (que so reescrevem os tiles alterados)
+// tem que dar, em todo tick, os mesmos planos que um codificador novo,
+// inclusive depois de trocar de mapa no meio da partida.
+int main(void) {
+    static GameState game;
+    CHECK(game_init(&game, "assets/maps/mapa1.txt", 4));
+    game_seed(&game, 11);
+    game_start_new(&game);
+    game.lives = 1000;
+    game.players[0].lives = 1000;
+
+    BitplaneEncoder incremental[WINDOWS];
+    uint64_t* kept[WINDOWS];
+    uint64_t* fresh[WINDOWS];
+    for (int w = 0; w < WINDOWS; w++) {
+        CHECK(bitplane_init(&incremental[w], kWindows[w][0], kWindows[w][1]));
+        size_t bytes = bitplane_words(&incremental[w]) * sizeof(uint64_t);
+        kept[w] = (uint64_t*)malloc(bytes);
+        fresh[w] = (uint64_t*)malloc(bytes);
+    }
+    bitplane_encode(&incremental[0], &game, kept[0]);
+    int pelletsBefore = count_plane(kept[0], &incremental[0], BITPLANE_PELLET);
+    CHECK(pelletsBefore == game.pelletsRemaining - count_plane(kept[0], &incremental[0], BITPLANE_POWER));
+
+    srand(2);
+    int mismatches = 0;
+    int wrongTiles = 0;
+    bool swapped = false;
+    for (int tick = 0; tick < BITPLANE_TICKS && game.running; tick++) {
+        if (tick % 15 == 0) {
+            game.players[0].pendingDir = kDirs[rand() % 4];
+            game.players[0].pendingTime = 0;
+        }
+        if (tick == SWAP_TICK) swapped = game_load_level(&game, "assets/maps/mapa2.txt");
+        if (game.phase != GAME_PHASE_PLAYING) game_start_new(&game);
+        game_update(&game, SIM_TICK_DT);
+        if (tick == SWAP_TICK / 2) {
+            int pelletsNow = count_plane(kept[0], &incremental[0], BITPLANE_PELLET);
+            CHECK(pelletsNow < pelletsBefore);
+        }
+
+        for (int w = 0; w < WINDOWS; w++) {
+            bitplane_encode(&incremental[w], &game, kept[w]);
+            BitplaneEncoder once;
+            bitplane_init(&once, kWindows[w][0], kWindows[w][1]);
+            bitplane_encode(&once, &game, fresh[w]);
+            bitplane_free(&once);
+            size_t bytes = bitplane_words(&incremental[w]) * sizeof(uint64_t);
+            if (memcmp(kept[w], fresh[w], bytes) != 0) mismatches++;
+        }
+        if (tick % 50 == 0 && !matches_game(kept[0], &incremental[0], &game)) wrongTiles++;
+    }
+    CHECK(swapped);
+    CHECK(mismatches == 0);
+    CHECK(wrongTiles == 0);
+
+    for (int w = 0; w < WINDOWS; w++) {
+        bitplane_free(&incremental[w]);
+        free(kept[w]);
+        free(fresh[w]);
+    }
+    game_shutdown(&game);
+    return test_report("bitplane");
+}
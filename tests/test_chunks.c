@@ -0,0 +1,167 @@
+#include "chunks.h"
+#include "memtrack.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MAP_SIDE (10 * CHUNK_SIZE)
+#define GHOSTS 300
+#define MOVES 20000
+
+static Ghost ghosts[GHOSTS];
+static int seen[GHOSTS];
+
+static Position random_pos(void) {
+    return (Position){rand() % MAP_SIDE, rand() % MAP_SIDE};
+}
+
+static int chunk_distance(Position a, Position b) {
+    int rows = abs(a.row / CHUNK_SIZE - b.row / CHUNK_SIZE);
+    int cols = abs(a.col / CHUNK_SIZE - b.col / CHUNK_SIZE);
+    return rows > cols ? rows : cols;
+}
+
+// Cada bloco lista exatamente os fantasmas que estao nele, em ordem de
+// indice, com prev/next coerentes nos dois sentidos.
+static bool lists_match(const ChunkGrid* grid) {
+    int listed = 0;
+    for (int chunk = 0; chunk < grid->rows * grid->cols; chunk++) {
+        int prev = -1;
+        for (int i = grid->head[chunk]; i >= 0; i = grid->next[i]) {
+            if (i <= prev || grid->prev[i] != prev) return false;
+            if (grid->ghostChunk[i] != chunk || chunk_of(grid, ghosts[i].pos) != chunk) return false;
+            prev = i;
+            listed++;
+        }
+    }
+    int expected = 0;
+    for (int i = 0; i < GHOSTS; i++) {
+        if (chunk_of(grid, ghosts[i].pos) >= 0) expected++;
+    }
+    return listed == expected;
+}
+
+static void test_relink(ChunkGrid* grid, const Map* map) {
+    srand(9);
+    for (int i = 0; i < GHOSTS; i++) {
+        ghosts[i].pos = random_pos();
+        ghosts[i].alive = true;
+    }
+    CHECK(chunk_grid_reset(grid, map, ghosts, GHOSTS));
+    CHECK(grid->enabled);
+    CHECK(lists_match(grid));
+
+    bool consistent = true;
+    for (int move = 0; move < MOVES; move++) {
+        int i = rand() % GHOSTS;
+        // Alguns saem da grade (portal, morte) e voltam depois.
+        Position pos = rand() % 50 == 0 ? (Position){-1, -1} : random_pos();
+        if (rand() % 2 && chunk_of(grid, ghosts[i].pos) >= 0) {
+            pos = ghosts[i].pos;
+            pos.col = pos.col + 1 < MAP_SIDE ? pos.col + 1 : pos.col - 1;
+        }
+        ghosts[i].pos = pos;
+        chunk_grid_move(grid, i, pos);
+        if (move % 500 == 0) consistent = consistent && lists_match(grid);
+    }
+    CHECK(consistent);
+    CHECK(lists_match(grid));
+}
+
+// Ate CHUNK_ACTIVE_RADIUS blocos do jogador mais proximo o fantasma entra
+// em todo tick com IA completa; ate CHUNK_LOD_RADIUS entra em 1 de cada
+// CHUNK_LOD_DIVISOR ticks; alem disso dorme. Mortos nunca entram.
+static bool gather_matches(ChunkGrid* grid, const Pacman* players, int playerCount) {
+    int fullTicks[GHOSTS] = {0};
+    memset(seen, 0, sizeof(seen));
+    for (int tick = 0; tick < CHUNK_LOD_DIVISOR; tick++) {
+        int activeCount = 0;
+        int count = chunk_grid_gather(grid, ghosts, players, playerCount, &activeCount);
+        for (int k = 0; k < count; k++) {
+            int i = grid->work[k];
+            seen[i]++;
+            if (k < activeCount) fullTicks[i]++;
+        }
+    }
+    for (int i = 0; i < GHOSTS; i++) {
+        if (chunk_of(grid, ghosts[i].pos) < 0) {
+            if (seen[i] != 0) return false;
+            continue;
+        }
+        int dist = 1 << 20;
+        for (int p = 0; p < playerCount; p++) {
+            int d = chunk_distance(ghosts[i].pos, players[p].pos);
+            if (players[p].active && d < dist) dist = d;
+        }
+        int wantSeen = 0;
+        int wantFull = 0;
+        if (ghosts[i].alive && dist <= CHUNK_ACTIVE_RADIUS) wantSeen = wantFull = CHUNK_LOD_DIVISOR;
+        else if (ghosts[i].alive && dist <= CHUNK_LOD_RADIUS) wantSeen = 1;
+        if (seen[i] != wantSeen || fullTicks[i] != wantFull) return false;
+        int reported = chunk_grid_nearest_player(grid, ghosts[i].pos);
+        if (dist <= CHUNK_LOD_RADIUS) {
+            if (reported < 0 || chunk_distance(ghosts[i].pos, players[reported].pos) != dist) return false;
+        } else if (reported != -1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_lod(ChunkGrid* grid) {
+    for (int i = 0; i < GHOSTS; i++) {
+        ghosts[i].pos = random_pos();
+        ghosts[i].alive = i % 7 != 0;
+        chunk_grid_move(grid, i, ghosts[i].pos);
+    }
+    Pacman players[3];
+    memset(players, 0, sizeof(players));
+    players[0].active = true;
+    players[0].pos = (Position){5, 5};
+    CHECK(gather_matches(grid, players, 1));
+
+    // O jogador atravessa o mapa: quem dormia e promovido e quem ficou
+    // para tras volta a dormir.
+    players[0].pos = (Position){MAP_SIDE - 3, MAP_SIDE - 3};
+    CHECK(gather_matches(grid, players, 1));
+
+    // Com varios jogadores os aneis se unem; um inativo nao conta.
+    players[1].active = true;
+    players[1].pos = (Position){MAP_SIDE / 2, 2};
+    players[2].active = false;
+    players[2].pos = (Position){2, MAP_SIDE - 2};
+    CHECK(gather_matches(grid, players, 3));
+}
+
+// Um mapa que cabe inteiro no raio ativo desliga o LOD.
+static void test_small_map(void) {
+    ChunkGrid grid;
+    chunk_grid_init(&grid);
+    Map small = {0};
+    small.rows = (2 * CHUNK_ACTIVE_RADIUS + 1) * CHUNK_SIZE;
+    small.cols = small.rows;
+    Ghost one = {0};
+    one.alive = true;
+    CHECK(chunk_grid_reset(&grid, &small, &one, 1));
+    CHECK(!grid.enabled);
+    CHECK(chunk_grid_path_depth(&grid) == 0);
+    chunk_grid_free(&grid);
+}
+
+int main(void) {
+    ChunkGrid grid;
+    chunk_grid_init(&grid);
+    Map map = {0};
+    map.rows = MAP_SIDE;
+    map.cols = MAP_SIDE;
+    test_relink(&grid, &map);
+    test_lod(&grid);
+    CHECK(chunk_grid_path_depth(&grid) == CHUNK_PATH_DEPTH);
+    chunk_grid_free(&grid);
+    test_small_map();
+
+    MemStats stats;
+    mem_stats(MEM_TAG_ENTITIES, &stats);
+    CHECK(stats.blocks == 0);
+    return test_report("chunks");
+}
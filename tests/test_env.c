@@ -0,0 +1,90 @@
+#include "env.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define GAMES 8
+#define STEPS 1500
+
+static uint8_t obsA[GAMES * ENV_OBS_SIZE];
+static uint8_t obsB[GAMES * ENV_OBS_SIZE];
+static uint8_t baseObs[ENV_OBS_SIZE];
+
+static int count_cells(const uint8_t* obs, uint8_t code) {
+    int count = 0;
+    for (int i = 0; i < ENV_OBS_SIZE; i++) {
+        if (obs[i] == code) count++;
+    }
+    return count;
+}
+
+// O reset devolve a observacao do jogo base em todos os ambientes, com um
+// Pac-Man so, na posicao inicial do mapa.
+static void test_reset(VecEnv* env) {
+    env_reset_batch(env, obsA);
+    env_write_observation(&env->base, baseObs);
+    Position start = env->base.map.pacmanStart;
+    CHECK(baseObs[start.row * ENV_OBS_COLS + start.col] == ENV_CELL_PACMAN);
+    CHECK(count_cells(baseObs, ENV_CELL_PACMAN) == 1);
+    CHECK(count_cells(baseObs, ENV_CELL_PELLET) > 0);
+    for (int i = 0; i < GAMES; i++) {
+        CHECK(memcmp(obsA + (size_t)i * ENV_OBS_SIZE, baseObs, ENV_OBS_SIZE) == 0);
+    }
+}
+
+// Mesma semente e mesmas acoes dao o mesmo lote passo a passo, com 1 ou 4
+// threads; os episodios que terminam recomecam do zero.
+static void test_determinism(void) {
+    static VecEnv serial;
+    static VecEnv pooled;
+    CHECK(env_init(&serial, GAMES, 1, 77));
+    CHECK(env_init(&pooled, GAMES, 4, 77));
+    test_reset(&serial);
+    env_reset_batch(&pooled, obsB);
+    CHECK(memcmp(obsA, obsB, sizeof(obsA)) == 0);
+
+    int32_t actions[GAMES];
+    float rewardA[GAMES], rewardB[GAMES];
+    uint8_t doneA[GAMES], doneB[GAMES];
+    uint64_t hashA[GAMES], hashB[GAMES];
+    bool pendingReset[GAMES] = {false};
+    bool sameObs = true, sameReward = true, sameDone = true, sameHash = true, restarted = true;
+    int episodes = 0;
+    float totalReward = 0.0f;
+    srand(3);
+    for (int step = 0; step < STEPS; step++) {
+        for (int i = 0; i < GAMES; i++) actions[i] = rand() % (DIR_RIGHT + 1);
+        env_step_batch(&serial, actions, obsA, rewardA, doneA);
+        env_step_batch(&pooled, actions, obsB, rewardB, doneB);
+        env_state_hashes(&serial, hashA);
+        env_state_hashes(&pooled, hashB);
+        sameObs = sameObs && memcmp(obsA, obsB, sizeof(obsA)) == 0;
+        for (int i = 0; i < GAMES; i++) {
+            sameReward = sameReward && rewardA[i] == rewardB[i];
+            sameDone = sameDone && doneA[i] == doneB[i];
+            sameHash = sameHash && hashA[i] == hashB[i];
+            // O passo depois do fim reinicia e joga: o score e so o dele.
+            if (pendingReset[i]) {
+                restarted = restarted && serial.games[i].players[0].score == (int)rewardA[i];
+            }
+            pendingReset[i] = doneA[i] != 0;
+            if (doneA[i]) episodes++;
+            totalReward += rewardA[i];
+        }
+    }
+    CHECK(sameObs);
+    CHECK(sameReward);
+    CHECK(sameDone);
+    CHECK(sameHash);
+    CHECK(restarted);
+    CHECK(episodes > 0);
+    CHECK(totalReward > 0.0f);
+
+    env_shutdown(&serial);
+    env_shutdown(&pooled);
+}
+
+int main(void) {
+    test_determinism();
+    return test_report("env");
+}
@@ -0,0 +1,71 @@
+#include "game.h"
+#include "test.h"
+#include <string.h>
+
+#define EVENTS_TICKS 20000
+
+static GameEvent drained[EVENT_RING_SIZE];
+
+static int drain(GameState* game, GameEventType type, int* value) {
+    int found = 0;
+    int count = game_drain_events(game, drained, EVENT_RING_SIZE);
+    for (int i = 0; i < count; i++) {
+        if (drained[i].type != type) continue;
+        found++;
+        if (value) *value = drained[i].value;
+    }
+    return found;
+}
+
+// Com asyncEvents a simulacao nao escreve texto no HUD: so emite eventos,
+// e o texto aparece quando a fila e esvaziada (e some com o evento de
+// limpeza, HUD_MESSAGE_TIME depois).
+int main(void) {
+    static GameState game;
+    CHECK(game_init(&game, "assets/maps/mapa1.txt", 4));
+    game.asyncEvents = true;
+    game_seed(&game, 4);
+
+    game_start_new(&game);
+    CHECK(game.hudMessage[0] == '\0');
+    CHECK(drain(&game, GAME_EVENT_HUD_MESSAGE, NULL) == 1);
+    CHECK(strcmp(game.hudMessage, "Novo jogo iniciado!") == 0);
+
+    int clearTick = -1;
+    bool clearedEarly = false;
+    int ticks = (int)(HUD_MESSAGE_TIME / SIM_TICK_DT) + 10;
+    for (int tick = 0; tick < ticks && clearTick < 0; tick++) {
+        game_update(&game, SIM_TICK_DT);
+        clearedEarly = clearedEarly || game.hudMessage[0] == '\0';
+        if (drain(&game, GAME_EVENT_HUD_CLEAR, NULL) > 0) clearTick = tick;
+    }
+    CHECK(!clearedEarly);
+    CHECK(clearTick >= (int)(HUD_MESSAGE_TIME / SIM_TICK_DT) - 2);
+    CHECK(game.hudMessage[0] == '\0');
+
+    // Fim de jogo: o texto sai do proprio evento (recorde ou Game Over).
+    game.players[0].lives = 1;
+    game.lives = 1;
+    int rankPos = -2;
+    int endTick = -1;
+    for (int tick = 0; tick < EVENTS_TICKS && endTick < 0; tick++) {
+        game_update(&game, SIM_TICK_DT);
+        if (game.phase != GAME_PHASE_PLAYING) {
+            CHECK(game.hudMessage[0] == '\0');
+            endTick = tick;
+        }
+        drain(&game, GAME_EVENT_GAME_OVER, &rankPos);
+    }
+    CHECK(endTick >= 0);
+    CHECK(rankPos >= -1);
+    if (rankPos >= 0) {
+        CHECK(game.phase == GAME_PHASE_ENTER_SCORE);
+        CHECK(strcmp(game.hudMessage, "Novo recorde! Digite seu nome e ENTER.") == 0);
+    } else {
+        CHECK(game.phase == GAME_PHASE_GAMEOVER);
+        CHECK(strcmp(game.hudMessage, "Game Over!") == 0);
+    }
+
+    game_shutdown(&game);
+    return test_report("events");
+}
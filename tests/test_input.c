@@ -0,0 +1,74 @@
+#include "game.h"
+#include "raylib.h"
+#include "test.h"
+#include <stdlib.h>
+
+#define IDLE_TICKS 120
+#define MOVE_TICKS 60
+
+static double tick(GameState* game, double now) {
+    now += SIM_TICK_DT;
+    game->input.tickTime = now;
+    game_update(game, SIM_TICK_DT);
+    game->input.eventCount = 0;
+    game->input.eventRead = 0;
+    return now;
+}
+
+// Para na primeira vida perdida: um fantasma manda o jogador de volta ao
+// inicio, o que nao e passo.
+static int count_steps(GameState* game, double* now, int ticks, int* maxPerTick) {
+    int steps = 0;
+    int lives = game->lives;
+    *maxPerTick = 0;
+    for (int i = 0; i < ticks; i++) {
+        Position before = game->players[0].pos;
+        *now = tick(game, *now);
+        if (game->lives != lives) break;
+        Position after = game->players[0].pos;
+        int moved = abs(after.row - before.row) + abs(after.col - before.col);
+        if (moved > *maxPerTick) *maxPerTick = moved;
+        steps += moved;
+    }
+    return steps;
+}
+
+// Parado por alguns segundos e depois uma tecla entre dois ticks: o passo
+// sai no tick seguinte (latencia > 0 e menor que um intervalo de passo) e
+// o tempo parado nao vira uma rajada de passos.
+int main(void) {
+    static GameState game;
+    CHECK(game_init(&game, "assets/maps/mapa1.txt", 0));
+    game_start_new(&game);
+    CHECK(game.phase == GAME_PHASE_PLAYING);
+
+    double now = 100.0;
+    int maxPerTick = 0;
+    Position start = game.players[0].pos;
+    CHECK(count_steps(&game, &now, IDLE_TICKS, &maxPerTick) == 0);
+    CHECK(game.players[0].moveTimer <= PACMAN_STEP_INTERVAL);
+
+    Direction dir = DIR_NONE;
+    int key = 0;
+    if (map_get(&game.map, start.row, start.col - 1) != '#') {
+        dir = DIR_LEFT;
+        key = KEY_LEFT;
+    } else if (map_get(&game.map, start.row, start.col + 1) != '#') {
+        dir = DIR_RIGHT;
+        key = KEY_RIGHT;
+    }
+    CHECK(dir != DIR_NONE);
+    game.input.events[0] = (InputEvent){.key = key, .time = now + SIM_TICK_DT * 0.25};
+    game.input.eventCount = 1;
+
+    int steps = count_steps(&game, &now, MOVE_TICKS, &maxPerTick);
+    CHECK(maxPerTick <= 1);
+    CHECK(steps >= 1);
+    CHECK(steps <= 1 + (int)(MOVE_TICKS * SIM_TICK_DT / PACMAN_STEP_INTERVAL));
+    CHECK(game.inputLatency.count == 1);
+    CHECK(game.inputLatency.maxMs > 0.0);
+    CHECK(game.inputLatency.maxMs < PACMAN_STEP_INTERVAL * 1000.0);
+
+    game_shutdown(&game);
+    return test_report("input");
+}
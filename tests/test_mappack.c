@@ -0,0 +1,131 @@
+#include "map.h"
+#include "mappack.h"
+#include "memtrack.h"
+#include "test.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utime.h>
+
+static const char* kMaps[] = {"assets/maps/mapa1.txt", "assets/maps/mapa2.txt", "assets/maps/mapa3.txt"};
+#define MAP_FILES (int)(sizeof(kMaps) / sizeof(kMaps[0]))
+
+static bool same_map(const Map* a, const Map* b) {
+    if (a->rows != b->rows || a->cols != b->cols) return false;
+    if (a->pacmanStart.row != b->pacmanStart.row || a->pacmanStart.col != b->pacmanStart.col) return false;
+    if (a->ghostCount != b->ghostCount || a->portalCount != b->portalCount) return false;
+    if (a->pelletsInitial != b->pelletsInitial || b->pelletsRemaining != b->pelletsInitial) return false;
+    for (int i = 0; i < a->ghostCount; i++) {
+        if (a->ghostStarts[i].row != b->ghostStarts[i].row || a->ghostStarts[i].col != b->ghostStarts[i].col) {
+            return false;
+        }
+    }
+    for (int i = 0; i < a->portalCount; i++) {
+        if (a->portals[i].row != b->portals[i].row || a->portals[i].col != b->portals[i].col) return false;
+    }
+    for (int row = 0; row < a->rows; row++) {
+        for (int col = 0; col < a->cols; col++) {
+            if (map_get(a, row, col) != map_get(b, row, col)) return false;
+        }
+    }
+    return true;
+}
+
+static bool decode_modified(const unsigned char* data, size_t size, size_t offset, int value) {
+    unsigned char* copy = (unsigned char*)malloc(size);
+    memcpy(copy, data, size);
+    memcpy(copy + offset, &value, sizeof(value));
+    Map map = {0};
+    bool ok = mapbin_decode(&map, copy, size);
+    if (ok) map_free(&map);
+    free(copy);
+    return ok;
+}
+
+static void test_round_trip(const Map* map) {
+    size_t size = mapbin_size(map);
+    CHECK(size % 8 == 0);
+    unsigned char* data = (unsigned char*)malloc(size);
+    CHECK(mapbin_encode(map, data, size - 1) == 0);
+    CHECK(mapbin_encode(map, data, size) == size);
+
+    Map decoded = {0};
+    CHECK(mapbin_decode(&decoded, data, size));
+    CHECK(same_map(map, &decoded));
+    map_free(&decoded);
+
+    Map rejected = {0};
+    CHECK(!mapbin_decode(&rejected, data, sizeof(MapBinHeader) - 1));
+    CHECK(!mapbin_decode(&rejected, data, sizeof(MapBinHeader)));
+    CHECK(!decode_modified(data, size, offsetof(MapBinHeader, magic), 0));
+    CHECK(!decode_modified(data, size, offsetof(MapBinHeader, pacmanStart), map->rows));
+    CHECK(!decode_modified(data, size, offsetof(MapBinHeader, pacmanStart) + sizeof(int), -1));
+    CHECK(!decode_modified(data, size, offsetof(MapBinHeader, pelletsInitial), -1));
+    CHECK(!decode_modified(data, size, offsetof(MapBinHeader, pelletsInitial), map->rows * map->cols + 1));
+    CHECK(!decode_modified(data, size, offsetof(MapBinHeader, ghostCount), 1 << 20));
+    if (map->ghostCount > 0) CHECK(!decode_modified(data, size, sizeof(MapBinHeader), map->rows + 5));
+    free(data);
+}
+
+static void test_pack(const Map* maps) {
+    const char* path = "test_mappack.pak";
+    CHECK(mappack_write(path, maps, MAP_FILES));
+
+    MapPack pack;
+    CHECK(mappack_open(&pack, path));
+    CHECK(pack.levelCount == MAP_FILES);
+    for (int level = 1; level <= MAP_FILES; level++) {
+        Map loaded = {0};
+        CHECK(mappack_load_level(&pack, level, &loaded));
+        CHECK(same_map(&maps[level - 1], &loaded));
+        map_free(&loaded);
+    }
+    Map missing = {0};
+    CHECK(!mappack_load_level(&pack, MAP_FILES + 1, &missing));
+
+    // Um .txt salvo depois do pacote faz o pacote ser ignorado.
+    const char* source = "test_mappack.txt";
+    FILE* txt = fopen(source, "w");
+    CHECK(txt != NULL);
+    if (txt) {
+        fputs("#\n", txt);
+        fclose(txt);
+        struct utimbuf older = {pack.mtime - 10, pack.mtime - 10};
+        struct utimbuf newer = {pack.mtime + 10, pack.mtime + 10};
+        CHECK(utime(source, &older) == 0);
+        CHECK(!mappack_is_stale(&pack, source));
+        CHECK(utime(source, &newer) == 0);
+        CHECK(mappack_is_stale(&pack, source));
+        remove(source);
+    }
+    CHECK(!mappack_is_stale(&pack, "nao_existe.txt"));
+    mappack_close(&pack);
+
+    FILE* file = fopen(path, "r+b");
+    CHECK(file != NULL);
+    if (file) {
+        fputc('X', file);
+        fclose(file);
+        CHECK(!mappack_open(&pack, path));
+    }
+    remove(path);
+}
+
+int main(void) {
+    Map maps[MAP_FILES];
+    memset(maps, 0, sizeof(maps));
+    for (int i = 0; i < MAP_FILES; i++) {
+        bool loaded = map_load(&maps[i], kMaps[i]);
+        CHECK(loaded);
+        if (!loaded) return test_report("mappack");
+        test_round_trip(&maps[i]);
+    }
+    test_pack(maps);
+    for (int i = 0; i < MAP_FILES; i++) map_free(&maps[i]);
+
+    MemStats stats;
+    mem_stats(MEM_TAG_MAP, &stats);
+    CHECK(stats.current == 0);
+    return test_report("mappack");
+}
@@ -0,0 +1,90 @@
+#include "mazegen.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int count_cells(const char* cells, int size, char value) {
+    int count = 0;
+    for (int i = 0; i < size; i++) {
+        if (cells[i] == value) count++;
+    }
+    return count;
+}
+
+// BFS sem portais a partir do 'P': todo tile que nao e parede tem que ser
+// alcancavel andando pelo labirinto.
+static int unreachable_cells(const char* cells, int rows, int cols) {
+    int size = rows * cols;
+    const char* start = memchr(cells, 'P', (size_t)size);
+    if (!start) return size;
+    char* seen = (char*)calloc((size_t)size, 1);
+    int* queue = (int*)malloc(sizeof(int) * (size_t)size);
+    int head = 0;
+    int tail = 0;
+    queue[tail++] = (int)(start - cells);
+    seen[queue[0]] = 1;
+    while (head < tail) {
+        int current = queue[head++];
+        int row = current / cols;
+        int col = current % cols;
+        const int dr[4] = {-1, 1, 0, 0};
+        const int dc[4] = {0, 0, -1, 1};
+        for (int d = 0; d < 4; d++) {
+            int r = row + dr[d];
+            int c = col + dc[d];
+            if (r < 0 || c < 0 || r >= rows || c >= cols) continue;
+            int next = r * cols + c;
+            if (cells[next] == '#' || seen[next]) continue;
+            seen[next] = 1;
+            queue[tail++] = next;
+        }
+    }
+    int unreachable = 0;
+    for (int i = 0; i < size; i++) {
+        if (cells[i] != '#' && !seen[i]) unreachable++;
+    }
+    free(seen);
+    free(queue);
+    return unreachable;
+}
+
+static void test_maze(int rows, int cols, uint32_t seed) {
+    MazeParams params;
+    maze_default_params(&params, rows, cols, seed);
+    params.portalPairs = 2;
+    params.powerPellets = 8;
+    size_t size = (size_t)rows * (size_t)cols;
+    char* single = (char*)malloc(size);
+    char* threaded = (char*)malloc(size);
+
+    params.threads = 1;
+    CHECK(maze_generate(&params, single));
+    params.threads = 4;
+    CHECK(maze_generate(&params, threaded));
+    CHECK(memcmp(single, threaded, size) == 0);
+
+    int invalid = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (single[i] == '\0' || !strchr("#.oPFT ", single[i])) invalid++;
+    }
+    CHECK(invalid == 0);
+    CHECK(count_cells(single, (int)size, 'P') == 1);
+    CHECK(count_cells(single, (int)size, 'F') == params.ghostCount);
+    CHECK(count_cells(single, (int)size, '.') > 0);
+    CHECK(unreachable_cells(single, rows, cols) == 0);
+    free(single);
+    free(threaded);
+}
+
+int main(void) {
+    test_maze(MAZE_MIN_ROWS, MAZE_MIN_COLS, 1);
+    test_maze(21, 41, 42);
+    test_maze(MAZE_REGION_ROWS * 3 + 5, 77, 7);
+    test_maze(200, 160, 1234);
+
+    MazeParams params;
+    maze_default_params(&params, MAZE_MIN_ROWS - 1, 20, 1);
+    char cells[6 * 20];
+    CHECK(!maze_generate(&params, cells));
+    return test_report("mazegen");
+}
@@ -0,0 +1,176 @@
+#include "game.h"
+#include "pathfind.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define PAIR_SAMPLES 400
+#define CLONE_TICKS 1200
+
+static const Direction kDirs[4] = {DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT};
+
+// BFS de referencia direto sobre map_get, sem a grade com borda.
+static void reference_distances(const Map* map, Position target, int* dist) {
+    int cells = map->rows * map->cols;
+    int* queue = (int*)malloc(sizeof(int) * (size_t)cells);
+    for (int i = 0; i < cells; i++) dist[i] = PATH_UNREACHABLE;
+    int head = 0;
+    int tail = 0;
+    if (map_get(map, target.row, target.col) != '#') {
+        dist[target.row * map->cols + target.col] = 0;
+        queue[tail++] = target.row * map->cols + target.col;
+    }
+    const int dr[4] = {-1, 1, 0, 0};
+    const int dc[4] = {0, 0, -1, 1};
+    while (head < tail) {
+        int current = queue[head++];
+        for (int d = 0; d < 4; d++) {
+            int row = current / map->cols + dr[d];
+            int col = current % map->cols + dc[d];
+            if (!map_in_bounds(map, row, col) || map_get(map, row, col) == '#') continue;
+            int next = row * map->cols + col;
+            if (dist[next] != PATH_UNREACHABLE) continue;
+            dist[next] = dist[current] + 1;
+            queue[tail++] = next;
+        }
+    }
+    free(queue);
+}
+
+static Position random_open(const Map* map) {
+    while (true) {
+        Position pos = {rand() % map->rows, rand() % map->cols};
+        if (map_get(map, pos.row, pos.col) != '#') return pos;
+    }
+}
+
+static bool valid_path(const Map* map, const Position* path, int length, Position from, Position to) {
+    if (path[0].row != from.row || path[0].col != from.col) return false;
+    if (path[length].row != to.row || path[length].col != to.col) return false;
+    for (int i = 0; i <= length; i++) {
+        if (map_get(map, path[i].row, path[i].col) == '#') return false;
+        if (i > 0 && abs(path[i].row - path[i - 1].row) + abs(path[i].col - path[i - 1].col) != 1) return false;
+    }
+    return true;
+}
+
+static void test_distances(const Map* map) {
+    PathService paths;
+    path_service_init(&paths);
+    CHECK(path_service_reset(&paths, map));
+    int cells = map->rows * map->cols;
+    int* expected = (int*)malloc(sizeof(int) * (size_t)cells);
+    Position* path = (Position*)malloc(sizeof(Position) * (size_t)cells);
+    PathTable table = {0};
+    CHECK(path_table_build(&table, &paths, map));
+
+    int wrongBfs = 0;
+    int wrongTracked = 0;
+    int wrongTable = 0;
+    int wrongAstar = 0;
+    for (int i = 0; i < PAIR_SAMPLES; i++) {
+        Position from = random_open(map);
+        Position to = random_open(map);
+        reference_distances(map, to, expected);
+        int want = expected[from.row * map->cols + from.col];
+        if (path_distance(&paths, map, from, to) != want) wrongBfs++;
+        if (path_tracked_distance(&paths, map, i % PATH_TRACKED_FIELDS, from, to) != want) wrongTracked++;
+        int length = path_astar(&paths, map, from, to, path, cells);
+        if (length != want || (length >= 0 && !valid_path(map, path, length, from, to))) wrongAstar++;
+        paths.table = &table;
+        if (path_distance(&paths, map, from, to) != want) wrongTable++;
+        paths.table = NULL;
+    }
+    CHECK(wrongBfs == 0);
+    CHECK(wrongTracked == 0);
+    CHECK(wrongAstar == 0);
+    CHECK(wrongTable == 0);
+
+    // Um campo acompanhado so e refeito quando o alvo troca de tile.
+    Position from = random_open(map);
+    Position to = random_open(map);
+    path_tracked_distance(&paths, map, 0, from, to);
+    unsigned long long misses = paths.misses;
+    path_tracked_distance(&paths, map, 0, random_open(map), to);
+    CHECK(paths.misses == misses);
+
+    Position wall = {0, 0};
+    CHECK(map_get(map, wall.row, wall.col) == '#');
+    CHECK(path_distance(&paths, map, from, wall) == PATH_UNREACHABLE);
+    CHECK(path_astar(&paths, map, from, wall, NULL, 0) == PATH_UNREACHABLE);
+
+    // Com limite de profundidade, o que passa dele vira inalcancavel.
+    const int depth = 6;
+    path_service_limit_depth(&paths, depth);
+    int wrongLimited = 0;
+    for (int i = 0; i < PAIR_SAMPLES / 4; i++) {
+        Position a = random_open(map);
+        Position b = random_open(map);
+        reference_distances(map, b, expected);
+        int want = expected[a.row * map->cols + a.col];
+        if (want > depth) want = PATH_UNREACHABLE;
+        if (path_distance(&paths, map, a, b) != want) wrongLimited++;
+    }
+    CHECK(wrongLimited == 0);
+
+    free(expected);
+    free(path);
+    path_table_free(&table);
+    path_service_free(&paths);
+}
+
+// O autopilot simula com a tabela completa; o jogo ao vivo usa campos BFS.
+// As duas fontes dao as mesmas distancias, entao o clone com tabela tem
+// que repetir o jogo fantasma por fantasma.
+static void test_table_matches_live(void) {
+    static GameState live;
+    static GameState clone;
+    CHECK(game_init(&live, "assets/maps/mapa1.txt", 4));
+    game_seed(&live, 11);
+    game_start_new(&live);
+    live.lives = 1000;
+    live.players[0].lives = 1000;
+    game_clone_init(&clone);
+    CHECK(game_clone(&clone, &live));
+    PathTable table = {0};
+    CHECK(path_table_build(&table, &clone.paths, &clone.map));
+    clone.paths.table = &table;
+
+    int diverged = -1;
+    for (int tick = 0; tick < CLONE_TICKS && diverged < 0; tick++) {
+        if (tick % 30 == 0) {
+            Direction dir = kDirs[rand() % 4];
+            live.players[0].pendingDir = dir;
+            clone.players[0].pendingDir = dir;
+        }
+        if (tick == CLONE_TICKS / 2) {
+            game_set_power(&live, true, POWER_MODE_DURATION);
+            game_set_power(&clone, true, POWER_MODE_DURATION);
+        }
+        game_step_fast(&live, SIM_TICK_DT);
+        game_step_fast(&clone, SIM_TICK_DT);
+        if (live.hash != clone.hash) diverged = tick;
+        for (int i = 0; i < live.ghostCount; i++) {
+            if (live.ghosts[i].pos.row != clone.ghosts[i].pos.row ||
+                live.ghosts[i].pos.col != clone.ghosts[i].pos.col) {
+                diverged = tick;
+            }
+        }
+    }
+    CHECK(diverged < 0);
+    CHECK(live.paths.misses > 0);
+    clone.paths.table = NULL;
+    path_table_free(&table);
+    game_shutdown(&clone);
+    game_shutdown(&live);
+}
+
+int main(void) {
+    srand(9);
+    Map map = {0};
+    CHECK(map_load(&map, "assets/maps/mapa1.txt"));
+    test_distances(&map);
+    map_free(&map);
+    test_table_matches_live();
+    return test_report("pathfind");
+}
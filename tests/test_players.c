@@ -0,0 +1,135 @@
+#include "game.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define PLAYERS_TICKS 8000
+#define NEAREST_EVERY 40
+
+static int distances[GAME_MAX_PLAYERS][MAP_ROWS * MAP_COLS];
+
+// BFS de referencia de um jogador, tile a tile, sem portais (como o campo
+// de jogador mais proximo do EntityStore).
+static void reference_bfs(const Map* map, Position from, int* dist) {
+    static int queue[MAP_ROWS * MAP_COLS];
+    for (int i = 0; i < map->rows * map->cols; i++) dist[i] = -1;
+    int head = 0;
+    int tail = 0;
+    dist[from.row * map->cols + from.col] = 0;
+    queue[tail++] = from.row * map->cols + from.col;
+    const int dr[4] = {-1, 1, 0, 0};
+    const int dc[4] = {0, 0, -1, 1};
+    while (head < tail) {
+        int tile = queue[head++];
+        int row = tile / map->cols;
+        int col = tile % map->cols;
+        for (int d = 0; d < 4; d++) {
+            int nr = row + dr[d];
+            int nc = col + dc[d];
+            if (!map_in_bounds(map, nr, nc) || map_get(map, nr, nc) == '#') continue;
+            int next = nr * map->cols + nc;
+            if (dist[next] >= 0) continue;
+            dist[next] = dist[tile] + 1;
+            queue[tail++] = next;
+        }
+    }
+}
+
+// Em todo tile livre, o jogador que o EntityStore da como mais proximo
+// esta a distancia minima pelo labirinto entre os jogadores ativos.
+static bool nearest_matches(GameState* game) {
+    const Map* map = &game->map;
+    for (int p = 0; p < game->playerCount; p++) {
+        if (game->players[p].active) reference_bfs(map, game->players[p].pos, distances[p]);
+    }
+    for (int row = 0; row < map->rows; row++) {
+        for (int col = 0; col < map->cols; col++) {
+            if (map_get(map, row, col) == '#') continue;
+            int tile = row * map->cols + col;
+            int best = -1;
+            for (int p = 0; p < game->playerCount; p++) {
+                int d = game->players[p].active ? distances[p][tile] : -1;
+                if (d >= 0 && (best < 0 || d < best)) best = d;
+            }
+            int nearest = entity_store_nearest_player(&game->entities, map, game->players, game->playerCount,
+                                                      (Position){row, col});
+            if (best < 0) {
+                if (nearest != -1) return false;
+                continue;
+            }
+            if (nearest < 0 || !game->players[nearest].active || distances[nearest][tile] != best) return false;
+        }
+    }
+    return true;
+}
+
+// Tres bots no mesmo mapa: score e vidas da partida sao sempre a soma dos
+// de cada jogador, quem perde uma vida volta ao inicio sozinho e quem
+// perde a ultima sai do jogo sem encerrar a partida dos outros.
+int main(void) {
+    static GameState game;
+    CHECK(game_init(&game, "assets/maps/mapa1.txt", 4));
+    game_seed(&game, 21);
+    game_set_players(&game, 3, 0);
+    game_start_new(&game);
+    CHECK(game.playerCount == 3);
+    CHECK(game.activePlayers == 3);
+    CHECK(!game.chunks.enabled);
+
+    game.players[0].lives = 400;
+    game.players[1].lives = 400;
+    game.players[2].lives = 1;
+    game.lives = 801;
+
+    int scoreMismatch = 0;
+    int livesMismatch = 0;
+    int nearestMismatch = 0;
+    int wrongRespawn = 0;
+    int changedAfterOut = 0;
+    int hits = 0;
+    int scored[3] = {0};
+    bool eliminated = false;
+    for (int tick = 0; tick < PLAYERS_TICKS && game.phase == GAME_PHASE_PLAYING; tick++) {
+        Pacman before[3];
+        memcpy(before, game.players, sizeof(before));
+        game_update(&game, SIM_TICK_DT);
+
+        int scoreSum = 0;
+        int livesSum = 0;
+        for (int p = 0; p < 3; p++) {
+            const Pacman* now = &game.players[p];
+            scoreSum += now->score;
+            livesSum += now->lives;
+            if (now->score > before[p].score) scored[p]++;
+            if (!before[p].active) {
+                if (now->score != before[p].score || now->lives != before[p].lives) changedAfterOut++;
+                continue;
+            }
+            if (now->lives < before[p].lives) {
+                hits++;
+                if (now->lives > 0 && (now->pos.row != game.map.pacmanStart.row ||
+                                       now->pos.col != game.map.pacmanStart.col)) {
+                    wrongRespawn++;
+                }
+                if (now->lives == 0) eliminated = eliminated || (p == 2 && !now->active);
+            }
+        }
+        if (scoreSum != game.score) scoreMismatch++;
+        if (livesSum != game.lives) livesMismatch++;
+        if (tick % NEAREST_EVERY == 0 && !nearest_matches(&game)) nearestMismatch++;
+    }
+
+    CHECK(scoreMismatch == 0);
+    CHECK(livesMismatch == 0);
+    CHECK(nearestMismatch == 0);
+    CHECK(wrongRespawn == 0);
+    CHECK(changedAfterOut == 0);
+    CHECK(hits > 0);
+    CHECK(eliminated);
+    CHECK(game.activePlayers == 2);
+    CHECK(game.phase == GAME_PHASE_PLAYING);
+    CHECK(scored[0] > 0 && scored[1] > 0);
+
+    game_shutdown(&game);
+    return test_report("players");
+}
@@ -0,0 +1,126 @@
+#include "game.h"
+#include "statestream.h"
+#include "test.h"
+#include "zobrist.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define STREAM_TICKS 4000
+#define STREAM_GAP_START 1000
+#define STREAM_GAP_END 1100
+
+static const Direction kDirs[4] = {DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT};
+
+static bool same_position(Position a, Position b) {
+    return a.row == b.row && a.col == b.col;
+}
+
+static bool same_state(const GameState* a, const GameState* b) {
+    if (a->map.rows != b->map.rows || a->map.cols != b->map.cols) return false;
+    for (int row = 0; row < a->map.rows; row++) {
+        for (int col = 0; col < a->map.cols; col++) {
+            if (map_get(&a->map, row, col) != map_get(&b->map, row, col)) return false;
+        }
+    }
+    if (a->playerCount != b->playerCount || a->ghostCount != b->ghostCount) return false;
+    for (int i = 0; i < a->playerCount; i++) {
+        const Pacman* x = &a->players[i];
+        const Pacman* y = &b->players[i];
+        if (!same_position(x->pos, y->pos) || x->score != y->score || x->lives != y->lives ||
+            x->active != y->active) {
+            return false;
+        }
+    }
+    for (int i = 0; i < a->ghostCount; i++) {
+        if (!same_position(a->ghosts[i].pos, b->ghosts[i].pos) || a->ghosts[i].alive != b->ghosts[i].alive) {
+            return false;
+        }
+    }
+    return a->score == b->score && a->lives == b->lives && a->level == b->level && a->phase == b->phase &&
+           a->powered == b->powered && a->pelletsRemaining == b->pelletsRemaining && a->hash == b->hash &&
+           b->hash == zobrist_hash(b);
+}
+
+// Codifica a partida tick a tick e decodifica em dois espectadores: um
+// recebe todos os quadros e tem que reproduzir o estado exato; o outro
+// perde um trecho e so pode voltar a aceitar quadros no keyframe seguinte.
+int main(void) {
+    static GameState game;
+    static GameState view;
+    static GameState lossy;
+    static GameState scratch;
+    CHECK(game_init(&game, "assets/maps/mapa1.txt", 4));
+    game_seed(&game, 7);
+    game_set_players(&game, 2, 1);
+    game_start_new(&game);
+    game_clone_init(&view);
+    game_clone_init(&lossy);
+    game_clone_init(&scratch);
+
+    StreamEncoder enc;
+    StreamDecoder dec;
+    StreamDecoder lossyDec;
+    stream_encoder_init(&enc, STREAM_KEYFRAME_INTERVAL);
+    stream_decoder_init(&dec);
+    stream_decoder_init(&lossyDec);
+
+    uint8_t* buffer = NULL;
+    size_t capacity = 0;
+    int decodeFailures = 0;
+    int mismatches = 0;
+    int lossyMismatches = 0;
+    bool waitingKeyframe = false;
+    bool acceptedInGap = false;
+    bool truncatedAccepted = false;
+    srand(3);
+    for (int tick = 0; tick < STREAM_TICKS && game.running; tick++) {
+        if (tick % 20 == 0) {
+            game.players[0].pendingDir = kDirs[rand() % 4];
+            game.players[0].pendingTime = 0;
+        }
+        if (game.phase != GAME_PHASE_PLAYING) game_start_new(&game);
+        game_update(&game, SIM_TICK_DT);
+
+        size_t bound = stream_frame_bound(&game);
+        if (bound > capacity) {
+            capacity = bound;
+            buffer = (uint8_t*)realloc(buffer, capacity);
+        }
+        size_t size = stream_encode(&enc, &game, buffer, capacity);
+        CHECK(size > 0);
+        if (size == 0) break;
+
+        if (buffer[0] == STREAM_FRAME_DELTA && size > 2 && tick % 97 == 0) {
+            StreamDecoder probe = dec;
+            game_clone(&scratch, &view);
+            if (stream_decode(&probe, &scratch, buffer, size / 2)) truncatedAccepted = true;
+        }
+        if (!stream_decode(&dec, &view, buffer, size)) decodeFailures++;
+        else if (!same_state(&game, &view)) mismatches++;
+
+        if (tick >= STREAM_GAP_START && tick <= STREAM_GAP_END) {
+            waitingKeyframe = true;
+            continue;
+        }
+        if (buffer[0] == STREAM_FRAME_KEY) waitingKeyframe = false;
+        bool accepted = stream_decode(&lossyDec, &lossy, buffer, size);
+        if (waitingKeyframe && accepted) acceptedInGap = true;
+        if (accepted && !same_state(&game, &lossy)) lossyMismatches++;
+    }
+    CHECK(decodeFailures == 0);
+    CHECK(mismatches == 0);
+    CHECK(lossyMismatches == 0);
+    CHECK(!acceptedInGap);
+    CHECK(!truncatedAccepted);
+    CHECK(lossyDec.rejected > 0);
+    CHECK(lossyDec.synced);
+    CHECK(enc.keyframes > 1 && enc.deltas > enc.keyframes);
+
+    free(buffer);
+    stream_encoder_free(&enc);
+    game_shutdown(&scratch);
+    game_shutdown(&lossy);
+    game_shutdown(&view);
+    game_shutdown(&game);
+    return test_report("statestream");
+}
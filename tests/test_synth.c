@@ -0,0 +1,99 @@
+#include "synth.h"
+#include "test.h"
+#include <stdlib.h>
+
+#define RATE SYNTH_SAMPLE_RATE
+#define PELLET_FRAMES (int)(0.08f * (float)RATE)
+
+static int16_t buffer[RATE];
+static int16_t chunked[RATE];
+
+static int peak(const int16_t* samples, int count) {
+    int best = 0;
+    for (int i = 0; i < count; i++) {
+        if (abs(samples[i]) > best) best = abs(samples[i]);
+    }
+    return best;
+}
+
+static int zero_crossings(const int16_t* samples, int count) {
+    int crossings = 0;
+    for (int i = 1; i < count; i++) {
+        if ((samples[i - 1] < 0) != (samples[i] < 0)) crossings++;
+    }
+    return crossings;
+}
+
+// Sem vozes o buffer sai em silencio; um pellet dura exatamente o tom da
+// tabela, na frequencia certa, com ataque a partir do zero.
+static void test_pellet(void) {
+    static Synth synth;
+    synth_init(&synth, RATE);
+    synth_render(&synth, buffer, 512);
+    CHECK(peak(buffer, 512) == 0);
+
+    CHECK(synth_trigger(&synth, SYNTH_SOUND_PELLET));
+    CHECK(synth_active_voices(&synth) == 0);
+    synth_render(&synth, buffer, PELLET_FRAMES - 1);
+    CHECK(synth_active_voices(&synth) == 1);
+    synth_render(&synth, buffer + PELLET_FRAMES - 1, 1);
+    CHECK(synth_active_voices(&synth) == 0);
+
+    CHECK(buffer[0] == 0);
+    CHECK(peak(buffer, PELLET_FRAMES) > 10000);
+    CHECK(peak(buffer, PELLET_FRAMES) <= 32767 / 2);
+    int expected = (int)(2.0f * 880.0f * (float)PELLET_FRAMES / (float)RATE);
+    int crossings = zero_crossings(buffer, PELLET_FRAMES);
+    CHECK(crossings >= expected - 4 && crossings <= expected + 4);
+
+    synth_render(&synth, buffer, 512);
+    CHECK(peak(buffer, 512) == 0);
+}
+
+// Renderizar em blocos pequenos (como o callback da Raylib) da o mesmo
+// sinal que um bloco so, e o mesmo som repetido reaproveita a voz.
+static void test_chunks(void) {
+    static Synth whole;
+    static Synth parts;
+    synth_init(&whole, RATE);
+    synth_init(&parts, RATE);
+    for (int s = 0; s < SYNTH_SOUND_COUNT; s++) {
+        CHECK(synth_trigger(&whole, (SynthSound)s));
+        CHECK(synth_trigger(&parts, (SynthSound)s));
+    }
+    CHECK(synth_trigger(&whole, SYNTH_SOUND_PELLET));
+    CHECK(synth_trigger(&parts, SYNTH_SOUND_PELLET));
+
+    synth_render(&whole, buffer, RATE);
+    for (int offset = 0; offset < RATE; offset += 300) {
+        int frames = RATE - offset < 300 ? RATE - offset : 300;
+        synth_render(&parts, chunked + offset, frames);
+        if (offset == 0) CHECK(synth_active_voices(&parts) == SYNTH_SOUND_COUNT);
+    }
+    bool same = true;
+    for (int i = 0; i < RATE; i++) same = same && buffer[i] == chunked[i];
+    CHECK(same);
+    CHECK(synth_active_voices(&whole) == 0);
+}
+
+// A fila tem SYNTH_QUEUE_SIZE posicoes: o excedente e contado e descartado.
+static void test_queue(void) {
+    static Synth synth;
+    synth_init(&synth, RATE);
+    CHECK(!synth_trigger(&synth, SYNTH_SOUND_COUNT));
+    for (int i = 0; i < SYNTH_QUEUE_SIZE; i++) {
+        CHECK(synth_trigger(&synth, (SynthSound)(i % SYNTH_SOUND_COUNT)));
+    }
+    CHECK(!synth_trigger(&synth, SYNTH_SOUND_PELLET));
+    CHECK(atomic_load(&synth.droppedEvents) == 1);
+    synth_render(&synth, buffer, 1);
+    CHECK(synth_active_voices(&synth) == SYNTH_SOUND_COUNT);
+    CHECK(synth_trigger(&synth, SYNTH_SOUND_PELLET));
+}
+
+int main(void) {
+    test_pellet();
+    test_chunks();
+    test_queue();
+    return test_report("synth");
+}
@@ -0,0 +1,66 @@
+#include "test.h"
+#include "timerwheel.h"
+#include <stdlib.h>
+
+#define WHEEL_TICKS (TIMER_WHEEL_MAX_DELAY + 2u)
+
+// Delays espalhados pelos tres niveis: cada timer tem que expirar
+// exatamente no tick pedido, depois das cascatas entre niveis.
+int main(void) {
+    static TimerWheel wheel;
+    timer_wheel_init(&wheel);
+    srand(5);
+
+    uint32_t expected[TIMER_WHEEL_CAPACITY];
+    int handles[TIMER_WHEEL_CAPACITY];
+    bool fired[TIMER_WHEEL_CAPACITY] = {false};
+    for (int i = 0; i < TIMER_WHEEL_CAPACITY; i++) {
+        uint32_t delay;
+        if (i < 10) delay = (uint32_t)(rand() % TIMER_WHEEL_SLOTS) + 1u;
+        else if (i < 20) delay = (uint32_t)(rand() % (TIMER_WHEEL_SLOTS * TIMER_WHEEL_SLOTS)) + 1u;
+        else delay = (uint32_t)rand() % TIMER_WHEEL_MAX_DELAY + 1u;
+        if (i == TIMER_WHEEL_CAPACITY - 1) delay = TIMER_WHEEL_MAX_DELAY;
+        handles[i] = timer_wheel_schedule(&wheel, delay, i % 3, i);
+        expected[i] = delay;
+        CHECK(handles[i] != TIMER_NONE);
+        CHECK(timer_wheel_remaining(&wheel, handles[i]) == delay);
+    }
+    CHECK(timer_wheel_schedule(&wheel, 10, 0, -1) == TIMER_NONE);
+
+    int cancelled = 5;
+    CHECK(timer_wheel_cancel(&wheel, handles[cancelled]));
+    CHECK(!timer_wheel_active(&wheel, handles[cancelled]));
+    CHECK(!timer_wheel_cancel(&wheel, handles[cancelled]));
+    CHECK(timer_wheel_remaining(&wheel, handles[cancelled]) == 0);
+
+    // O slot liberado e reusado com outra geracao: o handle antigo continua morto.
+    int reused = timer_wheel_schedule(&wheel, 3, 0, cancelled);
+    CHECK(reused != TIMER_NONE && reused != handles[cancelled]);
+    CHECK(!timer_wheel_active(&wheel, handles[cancelled]));
+    handles[cancelled] = reused;
+    expected[cancelled] = 3;
+
+    int wrongTick = 0;
+    int firedCount = 0;
+    TimerExpired out[TIMER_WHEEL_CAPACITY];
+    for (uint32_t tick = 1; tick <= WHEEL_TICKS; tick++) {
+        int count = timer_wheel_advance(&wheel, out, TIMER_WHEEL_CAPACITY);
+        for (int k = 0; k < count; k++) {
+            int index = out[k].data;
+            if (index < 0 || index >= TIMER_WHEEL_CAPACITY || fired[index] || expected[index] != tick) {
+                wrongTick++;
+                continue;
+            }
+            fired[index] = true;
+            firedCount++;
+            CHECK(out[k].handle == handles[index]);
+            CHECK(out[k].kind == index % 3 || index == cancelled);
+            CHECK(!timer_wheel_active(&wheel, handles[index]));
+        }
+        if (tick == 64) CHECK(timer_wheel_remaining(&wheel, handles[TIMER_WHEEL_CAPACITY - 1]) ==
+                              TIMER_WHEEL_MAX_DELAY - 64u);
+    }
+    CHECK(wrongTick == 0);
+    CHECK(firedCount == TIMER_WHEEL_CAPACITY);
+    return test_report("timerwheel");
+}
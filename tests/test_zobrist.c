@@ -0,0 +1,55 @@
+#include "game.h"
+#include "test.h"
+#include "zobrist.h"
+#include <stdlib.h>
+
+#define ZOBRIST_TICKS 6000
+
+static const Direction kDirs[4] = {DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT};
+
+// O hash mantido por game_update/game_step_fast (XOR incremental a cada
+// mudanca) tem que bater com o recalculado do zero em todo tick, inclusive
+// num clone que segue a partir do meio da partida.
+int main(void) {
+    static GameState game;
+    static GameState clone;
+    CHECK(game_init(&game, "assets/maps/mapa1.txt", 4));
+    game_seed(&game, 7);
+    game_set_players(&game, 3, 1);
+    game_start_new(&game);
+    game.lives = 1000;
+    for (int i = 0; i < game.playerCount; i++) game.players[i].lives = 1000;
+    game.hash = zobrist_hash(&game);
+    CHECK(game.hash == zobrist_hash(&game));
+    game_clone_init(&clone);
+
+    srand(1);
+    int mismatches = 0;
+    uint64_t first = game.hash;
+    bool changed = false;
+    for (int tick = 0; tick < ZOBRIST_TICKS && game.running; tick++) {
+        if (tick % 20 == 0) {
+            game.players[0].pendingDir = kDirs[rand() % 4];
+            game.players[0].pendingTime = 0;
+        }
+        if (game.phase != GAME_PHASE_PLAYING) game_start_new(&game);
+        if (tick % 2 == 0) game_update(&game, SIM_TICK_DT);
+        else game_step_fast(&game, SIM_TICK_DT);
+        if (game.hash != zobrist_hash(&game)) mismatches++;
+        if (game.hash != first) changed = true;
+
+        if (tick % 500 == 250) {
+            CHECK(game_clone(&clone, &game));
+            CHECK(clone.hash == game.hash);
+            for (int step = 0; step < 200; step++) {
+                game_step_fast(&clone, SIM_TICK_DT);
+                if (clone.hash != zobrist_hash(&clone)) mismatches++;
+            }
+        }
+    }
+    CHECK(changed);
+    CHECK(mismatches == 0);
+    game_shutdown(&clone);
+    game_shutdown(&game);
+    return test_report("zobrist");
+}
@@ -0,0 +1,311 @@
+#include "../src/entity.h"
+#include "../src/net.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CLIENT_MAX_BOTS 256
+#define CLIENT_HELLO_RETRY 0.5
+#define CLIENT_MAP_RETRY 0.5
+#define CLIENT_INPUT_EVERY 4
+
+// Cliente sem janela: cada bot ocupa uma sala, mantem uma copia do mapa
+// (chunks + mudancas de tiles dos estados) e anda pelos corredores
+// escolhendo uma saida aleatoria nos cruzamentos.
+typedef struct {
+    NetSocket socket;
+    int room;
+    bool welcomed;
+    double lastHello;
+    double lastMapRequest;
+    uint32_t mapRevision;
+    int rows;
+    int cols;
+    char* cells;
+    bool* chunkReceived;
+    int chunkCount;
+    int chunksMissing;
+    uint32_t tileChangeCount;
+    bool mapReady;
+    uint32_t lastTick;
+    NetTile pacman;
+    int score;
+    int lives;
+    int level;
+    Direction dir;
+    uint32_t inputSeq;
+    unsigned int states;
+    unsigned int outOfOrder;
+    unsigned int mapResyncs;
+    unsigned int tilesApplied;
+    unsigned int partialStates;
+    int bestScore;
+} Bot;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void sleep_ms(int ms) {
+    struct timespec ts = {ms / 1000, (long)(ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+static void send_hello(Bot* bot, const NetAddress* server, int index) {
+    NetHello hello;
+    memset(&hello, 0, sizeof(hello));
+    net_header_init(&hello.header, NET_MSG_HELLO);
+    hello.room = NET_ROOM_ANY;
+    snprintf(hello.name, sizeof(hello.name), "BOT%02d", index + 1);
+    net_send(&bot->socket, server, &hello, sizeof(hello));
+}
+
+static void send_room_request(Bot* bot, const NetAddress* server, NetMessageType type) {
+    NetRoomRequest request;
+    net_header_init(&request.header, type);
+    request.room = bot->room;
+    net_send(&bot->socket, server, &request, sizeof(request));
+}
+
+static void send_input(Bot* bot, const NetAddress* server) {
+    NetInput input;
+    net_header_init(&input.header, NET_MSG_INPUT);
+    input.room = bot->room;
+    input.seq = ++bot->inputSeq;
+    input.dir = bot->dir;
+    net_send(&bot->socket, server, &input, sizeof(input));
+}
+
+static bool open_tile(const Bot* bot, int row, int col) {
+    if (row < 0 || col < 0 || row >= bot->rows || col >= bot->cols) return false;
+    return bot->cells[row * bot->cols + col] != '#';
+}
+
+static void choose_direction(Bot* bot) {
+    if (!bot->mapReady) return;
+    static const Direction all[4] = {DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT};
+    static const int rowStep[4] = {-1, 1, 0, 0};
+    static const int colStep[4] = {0, 0, -1, 1};
+    Direction options[4];
+    int count = 0;
+    bool canContinue = false;
+    for (int i = 0; i < 4; i++) {
+        if (!open_tile(bot, bot->pacman.row + rowStep[i], bot->pacman.col + colStep[i])) continue;
+        options[count++] = all[i];
+        if (all[i] == bot->dir) canContinue = true;
+    }
+    if (count == 0) return;
+    if (canContinue && count <= 2) return;
+    bot->dir = options[rand() % count];
+}
+
+static void prepare_map(Bot* bot, const NetMapChunk* chunk) {
+    int total = chunk->rows * chunk->cols;
+    if (chunk->mapRevision == bot->mapRevision && bot->cells && total == bot->rows * bot->cols) return;
+    free(bot->cells);
+    free(bot->chunkReceived);
+    bot->rows = chunk->rows;
+    bot->cols = chunk->cols;
+    bot->chunkCount = (total + NET_MAP_CHUNK - 1) / NET_MAP_CHUNK;
+    bot->cells = (char*)calloc((size_t)total, 1);
+    bot->chunkReceived = (bool*)calloc((size_t)bot->chunkCount, sizeof(bool));
+    bot->chunksMissing = bot->chunkCount;
+    bot->mapRevision = chunk->mapRevision;
+    bot->mapReady = false;
+}
+
+static void handle_map_chunk(Bot* bot, const unsigned char* data, int size) {
+    NetMapChunk chunk;
+    memcpy(&chunk, data, sizeof(chunk));
+    if (chunk.rows <= 0 || chunk.cols <= 0) return;
+    if ((size_t)size < sizeof(chunk) + chunk.length) return;
+    if ((uint64_t)chunk.offset + chunk.length > (uint64_t)chunk.rows * (uint64_t)chunk.cols) return;
+    prepare_map(bot, &chunk);
+    if (!bot->cells || !bot->chunkReceived) return;
+    // Pedacos de um reenvio trazem um tileChangeCount mais novo: recomeca a
+    // montagem para o mapa inteiro ficar coerente com um unico instante.
+    if (chunk.tileChangeCount != bot->tileChangeCount && bot->chunksMissing != bot->chunkCount) {
+        memset(bot->chunkReceived, 0, sizeof(bool) * (size_t)bot->chunkCount);
+        bot->chunksMissing = bot->chunkCount;
+        bot->mapReady = false;
+    }
+    int index = (int)(chunk.offset / NET_MAP_CHUNK);
+    if (bot->chunkReceived[index]) return;
+    memcpy(bot->cells + chunk.offset, data + sizeof(chunk), chunk.length);
+    bot->chunkReceived[index] = true;
+    bot->tileChangeCount = chunk.tileChangeCount;
+    if (--bot->chunksMissing == 0) bot->mapReady = true;
+}
+
+static void handle_state(Bot* bot, const NetAddress* server, const unsigned char* data, int size, double now) {
+    NetState state;
+    memcpy(&state, data, sizeof(state));
+    size_t needed = sizeof(state) + sizeof(NetGhost) * state.ghostCount + sizeof(NetTile) * state.tileCount;
+    if ((size_t)size < needed) return;
+    if (bot->states > 0 && (int32_t)(state.tick - bot->lastTick) <= 0) {
+        bot->outOfOrder++;
+        return;
+    }
+    bot->states++;
+    if (state.ghostTotal > state.ghostCount) bot->partialStates++;
+    bot->lastTick = state.tick;
+    bot->pacman = state.pacman;
+    bot->score = state.score;
+    bot->lives = state.lives;
+    bot->level = state.level;
+    if (state.score > bot->bestScore) bot->bestScore = state.score;
+
+    bool needMap = state.mapRevision != bot->mapRevision || !bot->mapReady;
+    if (!needMap) {
+        // Um contador do servidor atras do nosso (sala reiniciada no mesmo
+        // mapa) faria o laco abaixo dar a volta nos 32 bits.
+        uint32_t first = state.tileChangeCount - state.tileCount;
+        if ((int32_t)(state.tileChangeCount - bot->tileChangeCount) < 0 ||
+            (int32_t)(bot->tileChangeCount - first) < 0) {
+            needMap = true;
+        } else {
+            const unsigned char* tiles = data + sizeof(state) + sizeof(NetGhost) * state.ghostCount;
+            for (uint32_t seq = bot->tileChangeCount; seq != state.tileChangeCount; seq++) {
+                NetTile tile;
+                memcpy(&tile, tiles + sizeof(NetTile) * (seq - first), sizeof(tile));
+                if (open_tile(bot, tile.row, tile.col)) {
+                    bot->cells[tile.row * bot->cols + tile.col] = ' ';
+                    bot->tilesApplied++;
+                }
+            }
+            bot->tileChangeCount = state.tileChangeCount;
+        }
+    }
+    if (needMap && now - bot->lastMapRequest > CLIENT_MAP_RETRY) {
+        bot->lastMapRequest = now;
+        if (bot->mapReady) bot->mapResyncs++;
+        send_room_request(bot, server, NET_MSG_MAP_REQUEST);
+    }
+
+    Direction before = bot->dir;
+    choose_direction(bot);
+    if (bot->dir != before || state.tick % CLIENT_INPUT_EVERY == 0) send_input(bot, server);
+}
+
+static void poll_bot(Bot* bot, const NetAddress* server, int index, double now) {
+    unsigned char buffer[NET_MAX_PACKET];
+    NetAddress from;
+    if (!bot->welcomed && now - bot->lastHello > CLIENT_HELLO_RETRY) {
+        bot->lastHello = now;
+        send_hello(bot, server, index);
+    }
+    int size;
+    while ((size = net_receive(&bot->socket, &from, buffer, sizeof(buffer))) > 0) {
+        if (!net_address_equal(&from, server)) continue;
+        switch (net_message_type(buffer, (size_t)size)) {
+            case NET_MSG_WELCOME: {
+                NetWelcome welcome;
+                memcpy(&welcome, buffer, sizeof(welcome));
+                bot->room = welcome.room;
+                bot->welcomed = true;
+                break;
+            }
+            case NET_MSG_MAP_CHUNK:
+                if (bot->welcomed) handle_map_chunk(bot, buffer, size);
+                break;
+            case NET_MSG_STATE:
+                if (bot->welcomed) handle_state(bot, server, buffer, size, now);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "uso: %s [host] [--port N] [--bots N] [--seconds S]\n", program);
+}
+
+int main(int argc, char** argv) {
+    const char* host = "127.0.0.1";
+    int port = NET_DEFAULT_PORT;
+    int botCount = 4;
+    double seconds = 10.0;
+    int first = 1;
+    if (argc > 1 && argv[1][0] != '-') {
+        host = argv[1];
+        first = 2;
+    }
+    for (int i = first; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char* name = argv[i];
+        const char* value = argv[++i];
+        if (strcmp(name, "--port") == 0) {
+            port = atoi(value);
+        } else if (strcmp(name, "--bots") == 0) {
+            botCount = atoi(value);
+        } else if (strcmp(name, "--seconds") == 0) {
+            seconds = atof(value);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (botCount <= 0 || botCount > CLIENT_MAX_BOTS) {
+        fprintf(stderr, "bots: 1 a %d\n", CLIENT_MAX_BOTS);
+        return 1;
+    }
+
+    NetAddress server;
+    if (!net_startup() || !net_resolve(host, (uint16_t)port, &server)) {
+        fprintf(stderr, "endereco invalido: %s\n", host);
+        return 1;
+    }
+    Bot* bots = (Bot*)calloc((size_t)botCount, sizeof(Bot));
+    if (!bots) return 1;
+    srand((unsigned int)time(NULL));
+    int opened = 0;
+    for (; opened < botCount; opened++) {
+        if (!net_open(&bots[opened].socket, 0)) break;
+        bots[opened].room = -1;
+        bots[opened].lastHello = -CLIENT_HELLO_RETRY;
+    }
+    if (opened < botCount) {
+        fprintf(stderr, "falha ao abrir socket do bot %d\n", opened + 1);
+    }
+
+    double start = now_seconds();
+    double now = start;
+    while (now - start < seconds) {
+        for (int i = 0; i < opened; i++) poll_bot(&bots[i], &server, i, now);
+        sleep_ms(1);
+        now = now_seconds();
+    }
+
+    unsigned long long states = 0;
+    int welcomed = 0;
+    for (int i = 0; i < opened; i++) {
+        Bot* bot = &bots[i];
+        if (bot->welcomed) {
+            welcomed++;
+            send_room_request(bot, &server, NET_MSG_BYE);
+        }
+        states += bot->states;
+        printf("bot %2d: sala %3d, %u estados (%u fora de ordem), score %d (melhor %d), %u tiles, %u ressincronizacoes\n",
+               i + 1, bot->room, bot->states, bot->outOfOrder, bot->score, bot->bestScore,
+               bot->tilesApplied, bot->mapResyncs);
+        if (bot->partialStates > 0) {
+            printf("        %u estados com mais fantasmas do que cabem no pacote\n", bot->partialStates);
+        }
+        net_close(&bot->socket);
+        free(bot->cells);
+        free(bot->chunkReceived);
+    }
+    double elapsed = now - start;
+    printf("%d/%d bots em salas, %.1f estados/s por bot\n", welcomed, opened,
+           welcomed > 0 && elapsed > 0.0 ? (double)states / elapsed / welcomed : 0.0);
+    free(bots);
+    net_cleanup();
+    return welcomed == opened ? 0 : 1;
+}
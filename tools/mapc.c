@@ -0,0 +1,46 @@
+#include "../src/map.h"
+#include "../src/mappack.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "uso: %s <saida.pak> <mapa1.txt> [mapa2.txt ...]\n", argv[0]);
+        return 1;
+    }
+
+    int count = argc - 2;
+    if (count > MAPPACK_MAX_LEVELS) {
+        fprintf(stderr, "maximo de %d niveis por pacote\n", MAPPACK_MAX_LEVELS);
+        return 1;
+    }
+
+    Map* maps = (Map*)calloc((size_t)count, sizeof(Map));
+    if (!maps) return 1;
+
+    int loaded = 0;
+    bool ok = true;
+    for (int i = 0; i < count; i++) {
+        const char* path = argv[i + 2];
+        if (!map_load(&maps[i], path)) {
+            fprintf(stderr, "falha ao ler %s\n", path);
+            ok = false;
+            break;
+        }
+        loaded++;
+        printf("nivel %d: %s (%dx%d, %d pellets, %d fantasmas, %d portais)\n",
+               i + 1, path, maps[i].rows, maps[i].cols, maps[i].pelletsInitial,
+               maps[i].ghostCount, maps[i].portalCount);
+    }
+
+    if (ok && !mappack_write(argv[1], maps, count)) {
+        fprintf(stderr, "falha ao gravar %s\n", argv[1]);
+        ok = false;
+    }
+
+    for (int i = 0; i < loaded; i++) {
+        map_free(&maps[i]);
+    }
+    free(maps);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#include "../src/mazegen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "uso: %s <saida.txt> <linhas> <colunas> [--seed N] [--density 0..1] [--loops 0..1]\n"
+            "       [--portals N] [--ghosts N] [--power N] [--threads N]\n",
+            program);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    MazeParams params;
+    maze_default_params(&params, atoi(argv[2]), atoi(argv[3]), 1u);
+    for (int i = 4; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char* name = argv[i];
+        const char* value = argv[++i];
+        if (strcmp(name, "--seed") == 0) {
+            params.seed = (uint32_t)strtoul(value, NULL, 10);
+        } else if (strcmp(name, "--density") == 0) {
+            params.density = (float)atof(value);
+        } else if (strcmp(name, "--loops") == 0) {
+            params.loops = (float)atof(value);
+        } else if (strcmp(name, "--portals") == 0) {
+            params.portalPairs = atoi(value);
+        } else if (strcmp(name, "--ghosts") == 0) {
+            params.ghostCount = atoi(value);
+        } else if (strcmp(name, "--power") == 0) {
+            params.powerPellets = atoi(value);
+        } else if (strcmp(name, "--threads") == 0) {
+            params.threads = atoi(value);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (params.rows < MAZE_MIN_ROWS || params.cols < MAZE_MIN_COLS) {
+        fprintf(stderr, "tamanho minimo: %dx%d\n", MAZE_MIN_ROWS, MAZE_MIN_COLS);
+        return 1;
+    }
+
+    char* cells = (char*)malloc((size_t)params.rows * (size_t)params.cols);
+    if (!cells) {
+        fprintf(stderr, "sem memoria para %dx%d\n", params.rows, params.cols);
+        return 1;
+    }
+    bool ok = maze_generate(&params, cells);
+    if (ok && !maze_write(argv[1], cells, params.rows, params.cols)) {
+        fprintf(stderr, "falha ao gravar %s\n", argv[1]);
+        ok = false;
+    }
+    if (ok) {
+        printf("%s: %dx%d, seed %u\n", argv[1], params.rows, params.cols, params.seed);
+    }
+    free(cells);
+    return ok ? 0 : 1;
+}
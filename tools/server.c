@@ -0,0 +1,108 @@
+#include "../src/memtrack.h"
+#include "../src/metrics.h"
+#include "../src/server.h"
+#include "../src/trace.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static atomic_bool quitRequested;
+
+static void on_signal(int sig) {
+    (void)sig;
+    atomic_store(&quitRequested, true);
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "uso: %s [--port N] [--rooms N] [--threads N] [--ranking arquivo] [--stats segundos]\n"
+            "       [--bots N] [--metrics porta|socket] [--trace arquivo.json]\n",
+            program);
+}
+
+int main(int argc, char** argv) {
+    int port = NET_DEFAULT_PORT;
+    int rooms = 32;
+    int threads = 0;
+    int bots = 0;
+    double statsSeconds = 5.0;
+    const char* rankingPath = SERVER_RANKING_PATH;
+    const char* metricsAddress = NULL;
+    const char* tracePath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char* name = argv[i];
+        const char* value = argv[++i];
+        if (strcmp(name, "--port") == 0) {
+            port = atoi(value);
+        } else if (strcmp(name, "--rooms") == 0) {
+            rooms = atoi(value);
+        } else if (strcmp(name, "--threads") == 0) {
+            threads = atoi(value);
+        } else if (strcmp(name, "--ranking") == 0) {
+            rankingPath = value;
+        } else if (strcmp(name, "--bots") == 0) {
+            bots = atoi(value);
+        } else if (strcmp(name, "--stats") == 0) {
+            statsSeconds = atof(value);
+        } else if (strcmp(name, "--metrics") == 0) {
+            metricsAddress = value;
+        } else if (strcmp(name, "--trace") == 0) {
+            tracePath = value;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    GameServer server;
+    if (!server_init(&server, (uint16_t)port, rooms, threads, rankingPath)) {
+        fprintf(stderr, "falha ao iniciar o servidor na porta %d (%d salas)\n", port, rooms);
+        return 1;
+    }
+    if (bots < 0 || bots >= GAME_MAX_PLAYERS) {
+        fprintf(stderr, "bots por sala: 0 a %d\n", GAME_MAX_PLAYERS - 1);
+        server_shutdown(&server);
+        return 1;
+    }
+    server.botsPerRoom = bots;
+    if (tracePath && !trace_start(tracePath)) {
+        fprintf(stderr, "nao foi possivel gravar o trace em %s\n", tracePath);
+        tracePath = NULL;
+    }
+    trace_thread_name("rede");
+    MetricsServer metricsServer = {0};
+    if (metricsAddress && !metrics_server_start(&metricsServer, metricsAddress)) {
+        fprintf(stderr, "nao foi possivel exportar metricas em %s\n", metricsAddress);
+    }
+    atomic_init(&quitRequested, false);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    printf("servidor na porta %d: %d salas, %d threads, %d bots por sala, ranking em %s\n",
+           port, server.roomCount, server.threads, bots, server.rankingPath);
+    fflush(stdout);
+
+    server_run(&server, &quitRequested, statsSeconds);
+    metrics_server_stop(&metricsServer);
+
+    printf("ranking central:\n");
+    for (int i = 0; i < RANKING_MAX_ENTRIES; i++) {
+        printf("%2d. %-10s %6d\n", i + 1, server.ranking.entries[i].name, server.ranking.entries[i].score);
+    }
+    server_shutdown(&server);
+    mem_print(stdout);
+    if (tracePath) {
+        unsigned long long written = 0;
+        unsigned long long dropped = 0;
+        if (trace_stop(&written, &dropped)) {
+            printf("trace: %llu eventos, %llu descartados\n", written, dropped);
+        } else {
+            fprintf(stderr, "falha ao gravar o trace\n");
+        }
+    }
+    return 0;
+}